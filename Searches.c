@@ -3,583 +3,140 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#ifdef __linux__
+#include <signal.h>
+#endif
+#include "graph.h"
+#include "graph_file.h"
+#include "graph_import.h"
+#include "search_context.h"
+#include "landmarks.h"
+#include "spatial_index.h"
+#include "search.h"
+#include "contraction_hierarchy.h"
+#include "chrome_trace.h"
+#include "query_server.h"
 
-#pragma region /* A generic singly linked node implementation + a node implementation with a priority */
-typedef struct node Node;
-typedef struct node{
-    void *data;
-    Node *next;
-} Node;
-
-Node* node_createNode(void* data)
-{
-    Node* node = (Node*)calloc(1, sizeof(Node));
-    node->data = data;
-    return node;
-}
-
-// The following is a node with a score for the 
-// priority queue, its mostly the same
-typedef struct pnode PNode;
-typedef struct pnode{
-    void *data;
-    PNode *next;
-    uint32_t score;
-} PNode;
-
-PNode* pnode_createNode(void* data, uint32_t score)
-{
-    PNode* node = (PNode*)calloc(1, sizeof(PNode));
-    node->data = data;
-    node->score = score;
-    return node;
-}
-#pragma endregion
-
-#pragma region /* A simple queue implementation */
-typedef struct queue{
-    Node* head;
-    Node* tail;
-} Queue;
-
-void queue_enqueue(Queue* queue, Node* node)
+// This is a function to run the algorithms with given cities
+void RunAlgo(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end, Search func)
 {
-    if(!queue->tail)
+    // the path is read straight into buffers on the stack with the cost of
+    // every city the search recorded, long paths move into one allocation
+    uint32_t nodes[64], costs[64];
+    Path path = path_init(nodes, costs, 64);
+    path_find(&path, graph, ctx, func, start, end);
+
+    printf("\n%s to %s\n", graph->cities[start].name, graph->cities[end].name);
+    for(uint32_t i = 0; i < path.len; i++)
     {
-        queue->head = node;
-        queue->tail = node;
+        printf("%s - Running Cost: %d\n", graph->cities[path.nodes[i]].name, path.costs[i]);
     }
-    else
-    {
-        queue->tail->next = node;
-        queue->tail = node;
-    } 
+    printf("Total Cost: %d\n", path.cost);
+#ifdef SEARCH_STATS
+    printf("Popped: %llu, Stalled: %llu, Relaxed: %llu, Pushed: %llu, Decrease Keys: %llu, Peak Frontier: %u\n",
+        (unsigned long long)ctx->stats.popped, (unsigned long long)ctx->stats.stalled, (unsigned long long)ctx->stats.relaxed,
+        (unsigned long long)ctx->stats.pushed, (unsigned long long)ctx->stats.decrease_keys, ctx->stats.peak_frontier);
+#endif
+
+    path_free(&path);
 }
+// the server of the "serve" command, for its signal handler
+static QueryServer* serving;
 
-Node* queue_dequeue(Queue* queue)
+/// @brief stops the "serve" command on SIGINT and SIGTERM
+static void queryServer_interrupt(int signal)
 {
-    if(queue->head == NULL)return NULL;
-
-    Node *temp = queue->head;
-
-    queue->head = queue->head->next;
-    if(queue->head == NULL)queue->tail = NULL;
-    
-    return temp;
+    (void)signal;
+    if(serving)
+        queryServer_stop(serving);
 }
 
-/// @brief a function to check if a specific data value is in the queue
-/// @param queue the queue you want to search
-/// @param data the data you want to search for
-/// @return a bool indicating if the data is in the queue
-bool queue_inqueue(Queue* queue, void* data)
+int main(int argc, char* argv[])
 {
-    Node* activeNode = queue->head;
-    while(activeNode)
+    // "convert-dimacs <out> <gr> [co]" and "convert-csv <out> <edges> [nodes]"
+    // import a text graph once and write it as a graph file for "load <out>"
+    if(argc > 3 && (strcmp(argv[1], "convert-dimacs") == 0 || strcmp(argv[1], "convert-csv") == 0))
     {
-        if(activeNode->data == data)return true;
-        activeNode = activeNode->next;
+        const char* extra = argc > 4 ? argv[4] : NULL;
+        Graph* imported = strcmp(argv[1], "convert-dimacs") == 0
+            ? graph_importDimacs(argv[3], extra)
+            : graph_importCsv(argv[3], extra, false);
+        if(imported == NULL)
+            return 1;
+        bool saved = graph_save(imported, argv[2]);
+        graph_free(imported);
+        return saved ? 0 : 1;
     }
-    return false;
-}
-#pragma endregion
-
-#pragma region /* A simple priority queue implementation */
-typedef struct pqueue{
-    PNode* head;
-} PQueue;
 
-void pqueue_enqueue(PQueue* pqueue, PNode* node)
-{
-    PNode** insert_location = &pqueue->head;
-    while(true)
+#ifdef __linux__
+    // "serve <file> <socket> [workers] [budget_us]" keeps a graph file loaded and
+    // answers route requests on a Unix socket until it is interrupted, the budget
+    // is the deadline of the wastar and arastar searches
+    if(argc > 3 && strcmp(argv[1], "serve") == 0)
     {
-        if(*insert_location == NULL || (*insert_location)->score > node->score)
+        Graph* served = graph_load(argv[2]);
+        if(served == NULL)
+            return 1;
+        served->landmarks = landmarks_build(served, 8);
+        served->spatial = spatialIndex_build(served);
+        QueryServer* server = queryServer_create(served, argv[3], argc > 4 ? (uint32_t)atoi(argv[4]) : 0);
+        if(server == NULL)
         {
-            node->next = *insert_location;
-            *insert_location = node;
-            break;
+            graph_free(served);
+            return 1;
         }
-        else
-        {
-            insert_location = &((*insert_location)->next);
-        }
-    }
-    return;
-}
-
-PNode* pqueue_dequeue(PQueue* pqueue)
-{
-    PNode *temp = pqueue->head;
-
-    if(temp == NULL)return NULL;
-    pqueue->head = temp->next;
-
-    return temp;
-}
-
-/// @brief a function to check if a specific data value is in the queue
-/// @param Pqueue the queue you want to search
-/// @param data the data you want to search for
-/// @return a bool indicating if the data is in the queue
-bool pqueue_inqueue(PQueue* pqueue, void* data)
-{
-    PNode* activeNode = pqueue->head;
-    while(activeNode)
-    {
-        if(activeNode->data == data)
-            return true;
-        activeNode = activeNode->next;
-    }
-    return false;
-}
-
-/// @brief a function to return a Node with a matching piece of data
-/// @param pqueue the queue you want to search
-/// @param city the data you want to match against
-/// @return a PNode with data matching the provided data, priority
-///         should not be modified unless reinserted with replaceSpecific
-PNode* pqueue_findInQueue(PQueue *pqueue, void* city)
-{
-    PNode* activeNode = pqueue->head;
-    while(activeNode)
-    {
-        if(activeNode->data == city)
-            return activeNode;
-        activeNode = activeNode->next;
-    }
-    return NULL;
-}
-
-/// @brief The same as findInQueue except it returns a pointer to the parent of the matched item
-/// @param pqueue the queue you want to search
-/// @param city the data you want to match against
-/// @return a PNode with next->data matching the provided data, priority
-///         should not be modified unless reinserted with replaceSpecific
-PNode** pqueue_findInQueueParent(PQueue *pqueue, void* city)
-{
-    PNode **activeNodePtr = &pqueue->head;
-
-    while(*activeNodePtr != NULL)
-    {
-        if((*activeNodePtr)->data == city)
-            return activeNodePtr;
-        activeNodePtr = &((*activeNodePtr)->next);
-    }
-
-    return NULL;
-}
-
-/// @brief Changes the score of a Node in the priority queue with matching data
-/// @param pqueue the queue you want to search
-/// @param city the data you want to match against
-/// @param new_score the new score you want to assign
-void pqueue_replaceSpecific(PQueue *pqueue, void* city, uint32_t new_score)
-{
-    PNode** nodeToBeChanged = pqueue_findInQueueParent(pqueue, city);
-    if(nodeToBeChanged == NULL)return;
-
-    PNode* cpy = *nodeToBeChanged;
-    (*nodeToBeChanged) = cpy->next;
-    cpy->score = new_score;
-    pqueue_enqueue(pqueue, cpy);
-}
-
-#pragma endregion
-
-#pragma region /* Simple stack implementation */
-typedef struct stack{
-    Node* head;
-    uint32_t size;
-} Stack;
-
-void push(Stack* stack, Node* node)
-{
-    if(stack->head == NULL)
-    {
-        stack->head = node;
-    }
-    else
-    {
-        node->next = stack->head;
-        stack->head = node;
-    }
-    stack->size++;
-}
-
-Node* pop(Stack* stack)
-{
-    if(stack->head == NULL)
-        return NULL;
-    else
-    {
-        Node* temp = stack->head;
-        stack->head = temp->next;
-        stack->size--;
-        return temp;
-    }
-}
-#pragma endregion
-
-#pragma region /* City abstraction structs/implementation */
-typedef struct connection Connection;
-typedef struct city City;
-
-// a struct representing a connection
-struct connection{
-    uint16_t distance; // the length of the connection
-    City* connected_city; // the city the connection is connecting to
-};
-
-/// @brief a struct to store data about a city
-struct city
-{
-    char* name; // the name of the city
-    uint16_t straight_distance; // the straight distance to bucharest
-    union {
-        bool visited;
-        City* addedBy;
-    } visited; 
-    // storage that indicates whether the city has been visited
-    // and can also store what city added it to the path
-
-    Connection* connections[5]; // a list of the connections to the city
-};
-
-
-/// @brief adds a connection to a city
-/// @param src_city one of two cities that should be connected
-/// @param dest_city one of two cities that should be connected
-/// @param dist the distance of the connection
-void addConnection(City* src_city, City* dest_city, uint32_t dist)
-{
-    Connection** connections = src_city->connections;
-    while(*connections)
-        connections++;
-    *connections = (Connection*)calloc(1, sizeof(Connection));
-    if(*connections == NULL)
-    {
-        printf("could not malloc connection for %s to %s", src_city->name, dest_city->name);
-        exit(0);
-    }
-    (*connections)->distance = dist;
-    (*connections)->connected_city = dest_city;
-}
-
-/// @brief an initializer function for a city struct
-/// @param name the name of the city
-/// @param dist the straight distance to Bucharest
-/// @return a city struct with the given data
-City* createCity(char* name, uint16_t dist)
-{
-    City* res = (City*)calloc(1, sizeof(City));
-    if(res == NULL)
-    {
-        printf("Error allocating city\n");
-        exit(0);
-    }
-    res->straight_distance = dist;
-    res->name = name;
-    return res;
-}
-
-/// @brief a function to search an array for a city of a specific name
-/// @param name name of the target city 
-/// @param city_list a list of cities
-/// @param list_len the length of the list of cities
-/// @return a pointer to the city
-City* getCity(char* name, City* city_list[], uint32_t list_len)
-{
-    for(int i = 0; i < list_len; i++)
-    {
-        if(strcmp(name, city_list[i]->name) == 0)
-            return city_list[i];
-    }
-    printf("Could not find city %s\n", name);
-    exit(1);
-}
-
-#pragma endregion
-
-#pragma region /* Generic utility functions/abstractions */
-/// @brief iterates through an array of pointers and finds the index of the first null pointer
-/// @param arr the array you want to find the length of
-/// @return the length of the array
-uint32_t nullTermArrLen(void *arr[])
-{
-    uint32_t count = 0;
-    for(int i = 0; true; i++)
-    {
-        if((void*)arr[i] == NULL)return i;
-    }
-}
-
-/// @brief Since the search functions modify the original cities
-///        this resets those changes
-/// @param cities an array of cities
-/// @param arr_size the size of the cities arr
-void resetCities(City* cities[], uint32_t arr_size)
-{
-    for(int i = 0; i < arr_size; i++)
-    {
-        cities[i]->visited.addedBy = NULL;
-    }
-}
-#pragma endregion
-
-#pragma region /* Search algorithm implementations*/
-/// @brief walks cities by their 'addedBy' property to create
-///        a list of cities representing a path from start to finish
-/// @param end a pointer the the last city in a path
-/// @return an array of City* in order of pathing from start to finish
-City** walkBack(City* start, City* end)
-{
-    
-    Stack stack = {0};
-    push(&stack, node_createNode(end));
-
-    // loop until you traced your steps back to the start of the path
-    while(end != start)
-    {
-        // push each visited city onto a stack in reverse order they were visited
-        push(&stack, node_createNode(end->visited.addedBy));
-        
-        // walk backwards along the path to trace it
-        end = end->visited.addedBy;
-    }
-    
-    // allocate memory for a list of cities
-    City** path = (City**)calloc(stack.size + 1, sizeof(City*));
-    if(!path)
-    {
-        perror("unable to calloc in walkback");
-        exit(0);
-    }
-
-    // pop cities off the stack to get them in the correct order
-    // and add them to the list as they get popped
-    for(int i = 0; stack.size > 0; i++)
-    {
-        path[i] = (City*)pop(&stack)->data;
+        for(uint32_t i = 0; argc > 5 && i < server->engine->pool->num_workers; i++)
+            server->engine->contexts[i]->anytime.budget_ns = strtoull(argv[5], NULL, 10) * 1000;
+        struct sigaction action = {0};
+        action.sa_handler = queryServer_interrupt;
+        serving = server;
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+        queryServer_run(server);
+        serving = NULL;
+        queryServer_free(server);
+        graph_free(served);
+        return 0;
     }
-    
-    return path;
-}
-
-/// @brief Breadth first search of a graph
-/// @param start a pointer to the city you wish to start at
-/// @param end a pointer to the city you wish to end at
-/// @return a list of cities in the order of the path found
-City** breadthFirst(City* start, City* end)
-{
-    // Set up a queue structure for the search process
-    Queue queue = {NULL, NULL};
-    Node* currentNode = NULL;
-
-    // enque the start city
-    queue_enqueue(&queue, node_createNode((void*)start));
+#endif
 
-    // loop until there are no more cities in the queue
-    // (which will only happen if the target cant be found)
-    while(currentNode = queue_dequeue(&queue))
+    // "route <file> <x> <y> <x> <y>" snaps two points to the nearest cities of a
+    // graph file and prints the A* path between them, guided by the coordinates
+    if(argc > 6 && strcmp(argv[1], "route") == 0)
     {
-        City* currentCity = (City*)currentNode->data;
-
-        // if we have dequeued the target city from the queue
-        // we have reached our destination and should walk back
-        // through the queueing process to trace our path to the
-        // destination
-        if(currentCity == end) 
-            return walkBack(start, currentCity);
-
-        // we get the number of connections in the current 
-        // cities connections array
-        uint32_t connections_arr_len = \
-            nullTermArrLen((void**)(currentCity)->connections);
-
-        // loop over each connection and queue the connected city
-        for(int i = 0; i < connections_arr_len; i++)
+        Graph* routed = graph_load(argv[2]);
+        if(routed == NULL)
+            return 1;
+        routed->spatial = spatialIndex_build(routed);
+        uint32_t start = spatialIndex_nearest(routed->spatial, atoi(argv[3]), atoi(argv[4]));
+        uint32_t end = spatialIndex_nearest(routed->spatial, atoi(argv[5]), atoi(argv[6]));
+        if(start == SPATIAL_NONE)
         {
-            City* connected_city = \
-                currentCity->connections[i]->connected_city;
-            
-            // if the city to be added is the starting city 
-            // or has already been visited skip it
-            if(connected_city->visited.addedBy != NULL || connected_city == start)continue;
-
-            // set the city as "visited" by storing a reference to the city that added it
-            connected_city->visited.addedBy = currentCity;
-
-            // queue the connected city
-            queue_enqueue(&queue, node_createNode(connected_city));
+            graph_free(routed);
+            return 1;
         }
-        // free the node we no longer need it once its been dequeued
-        free(currentNode);
-    }
-
-    return NULL;
-}
-
-/// @brief Depth first search of a graph
-/// @param start a pointer to the city you wish to start at
-/// @param end a pointer to the city you wish to end at
-/// @return a list of cities in the order of the path found
-City** depthFirst(City* start, City* end)
-{
-    Stack stack = {NULL, 0};
-    Node* currentNode = NULL;
-
-    push(&stack, node_createNode((void*)start));
-
-    // loop until there are no more cities in the stack
-    // (which will only happen if the target cant be found)
-    while(currentNode = pop(&stack))
-    {
-        City* currentCity = (City*)currentNode->data;
-
-        // if we have dequeued the target city from the queue
-        // we have reached our destination and should walk back
-        // through the queueing process to trace our path to the
-        // destination
-        if(currentCity == end) 
-            return walkBack(start, currentCity);
-
-        // we get the number of connections in the current 
-        // cities connections array
-        uint32_t connections_arr_len = \
-            nullTermArrLen((void**)(currentCity)->connections);
-
-        // loop over each connection and queue the connected city
-        for(int i = 0; i < connections_arr_len; i++)
-        {
-            City* connected_city = \
-                currentCity->connections[i]->connected_city;
-            
-            // if the city to be added is the starting city 
-            // or has already been visited skip it
-            if(connected_city->visited.addedBy != NULL || connected_city == start)continue;
-
-            // set the city as "visited" by storing a reference to the city that added it
-            connected_city->visited.addedBy = currentCity;
-
-            // queue the connected city
-            push(&stack, node_createNode(connected_city));
-        }
-        // free the node we no longer need it once its been dequeued
-        free(currentNode);
-    }
-
-    return NULL;
-}
-
-/// @brief A* search of a graph
-/// @param start a pointer to the city you wish to start at
-/// @param end a pointer to the city you wish to end at
-/// @return a list of cities in the order of the path found
-City** AStar(City* start, City* end)
-{
-    // Set up a queue structure for the search process
-    PQueue pqueue = {NULL};
-    PNode* currentNode = NULL;
-
-    // enque the start city
-    pqueue_enqueue(&pqueue, pnode_createNode((void*)start, start->straight_distance));
-    start->visited.visited = true;
-
-    // loop until there are no more cities in the queue
-    // (which will only happen if the target cant be found)
-    while(currentNode = pqueue_dequeue(&pqueue))
-    {
-        City* currentCity = (City*)currentNode->data;
-
-        // if we have dequeued the target city from the queue
-        // we have reached our destination and should walk back
-        // through the queueing process to trace our path to the
-        // destination
-        if(currentCity == end) 
-            return walkBack(start, currentCity);
-
-        // we get the number of connections in the current 
-        // cities connections array
-        uint32_t connections_arr_len = \
-            nullTermArrLen((void**)(currentCity)->connections);
-
-        // loop over each connection and queue the connected city
-        for(int i = 0; i < connections_arr_len; i++)
+        SearchContext* route_ctx = searchContext_create(routed);
+        Path path = path_init(NULL, NULL, 0);
+        path_find(&path, routed, route_ctx, AStar_run, start, end);
+        for(uint32_t i = 0; i < path.len; i++)
         {
-            // alias to access the connected city easier
-            City* connected_city = \
-                currentCity->connections[i]->connected_city;
-            
-            // calcuate (possibly new) score for the connected city
-            uint32_t new_score = \
-                currentNode->score - ((City*)currentNode->data)->straight_distance + currentCity->connections[i]->distance + currentCity->straight_distance;
-
-            // Check if the target city is already in the priority queue
-            PNode* temp_node = pqueue_findInQueue(&pqueue, connected_city);
-            if(temp_node != NULL)
-            {
-                // if the target city is in the queue already we should modify
-                // that rather than add a new entry to the queue
-                if(temp_node->score > new_score)
-                {
-                    //replace the node representing connected_city a node of different score
-                    //and update what city added it
-                    pqueue_replaceSpecific(&pqueue, connected_city, new_score);
-                    connected_city->visited.addedBy = currentCity;
-                }
-            }
-            // if the target city isnt in the queue already we should add it
-            else
-            {
-                if(connected_city->visited.addedBy != NULL)continue;
-                connected_city->visited.addedBy = currentCity;
-                // queue the connected city
-                pqueue_enqueue(&pqueue, pnode_createNode(connected_city, new_score));
-            }
+            const City* city = routed->cities + path.nodes[i];
+            printf("%u (%d, %d) - Running Cost: %u\n", path.nodes[i], city->x, city->y, path.costs[i]);
         }
-        // free the node we no longer need it once its been dequeued
-        free(currentNode);
-    }
-
-    return NULL;
-}
-#pragma endregion
-
-
-int costCalc(City* a, City* b)
-{
-    uint32_t num_connections = nullTermArrLen((void**)a->connections);
-    for(int i = 0; i < num_connections; i++)
-    {
-        if(a->connections[i]->connected_city == b)return a->connections[i]->distance;
-    }
-}
-
-// This is a function to run the algorithms with given cities
-typedef City** Algo(City*, City*);
-void RunAlgo(City* start, City* end, Algo func, City** arr, uint32_t size)
-{
-    City** buf = func(start, end);
-    uint32_t cost = 0, buf_len = nullTermArrLen((void**)buf);
-
-
-    printf("\n%s to %s\n", start->name, end->name);
-    for(int i = 0; i < buf_len; i++)
-    {
-        printf("%s - Running Cost: %d\n", buf[i]->name, cost);
-        if(i + 1 != buf_len)cost += costCalc(buf[i], buf[i+1]);
+        printf("Total Cost: %u\n", path.cost);
+        path_free(&path);
+        searchContext_free(route_ctx);
+        graph_free(routed);
+        return 0;
     }
-    printf("Total Cost: %d\n", cost);
 
-    free(buf);
-    resetCities(arr, size);
-}
+    // "load <file>" runs the example paths on a graph file written by "save <file>"
+    Graph* loaded = NULL;
+    if(argc > 2 && strcmp(argv[1], "load") == 0 && (loaded = graph_load(argv[2])) == NULL)
+        return 1;
 
-int main()
-{
     const unsigned citiesLen = 20;
-    City* cities[20] = {
+    City cities[20] = {
         createCity("Arad", 366),
         createCity("Bucharest", 0),
         createCity("Craiova", 160),
@@ -604,7 +161,8 @@ int main()
 
     #pragma region /* Setting up connections */
     #define getCityFromList(a) getCity(a, cities, citiesLen)
-    #define addConnection2Way(a, b, c) addConnection(a, b, c);addConnection(b, a, c);
+    EdgeList edges = {0};
+    #define addConnection2Way(a, b, c) edgeList_add(&edges, a, b, c);edgeList_add(&edges, b, a, c);
     
     addConnection2Way(getCityFromList("Arad"),      getCityFromList("Sibiu"),          140);
     addConnection2Way(getCityFromList("Arad"),      getCityFromList("Zerind"),         75);
@@ -633,22 +191,75 @@ int main()
     //#undef getCityFromList
     #undef addConnection2Way
     #pragma endregion 
-    #define RunAlgo(a, b, c) RunAlgo(getCityFromList(a), getCityFromList(b), c, cities, citiesLen)
+
+    // pack the cities and connections into the search graph
+    Graph* graph = loaded ? loaded : graph_build(cities, citiesLen, &edges);
+    edgeList_free(&edges);
+    if(argc > 2 && strcmp(argv[1], "save") == 0)
+    {
+        bool saved = graph_save(graph, argv[2]);
+        graph_free(graph);
+        return saved ? 0 : 1;
+    }
+    graph->ch = contractionHierarchy_build(graph);
+    graph->landmarks = landmarks_build(graph, 4);
+    SearchContext* ctx = searchContext_create(graph);
+
+    // "trace <file>" records every expansion of the example searches as a Chrome trace
+#ifdef SEARCH_STATS
+    ChromeTrace* trace = NULL;
+    if(argc > 2 && strcmp(argv[1], "trace") == 0)
+    {
+        if((trace = chromeTrace_open(argv[2])) == NULL)
+            return 1;
+        ctx->trace = chromeTrace_hook;
+        ctx->trace_arg = trace;
+    }
+#else
+    if(argc > 2 && strcmp(argv[1], "trace") == 0)
+    {
+        printf("tracing needs a build with -DSEARCH_STATS\n");
+        return 1;
+    }
+#endif
+    #define RunAlgo(a, b, c) RunAlgo(graph, ctx, getCity(a, graph->cities, graph->num_nodes), getCity(b, graph->cities, graph->num_nodes), c)
 
     printf("\nBreadth First Paths\n");
-    RunAlgo("Oradea", "Bucharest", breadthFirst);
-    RunAlgo("Timisoara", "Bucharest", breadthFirst);
-    RunAlgo("Neamt", "Bucharest", breadthFirst);
+    RunAlgo("Oradea", "Bucharest", breadthFirst_run);
+    RunAlgo("Timisoara", "Bucharest", breadthFirst_run);
+    RunAlgo("Neamt", "Bucharest", breadthFirst_run);
 
     printf("\nDepth First Paths\n");
-    RunAlgo("Oradea", "Bucharest", depthFirst);
-    RunAlgo("Timisoara", "Bucharest", depthFirst);
-    RunAlgo("Neamt", "Bucharest", depthFirst);
+    RunAlgo("Oradea", "Bucharest", depthFirst_run);
+    RunAlgo("Timisoara", "Bucharest", depthFirst_run);
+    RunAlgo("Neamt", "Bucharest", depthFirst_run);
 
     printf("\nAStar Paths\n");
-    RunAlgo("Oradea", "Bucharest", AStar);
-    RunAlgo("Timisoara", "Bucharest", AStar);
-    RunAlgo("Neamt", "Bucharest", AStar);
+    RunAlgo("Oradea", "Bucharest", AStar_run);
+    RunAlgo("Timisoara", "Bucharest", AStar_run);
+    RunAlgo("Neamt", "Bucharest", AStar_run);
+
+    printf("\nBidirectional Breadth First Paths\n");
+    RunAlgo("Oradea", "Bucharest", bidirectionalBreadthFirst_run);
+    RunAlgo("Timisoara", "Bucharest", bidirectionalBreadthFirst_run);
+    RunAlgo("Neamt", "Bucharest", bidirectionalBreadthFirst_run);
+
+    printf("\nBidirectional AStar Paths\n");
+    RunAlgo("Oradea", "Bucharest", bidirectionalAStar_run);
+    RunAlgo("Timisoara", "Bucharest", bidirectionalAStar_run);
+    RunAlgo("Neamt", "Bucharest", bidirectionalAStar_run);
+
+    printf("\nContraction Hierarchy Paths\n");
+    RunAlgo("Oradea", "Bucharest", contractionHierarchySearch_run);
+    RunAlgo("Timisoara", "Bucharest", contractionHierarchySearch_run);
+    RunAlgo("Neamt", "Bucharest", contractionHierarchySearch_run);
+
+#ifdef SEARCH_STATS
+    if(trace)
+        chromeTrace_close(trace);
+#endif
+    searchContext_free(ctx);
+    graph_free(graph);
 }
 
 /*
@@ -733,6 +344,85 @@ AStar Paths
     Bucharest - Running Cost: 406
     Total Cost: 406
 
+Bidirectional Breadth First Paths
+
+    Oradea to Bucharest
+    Oradea - Running Cost: 0
+    Sibiu - Running Cost: 151
+    Fagaras - Running Cost: 250
+    Bucharest - Running Cost: 461
+    Total Cost: 461
+
+    Timisoara to Bucharest
+    Timisoara - Running Cost: 0
+    Arad - Running Cost: 118
+    Sibiu - Running Cost: 258
+    Fagaras - Running Cost: 357
+    Bucharest - Running Cost: 568
+    Total Cost: 568
+
+    Neamt to Bucharest
+    Neamt - Running Cost: 0
+    Iasi - Running Cost: 87
+    Vaslui - Running Cost: 179
+    Urziceni - Running Cost: 321
+    Bucharest - Running Cost: 406
+    Total Cost: 406
+
+Bidirectional AStar Paths
+
+    Oradea to Bucharest
+    Oradea - Running Cost: 0
+    Sibiu - Running Cost: 151
+    Rimnicu Vilcea - Running Cost: 231
+    Pitesti - Running Cost: 328
+    Bucharest - Running Cost: 429
+    Total Cost: 429
+
+    Timisoara to Bucharest
+    Timisoara - Running Cost: 0
+    Arad - Running Cost: 118
+    Sibiu - Running Cost: 258
+    Rimnicu Vilcea - Running Cost: 338
+    Pitesti - Running Cost: 435
+    Bucharest - Running Cost: 536
+    Total Cost: 536
+
+    Neamt to Bucharest
+    Neamt - Running Cost: 0
+    Iasi - Running Cost: 87
+    Vaslui - Running Cost: 179
+    Urziceni - Running Cost: 321
+    Bucharest - Running Cost: 406
+    Total Cost: 406
+
+Contraction Hierarchy Paths
+
+    Oradea to Bucharest
+    Oradea - Running Cost: 0
+    Sibiu - Running Cost: 151
+    Rimnicu Vilcea - Running Cost: 231
+    Pitesti - Running Cost: 328
+    Bucharest - Running Cost: 429
+    Total Cost: 429
+
+    Timisoara to Bucharest
+    Timisoara - Running Cost: 0
+    Arad - Running Cost: 118
+    Sibiu - Running Cost: 258
+    Rimnicu Vilcea - Running Cost: 338
+    Pitesti - Running Cost: 435
+    Bucharest - Running Cost: 536
+    Total Cost: 536
+
+    Neamt to Bucharest
+    Neamt - Running Cost: 0
+    Iasi - Running Cost: 87
+    Vaslui - Running Cost: 179
+    Urziceni - Running Cost: 321
+    Bucharest - Running Cost: 406
+    Total Cost: 406
+
 Discussion of correctness:
 
     After some analysis of the results of the independent runs of the search algorithms
@@ -758,4 +448,4 @@ Discussion of efficiency:
     The ability to completely ignore many nodes of a network because of a more complex heuristic approach
     saves many many accesses to extraneous nodes thus massively reducing the computational impact and the
     memory footprint of the search.
-*/
\ No newline at end of file
+*/
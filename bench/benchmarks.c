@@ -0,0 +1,1850 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+#include "containers.h"
+#include "graph.h"
+#include "graph_file.h"
+#include "graph_import.h"
+#include "search_context.h"
+#include "util.h"
+#include "relax_filter.h"
+#include "landmarks.h"
+#include "spatial_index.h"
+#include "graph_order.h"
+#include "search.h"
+#include "bounded_search.h"
+#include "anytime_search.h"
+#include "contraction_hierarchy.h"
+#include "distance_table.h"
+#include "replanner.h"
+#include "route_cache.h"
+#include "batch_engine.h"
+#include "parallel_bfs.h"
+#include "delta_stepping.h"
+#include "query_server.h"
+#include "graph_generate.h"
+
+#ifdef __GLIBC__
+// glibc lets a program replace malloc, so these count the allocator calls of
+// each thread for the benchmarks and leave the work to the glibc allocator
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+static _Thread_local uint64_t thread_allocations;
+
+void* malloc(size_t size)
+{
+    thread_allocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    thread_allocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    thread_allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+/// @brief the number of malloc, calloc and realloc calls made by this thread so far
+static inline uint64_t allocationCount()
+{
+    return thread_allocations;
+}
+#else
+/// @brief allocations are only counted with glibc, elsewhere this is always 0
+static inline uint64_t allocationCount()
+{
+    return 0;
+}
+#endif
+
+#ifdef __linux__
+/// @brief opens a counter of the last level cache misses of this thread
+/// @return the counter, -1 when the kernel or the machine does not offer one
+static int cacheMisses_open()
+{
+    struct perf_event_attr attr = {0};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#else
+/// @brief cache misses are only counted on Linux, elsewhere there is no counter
+static int cacheMisses_open()
+{
+    return -1;
+}
+#endif
+
+/// @brief the cache misses counted so far, 0 without a counter
+static uint64_t cacheMisses_read(int counter)
+{
+    uint64_t value = 0;
+    if(counter < 0 || read(counter, &value, sizeof(value)) != sizeof(value))
+        return 0;
+    return value;
+}
+
+/// @brief breadth first search over the linked list Queue, kept so the
+///        benchmarks can compare it against the ring buffer in breadthFirst
+/// @return a list of cities in the order of the path found
+City** breadthFirstLinked(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    Queue queue = {NULL, NULL};
+    Node* currentNode = NULL;
+
+    searchContext_begin(ctx);
+    searchContext_visit(ctx, start, NO_PARENT, 0);
+    queue_enqueue(&queue, node_createNode((void*)&graph->cities[start]));
+
+    while((currentNode = queue_dequeue(&queue)))
+    {
+        uint32_t current = graph_cityId(graph, (City*)currentNode->data);
+        free(currentNode);
+        if(current == end)
+        {
+            while((currentNode = queue_dequeue(&queue)))
+                free(currentNode);
+            return walkBack(graph, ctx, start, current);
+        }
+
+        for(uint32_t i = graph->offsets[current]; i < graph->offsets[current + 1]; i++)
+        {
+            uint32_t connected = graph->targets[i];
+            if(searchContext_visited(ctx, connected))continue;
+            searchContext_visit(ctx, connected, current, ctx->g_scores[current] + graph->weights[i]);
+            queue_enqueue(&queue, node_createNode((void*)&graph->cities[connected]));
+        }
+    }
+
+    return NULL;
+}
+
+/// @brief depth first search over the linked list Stack, kept so the
+///        benchmarks can compare it against the array stack in depthFirst
+/// @return a list of cities in the order of the path found
+City** depthFirstLinked(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    Stack stack = {NULL, 0};
+    Node* currentNode = NULL;
+
+    searchContext_begin(ctx);
+    searchContext_visit(ctx, start, NO_PARENT, 0);
+    push(&stack, node_createNode((void*)&graph->cities[start]));
+
+    while((currentNode = pop(&stack)))
+    {
+        uint32_t current = graph_cityId(graph, (City*)currentNode->data);
+        free(currentNode);
+        if(current == end)
+        {
+            while((currentNode = pop(&stack)))
+                free(currentNode);
+            return walkBack(graph, ctx, start, current);
+        }
+
+        for(uint32_t i = graph->offsets[current]; i < graph->offsets[current + 1]; i++)
+        {
+            uint32_t connected = graph->targets[i];
+            if(searchContext_visited(ctx, connected))continue;
+            searchContext_visit(ctx, connected, current, ctx->g_scores[current] + graph->weights[i]);
+            push(&stack, node_createNode((void*)&graph->cities[connected]));
+        }
+    }
+
+    return NULL;
+}
+
+/// @brief runs the access pattern A* puts on its frontier (push everything,
+///        decrease key on random entries, then drain) against the linked list
+///        priority queue and the indexed heap for growing frontier sizes
+/// @return the process exit code
+int benchPQueue()
+{
+    printf("frontier,list_ms,heap_ms,speedup\n");
+    for(uint32_t n = 1024; n <= (1u << 20); n *= 2)
+    {
+        uint32_t* scores = (uint32_t*)malloc(n * sizeof(uint32_t));
+        uint32_t* decreases = (uint32_t*)malloc(n * sizeof(uint32_t));
+        if(!scores || !decreases)
+        {
+            perror("unable to malloc benchmark data");
+            exit(0);
+        }
+        uint32_t seed = 0x9e3779b9u ^ n;
+        for(uint32_t i = 0; i < n; i++)
+        {
+            scores[i] = xorshift32(&seed) % (n * 8) + n;
+            decreases[i] = xorshift32(&seed) % n;
+        }
+
+        // the list gets too slow to be worth waiting on past this size
+        double list_ms = -1;
+        if(n <= (1u << 14))
+        {
+            PQueue pqueue = {NULL};
+            PNode* node = NULL;
+            uint64_t begin = nowNs();
+            for(uint32_t i = 0; i < n; i++)
+                pqueue_enqueue(&pqueue, pnode_createNode(&scores[i], scores[i]));
+            for(uint32_t i = 0; i < n; i++)
+            {
+                PNode* found = pqueue_findInQueue(&pqueue, &scores[decreases[i]]);
+                if(found && found->score > 0)
+                    pqueue_replaceSpecific(&pqueue, &scores[decreases[i]], found->score - 1);
+            }
+            while((node = pqueue_dequeue(&pqueue)))
+                free(node);
+            list_ms = (nowNs() - begin) / 1e6;
+        }
+
+        IHeap heap = {0};
+        uint32_t id = 0;
+        uint64_t begin = nowNs();
+        for(uint32_t i = 0; i < n; i++)
+            iheap_push(&heap, i, scores[i]);
+        for(uint32_t i = 0; i < n; i++)
+        {
+            if(iheap_contains(&heap, decreases[i]) && iheap_score(&heap, decreases[i]) > 0)
+                iheap_decreaseKey(&heap, decreases[i], iheap_score(&heap, decreases[i]) - 1);
+        }
+        while(iheap_pop(&heap, &id, NULL));
+        double heap_ms = (nowNs() - begin) / 1e6;
+        iheap_free(&heap);
+
+        if(list_ms < 0)
+            printf("%u,,%.3f,\n", n, heap_ms);
+        else
+            printf("%u,%.3f,%.3f,%.1f\n", n, list_ms, heap_ms, list_ms / heap_ms);
+
+        free(scores);
+        free(decreases);
+    }
+    return 0;
+}
+/// @brief runs the same batch of random A* queries on a grid graph with
+///        a growing number of workers and reports the query throughput
+/// @return the process exit code
+int benchBatch()
+{
+    const uint32_t side = 300, num_jobs = 500;
+    Graph* graph = generateGridGraph(side, side, 0x2545f491u);
+
+    RouteJob* jobs = (RouteJob*)malloc(num_jobs * sizeof(RouteJob));
+    RouteResult* results = (RouteResult*)malloc(num_jobs * sizeof(RouteResult));
+    if(!jobs || !results)
+    {
+        perror("unable to malloc batch benchmark data");
+        exit(0);
+    }
+    uint32_t seed = 0x1234567u;
+    for(uint32_t i = 0; i < num_jobs; i++)
+    {
+        jobs[i].start = xorshift32(&seed) % graph->num_nodes;
+        jobs[i].end = xorshift32(&seed) % graph->num_nodes;
+        jobs[i].algo = AStar;
+    }
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("workers,queries,seconds,queries_per_second,checksum\n");
+    for(uint32_t workers = 1; workers <= (cores > 0 ? (uint32_t)cores : 1); workers *= 2)
+    {
+        BatchEngine* engine = batchEngine_create(graph, workers);
+        uint64_t begin = nowNs();
+        batchEngine_run(engine, jobs, results, num_jobs);
+        double seconds = (nowNs() - begin) / 1e9;
+
+        // the checksum should be the same for every worker count
+        uint64_t checksum = 0;
+        for(uint32_t i = 0; i < num_jobs; i++)
+        {
+            checksum += results[i].cost;
+            free(results[i].path);
+        }
+        printf("%u,%u,%.3f,%.0f,%llu\n", workers, num_jobs, seconds, num_jobs / seconds, (unsigned long long)checksum);
+        batchEngine_free(engine);
+    }
+
+    free(jobs);
+    free(results);
+    graph_free(graph);
+    return 0;
+}
+
+/// @brief runs a batch of A* queries where many repeat, some start part way
+///        along a popular route and the rest are random, with and without a
+///        route cache, then changes some weights and runs the batch again
+/// @return the process exit code
+int benchRouteCache()
+{
+    const uint32_t side = 300, num_jobs = 5000, num_popular = 200, num_changes = 200;
+    Graph* graph = generateGridGraph(side, side, 0x6a09e667u);
+    graph->landmarks = landmarks_build(graph, 8);
+    SearchContext* ctx = searchContext_create(graph);
+
+    RouteJob* jobs = (RouteJob*)malloc(num_jobs * sizeof(RouteJob));
+    RouteResult* results = (RouteResult*)malloc(num_jobs * sizeof(RouteResult));
+    uint32_t* expected = (uint32_t*)malloc(num_jobs * sizeof(uint32_t));
+    City*** popular = (City***)malloc(num_popular * sizeof(City**));
+    if(!jobs || !results || !expected || !popular)
+    {
+        perror("unable to malloc route cache benchmark data");
+        exit(0);
+    }
+    uint32_t seed = 0xbb67ae85u;
+    for(uint32_t i = 0; i < num_popular; i++)
+    {
+        jobs[i].start = xorshift32(&seed) % graph->num_nodes;
+        jobs[i].end = xorshift32(&seed) % graph->num_nodes;
+        popular[i] = AStar(graph, ctx, jobs[i].start, jobs[i].end);
+    }
+    for(uint32_t i = num_popular; i < num_jobs; i++)
+    {
+        uint32_t kind = xorshift32(&seed) % 10, pick = xorshift32(&seed) % num_popular;
+        jobs[i] = jobs[pick];
+        if(kind >= 4 && kind < 7)
+        {
+            // a driver already on the way asks again from where they are
+            uint32_t len = nullTermArrLen((void**)popular[pick]);
+            jobs[i].start = graph_cityId(graph, popular[pick][xorshift32(&seed) % len]);
+        }
+        else if(kind >= 7)
+        {
+            jobs[i].start = xorshift32(&seed) % graph->num_nodes;
+            jobs[i].end = xorshift32(&seed) % graph->num_nodes;
+        }
+    }
+    for(uint32_t i = 0; i < num_jobs; i++)
+        jobs[i].algo = AStar;
+
+    // at least a few workers so the shard locks are contended
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t workers = cores > 4 ? (uint32_t)cores : 4;
+    BatchEngine* engine = batchEngine_create(graph, workers);
+    RouteCache* cache = routeCache_create(graph, 4096);
+    printf("phase,queries,workers,uncached_ms,cached_ms,hit_rate,suffix_hit_rate,stale,evictions,mismatches\n");
+    for(int phase = 0; phase < 2; phase++)
+    {
+        if(phase == 1)
+        {
+            // slower traffic on random roads, every cached route is now stale
+            for(uint32_t c = 0; c < num_changes; c++)
+            {
+                uint32_t from = xorshift32(&seed) % graph->num_nodes;
+                uint32_t to = graph->targets[graph->offsets[from]];
+                graph_setWeight(graph, from, to, costCalc(graph, from, to) * 3);
+            }
+        }
+
+        engine->cache = NULL;
+        uint64_t begin = nowNs();
+        batchEngine_run(engine, jobs, results, num_jobs);
+        double uncached_ms = (nowNs() - begin) / 1e6;
+        for(uint32_t i = 0; i < num_jobs; i++)
+        {
+            expected[i] = results[i].cost;
+            free(results[i].path);
+        }
+
+        RouteCacheStats before = routeCache_stats(cache);
+        engine->cache = cache;
+        begin = nowNs();
+        batchEngine_run(engine, jobs, results, num_jobs);
+        double cached_ms = (nowNs() - begin) / 1e6;
+        RouteCacheStats after = routeCache_stats(cache);
+
+        uint32_t mismatches = 0;
+        for(uint32_t i = 0; i < num_jobs; i++)
+        {
+            mismatches += results[i].cost != expected[i];
+            free(results[i].path);
+        }
+        printf("%s,%u,%u,%.1f,%.1f,%.3f,%.3f,%llu,%llu,%u\n", phase ? "after_changes" : "initial", num_jobs, workers, uncached_ms, cached_ms,
+            (double)(after.hits - before.hits) / num_jobs, (double)(after.suffix_hits - before.suffix_hits) / num_jobs,
+            (unsigned long long)(after.stale - before.stale), (unsigned long long)(after.evictions - before.evictions), mismatches);
+    }
+
+    for(uint32_t i = 0; i < num_popular; i++)
+        free(popular[i]);
+    free(popular);
+    free(jobs);
+    free(results);
+    free(expected);
+    routeCache_free(cache);
+    batchEngine_free(engine);
+    searchContext_free(ctx);
+    graph_free(graph);
+    return 0;
+}
+
+/// @brief times A*, bidirectional A* and one to all Dijkstra with each
+///        relaxation filter on graphs with many connections per city, the
+///        filters take turns on every query so they see the same machine
+///        noise and the costs found have to be the same as without a filter
+/// @return the process exit code
+int benchRelaxFilter()
+{
+    const uint32_t num_nodes = 200000, num_queries = 40, num_sweeps = 5;
+    struct { const char* name; RelaxFilter* filter; bool supported; uint64_t ns[3]; uint32_t mismatches; } filters[] = {
+        {"none", relaxFilter_none, true, {0}, 0},
+        {"scalar", relaxFilter_scalar, true, {0}, 0},
+#if defined(__x86_64__) && defined(__GNUC__)
+        {"avx2", relaxFilter_avx2, __builtin_cpu_supports("avx2"), {0}, 0},
+        {"avx512", relaxFilter_avx512, __builtin_cpu_supports("avx512f"), {0}, 0},
+#endif
+    };
+    uint32_t num_filters = sizeof(filters) / sizeof(filters[0]);
+    RelaxFilter* chosen = relaxFilter_best();
+
+    printf("graph,nodes,edges,filter,astar_us,bidirectional_us,one_to_all_ms,mismatches\n");
+    for(int kind = 0; kind < 2; kind++)
+    {
+        Graph* graph = kind == 0 ? generateScaleFreeGraph(num_nodes, 8, 0x3c6ef372u) : generateGeometricGraph(num_nodes, 32, 0x3c6ef372u);
+        SearchContext* ctx = searchContext_create(graph);
+        uint32_t* dist = (uint32_t*)malloc(graph->num_nodes * sizeof(uint32_t));
+        if(!dist)
+        {
+            perror("unable to malloc relaxation benchmark data");
+            exit(0);
+        }
+        IHeap heap = {0};
+        for(uint32_t f = 0; f < num_filters; f++)
+        {
+            memset(filters[f].ns, 0, sizeof(filters[f].ns));
+            filters[f].mismatches = 0;
+        }
+
+        uint32_t seed = 0xa54ff53au;
+        for(uint32_t q = 0; q < num_queries + num_sweeps; q++)
+        {
+            uint32_t start = xorshift32(&seed) % graph->num_nodes, end = xorshift32(&seed) % graph->num_nodes;
+            uint64_t expected[2] = {0};
+            for(uint32_t f = 0; f < num_filters; f++)
+            {
+                if(!filters[f].supported)continue;
+                atomic_store(&relax_filter, filters[f].filter);
+                uint64_t found[2] = {0};
+                if(q < num_queries)
+                {
+                    uint64_t begin = nowNs();
+                    City** path = AStar(graph, ctx, start, end);
+                    filters[f].ns[0] += nowNs() - begin;
+                    found[0] = path ? ctx->g_scores[end] : UINT64_MAX;
+                    free(path);
+
+                    begin = nowNs();
+                    path = bidirectionalAStar(graph, ctx, start, end);
+                    filters[f].ns[1] += nowNs() - begin;
+                    uint32_t len = path ? nullTermArrLen((void**)path) : 0;
+                    for(uint32_t i = 0; i + 1 < len; i++)
+                        found[1] += costCalc(graph, graph_cityId(graph, path[i]), graph_cityId(graph, path[i + 1]));
+                    if(path == NULL)found[1] = UINT64_MAX;
+                    free(path);
+                }
+                else
+                {
+                    uint64_t begin = nowNs();
+                    landmarks_dijkstra(graph->num_nodes, graph->offsets, graph->targets, graph->weights, start, dist, &heap);
+                    filters[f].ns[2] += nowNs() - begin;
+                    for(uint32_t v = 0; v < graph->num_nodes; v++)
+                        found[0] = found[0] * 31 + dist[v];
+                }
+                if(f == 0)
+                    memcpy(expected, found, sizeof(found));
+                filters[f].mismatches += found[0] != expected[0] || found[1] != expected[1];
+            }
+        }
+
+        for(uint32_t f = 0; f < num_filters; f++)
+        {
+            if(!filters[f].supported)continue;
+            printf("%s,%u,%u,%s%s,%.1f,%.1f,%.1f,%u\n", kind == 0 ? "scalefree" : "geometric", graph->num_nodes, graph->num_edges,
+                filters[f].name, filters[f].filter == chosen ? "*" : "", filters[f].ns[0] / 1e3 / num_queries,
+                filters[f].ns[1] / 1e3 / num_queries, filters[f].ns[2] / 1e6 / num_sweeps, filters[f].mismatches);
+        }
+        atomic_store(&relax_filter, chosen);
+        iheap_free(&heap);
+        free(dist);
+        searchContext_free(ctx);
+        graph_free(graph);
+    }
+    return 0;
+}
+
+/// @brief compares snapping points to cities with the k-d tree, one at a time
+///        and in batches, against a scan of every city, then A* on a
+///        geometric graph with and without the coordinate heuristic
+/// @return the process exit code
+int benchSpatialIndex()
+{
+    const uint32_t num_nodes = 500000, num_points = 200000, num_scanned = 1000, num_queries = 100;
+    Graph* graph = generateGeometricGraph(num_nodes, 8, 0x3c6ef372u);
+    uint32_t extent = 100 * isqrtCeil(num_nodes);
+    int32_t* xs = (int32_t*)malloc(num_points * sizeof(int32_t));
+    int32_t* ys = (int32_t*)malloc(num_points * sizeof(int32_t));
+    uint32_t* single = (uint32_t*)malloc(num_points * sizeof(uint32_t));
+    uint32_t* batched = (uint32_t*)malloc(num_points * sizeof(uint32_t));
+    if(!xs || !ys || !single || !batched)
+    {
+        perror("unable to malloc snapping benchmark data");
+        exit(0);
+    }
+    uint32_t seed = 0xa54ff53au;
+    for(uint32_t i = 0; i < num_points; i++)
+    {
+        xs[i] = (int32_t)(xorshift32(&seed) % extent);
+        ys[i] = (int32_t)(xorshift32(&seed) % extent);
+    }
+
+    uint64_t begin = nowNs();
+    SpatialIndex* index = spatialIndex_build(graph);
+    double build_ms = (nowNs() - begin) / 1e6;
+
+    // the scan only covers the first points, it takes a pass over every city each
+    uint64_t scanned[1000];
+    begin = nowNs();
+    for(uint32_t i = 0; i < num_scanned; i++)
+    {
+        scanned[i] = UINT64_MAX;
+        for(uint32_t v = 0; v < graph->num_nodes; v++)
+        {
+            uint64_t dist2 = spatial_dist2(xs[i], ys[i], graph->cities[v].x, graph->cities[v].y);
+            if(dist2 < scanned[i])scanned[i] = dist2;
+        }
+    }
+    double scan_ns = (double)(nowNs() - begin) / num_scanned;
+    uint32_t scan_mismatches = 0;
+    for(uint32_t i = 0; i < num_scanned; i++)
+    {
+        const City* city = graph->cities + spatialIndex_nearest(index, xs[i], ys[i]);
+        scan_mismatches += scanned[i] != spatial_dist2(xs[i], ys[i], city->x, city->y);
+    }
+
+    begin = nowNs();
+    for(uint32_t i = 0; i < num_points; i++)
+        single[i] = spatialIndex_nearest(index, xs[i], ys[i]);
+    double single_ns = (double)(nowNs() - begin) / num_points;
+    begin = nowNs();
+    spatialIndex_nearestMany(index, xs, ys, num_points, batched);
+    double batch_ns = (double)(nowNs() - begin) / num_points;
+
+    // ties may pick different cities, only the distances have to agree
+    uint32_t batch_mismatches = 0;
+    for(uint32_t i = 0; i < num_points; i++)
+    {
+        const City* a = graph->cities + single[i], *b = graph->cities + batched[i];
+        batch_mismatches += spatial_dist2(xs[i], ys[i], a->x, a->y) != spatial_dist2(xs[i], ys[i], b->x, b->y);
+    }
+
+    printf("nodes,build_ms,scale,scan_ns,kdtree_ns,batch_ns,scan_mismatches,batch_mismatches\n");
+    printf("%u,%.1f,%.4f,%.0f,%.0f,%.0f,%u,%u\n", graph->num_nodes, build_ms, index->scale, scan_ns, single_ns, batch_ns,
+        scan_mismatches, batch_mismatches);
+
+    // the same A* queries with no estimate at all, then with the coordinate bound
+    SearchContext* ctx = searchContext_create(graph);
+    uint32_t* costs = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    if(costs == NULL)
+    {
+        perror("unable to malloc snapping benchmark costs");
+        exit(0);
+    }
+    printf("\nheuristic,queries,avg_us,avg_reached,mismatches\n");
+    for(uint32_t pass = 0; pass < 2; pass++)
+    {
+        graph->spatial = pass ? index : NULL;
+        uint64_t total_ns = 0, reached = 0;
+        uint32_t mismatches = 0;
+        seed = 0x510e527fu;
+        for(uint32_t q = 0; q < num_queries; q++)
+        {
+            uint32_t start = spatialIndex_nearest(index, (int32_t)(xorshift32(&seed) % extent), (int32_t)(xorshift32(&seed) % extent));
+            uint32_t end = spatialIndex_nearest(index, (int32_t)(xorshift32(&seed) % extent), (int32_t)(xorshift32(&seed) % extent));
+            begin = nowNs();
+            bool found = AStar_run(graph, ctx, start, end);
+            total_ns += nowNs() - begin;
+            for(uint32_t v = 0; v < ctx->num_nodes; v++)
+                reached += ctx->stamps[v] == ctx->generation;
+            uint32_t cost = found ? ctx->g_scores[end] : UINT32_MAX;
+            if(pass == 0)costs[q] = cost;
+            else mismatches += costs[q] != cost;
+        }
+        printf("%s,%u,%.1f,%.0f,%u\n", pass ? "coordinates" : "none", num_queries, total_ns / 1e3 / num_queries,
+            (double)reached / num_queries, mismatches);
+    }
+
+    graph->spatial = index;
+    free(costs);
+    searchContext_free(ctx);
+    free(xs);
+    free(ys);
+    free(single);
+    free(batched);
+    graph_free(graph);
+    return 0;
+}
+
+/// @brief renumbers a geometric graph, whose cities are listed in random
+///        order, in each order of graph_order and times the same Dijkstra
+///        queries on it with the last level cache misses when they can be counted
+/// @return the process exit code
+int benchReorder()
+{
+    const uint32_t num_nodes = 500000, num_queries = 20;
+    const char* names[] = {"listed", "bfs", "rcm", "hilbert"};
+    uint32_t starts[20], ends[20], costs[20];
+    int counter = cacheMisses_open();
+
+    printf("order,nodes,edges,reorder_ms,mean_gap,avg_query_ms,llc_misses_per_query,mismatches\n");
+    for(uint32_t kind = 0; kind < 4; kind++)
+    {
+        Graph* graph = generateGeometricGraph(num_nodes, 8, 0x9b05688cu);
+        uint64_t begin = nowNs();
+        if(kind > 0)
+            graph_reorder(graph, (GraphOrder)(kind - 1));
+        double reorder_ms = (nowNs() - begin) / 1e6;
+
+        // how far apart in the arrays the two ends of a connection are on average
+        uint64_t gap = 0;
+        for(uint32_t v = 0; v < graph->num_nodes; v++)
+        {
+            for(uint32_t i = graph->offsets[v]; i < graph->offsets[v + 1]; i++)
+                gap += graph->targets[i] > v ? graph->targets[i] - v : v - graph->targets[i];
+        }
+
+        // the queries are picked by the ids the cities were generated with
+        SearchContext* ctx = searchContext_create(graph);
+        uint32_t seed = 0x1f83d9abu, mismatches = 0;
+        uint64_t query_ns = 0, misses = 0;
+        for(uint32_t q = 0; q < num_queries; q++)
+        {
+            starts[q] = xorshift32(&seed) % num_nodes;
+            ends[q] = xorshift32(&seed) % num_nodes;
+            uint32_t start = graph_reorderedId(graph, starts[q]), end = graph_reorderedId(graph, ends[q]);
+            uint64_t begin_misses = cacheMisses_read(counter);
+            begin = nowNs();
+            bool found = AStar_run(graph, ctx, start, end);
+            query_ns += nowNs() - begin;
+            misses += cacheMisses_read(counter) - begin_misses;
+            uint32_t cost = found ? ctx->g_scores[end] : UINT32_MAX;
+            if(kind == 0)costs[q] = cost;
+            else mismatches += costs[q] != cost;
+        }
+
+        printf("%s,%u,%u,%.1f,%.0f,%.1f,", names[kind], graph->num_nodes, graph->num_edges, reorder_ms,
+            (double)gap / graph->num_edges, query_ns / 1e6 / num_queries);
+        if(counter < 0)printf("n/a,");
+        else printf("%.0f,", (double)misses / num_queries);
+        printf("%u\n", mismatches);
+        searchContext_free(ctx);
+        graph_free(graph);
+    }
+    if(counter >= 0)
+        close(counter);
+    return 0;
+}
+
+#ifdef __linux__
+/// @brief the server thread of benchQueryServer
+static void* benchServe_thread(void* arg)
+{
+    queryServer_run((QueryServer*)arg);
+    return NULL;
+}
+
+/// @brief a local client that sends A* requests to a query server keeping up
+///        to depth of them in flight and reads the costs out of the responses
+/// @return the time from the first request to the last response in nanoseconds
+static uint64_t benchServe_client(const char* socket_path, const uint32_t* starts, const uint32_t* ends, uint32_t count,
+    uint32_t depth, uint32_t* costs)
+{
+    struct sockaddr_un address = {0};
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+    {
+        perror(socket_path);
+        exit(0);
+    }
+
+    char request[64], buffer[65536];
+    uint32_t sent = 0, received = 0, buffered = 0;
+    uint64_t begin = nowNs();
+    while(received < count)
+    {
+        // top the window up with one write, then take whatever responses came back
+        char batch[64 * 256];
+        uint32_t batch_len = 0;
+        while(sent < count && sent - received < depth && batch_len + sizeof(request) < sizeof(batch))
+        {
+            int len = snprintf(request, sizeof(request), "astar %u %u\n", starts[sent], ends[sent]);
+            memcpy(batch + batch_len, request, (size_t)len);
+            batch_len += (uint32_t)len;
+            sent++;
+        }
+        if(batch_len && send(fd, batch, batch_len, MSG_NOSIGNAL) != (ssize_t)batch_len)
+        {
+            perror("unable to send requests");
+            exit(0);
+        }
+        ssize_t got = recv(fd, buffer + buffered, sizeof(buffer) - buffered, 0);
+        if(got <= 0)
+        {
+            printf("the server closed the connection\n");
+            exit(0);
+        }
+        buffered += (uint32_t)got;
+        uint32_t consumed = 0;
+        for(uint32_t i = 0; i < buffered; i++)
+        {
+            if(buffer[i] != '\n')continue;
+            buffer[i] = '\0';
+            unsigned cost = UINT32_MAX;
+            if(sscanf(buffer + consumed, "ok %u", &cost) != 1)cost = UINT32_MAX;
+            costs[received++] = cost;
+            consumed = i + 1;
+        }
+        memmove(buffer, buffer + consumed, buffered - consumed);
+        buffered -= consumed;
+    }
+    uint64_t elapsed = nowNs() - begin;
+    close(fd);
+    return elapsed;
+}
+
+/// @brief compares answering short A* queries directly against sending them
+///        to a query server in the same process over its Unix socket, one at
+///        a time and pipelined, next to what building the graph costs a
+///        process that answers a single query
+/// @return the process exit code
+int benchQueryServer()
+{
+    const uint32_t side = 300, num_queries = 20000, reach = 12;
+    const uint32_t depths[] = {1, 16, 256};
+
+    uint64_t begin = nowNs();
+    Graph* graph = generateGridGraph(side, side, 0x6a09e667u);
+    graph->landmarks = landmarks_build(graph, 8);
+    double startup_ms = (nowNs() - begin) / 1e6;
+
+    uint32_t* starts = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint32_t* ends = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint32_t* expected = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint32_t* costs = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    if(!starts || !ends || !expected || !costs)
+    {
+        perror("unable to malloc server benchmark data");
+        exit(0);
+    }
+    uint32_t seed = 0xbb67ae85u;
+    for(uint32_t q = 0; q < num_queries; q++)
+    {
+        uint32_t x = xorshift32(&seed) % (side - reach), y = xorshift32(&seed) % (side - reach);
+        starts[q] = y * side + x;
+        ends[q] = (y + xorshift32(&seed) % reach) * side + x + xorshift32(&seed) % reach;
+    }
+
+    SearchContext* ctx = searchContext_create(graph);
+    begin = nowNs();
+    for(uint32_t q = 0; q < num_queries; q++)
+    {
+        City** path = AStar(graph, ctx, starts[q], ends[q]);
+        expected[q] = path ? ctx->g_scores[ends[q]] : UINT32_MAX;
+        free(path);
+    }
+    double direct_ns = (double)(nowNs() - begin) / num_queries;
+    searchContext_free(ctx);
+
+    char socket_path[64];
+    snprintf(socket_path, sizeof(socket_path), "/tmp/searches-bench-%d.sock", (int)getpid());
+    QueryServer* server = queryServer_create(graph, socket_path, 1);
+    if(server == NULL)
+        return 1;
+    pthread_t thread;
+    pthread_create(&thread, NULL, benchServe_thread, server);
+
+    printf("startup_ms,%.1f\n", startup_ms);
+    printf("\nmode,depth,queries,ns_per_query,queries_per_second,mismatches\n");
+    printf("direct,0,%u,%.0f,%.0f,0\n", num_queries, direct_ns, 1e9 / direct_ns);
+    for(uint32_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++)
+    {
+        uint64_t elapsed = benchServe_client(socket_path, starts, ends, num_queries, depths[d], costs);
+        uint32_t mismatches = 0;
+        for(uint32_t q = 0; q < num_queries; q++)
+            mismatches += costs[q] != expected[q];
+        printf("server,%u,%u,%.0f,%.0f,%u\n", depths[d], num_queries, (double)elapsed / num_queries,
+            num_queries * 1e9 / elapsed, mismatches);
+    }
+
+    queryServer_stop(server);
+    pthread_join(thread, NULL);
+    queryServer_free(server);
+    free(starts);
+    free(ends);
+    free(expected);
+    free(costs);
+    graph_free(graph);
+    return 0;
+}
+#endif
+
+/// @brief runs the memory bounded searches under shrinking ceilings on short
+///        and medium trips across a grid and compares them with A*
+/// @return the process exit code
+int benchBoundedSearch()
+{
+    const uint32_t side = 300, num_queries = 200, reach = 25;
+    Graph* graph = generateGridGraph(side, side, 0x3c6ef372u);
+    graph->landmarks = landmarks_build(graph, 8);
+    SearchContext* ctx = searchContext_create(graph);
+    uint32_t* starts = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint32_t* ends = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint32_t* expected = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    if(!starts || !ends || !expected)
+    {
+        perror("unable to malloc bounded benchmark data");
+        exit(0);
+    }
+    uint32_t seed = 0xa54ff53au;
+    for(uint32_t q = 0; q < num_queries; q++)
+    {
+        uint32_t x = xorshift32(&seed) % (side - reach), y = xorshift32(&seed) % (side - reach);
+        starts[q] = y * side + x;
+        ends[q] = (y + xorshift32(&seed) % reach) * side + x + xorshift32(&seed) % reach;
+    }
+
+    // what A* alone keeps beyond the context arrays is its heap, sized for every city
+    uint64_t begin = nowNs();
+    for(uint32_t q = 0; q < num_queries; q++)
+        expected[q] = AStar_run(graph, ctx, starts[q], ends[q]) ? ctx->g_scores[ends[q]] : UINT32_MAX;
+    double astar_us = (nowNs() - begin) / 1e3 / num_queries;
+
+    const struct{ const char* name; Search* search; size_t limit; } runs[] = {
+        {"idastar", idaStar_run, 0},
+        {"idastar", idaStar_run, 256},
+        {"smastar", memoryBoundedAStar_run, 0},
+        {"smastar", memoryBoundedAStar_run, 64 << 10},
+        {"smastar", memoryBoundedAStar_run, 16 << 10},
+        {"smastar", memoryBoundedAStar_run, 8 << 10},
+        {"smastar", memoryBoundedAStar_run, 4 << 10},
+    };
+    printf("search,limit_bytes,avg_us,avg_peak_bytes,max_peak_bytes,avg_expanded,found,limit_hits,suboptimal\n");
+    printf("astar,-,%.1f,-,-,-,%u,0,0\n", astar_us, num_queries);
+    for(uint32_t r = 0; r < sizeof(runs) / sizeof(runs[0]); r++)
+    {
+        uint64_t total_ns = 0, peak_sum = 0, expanded = 0;
+        size_t peak_max = 0;
+        uint32_t found = 0, hits = 0, suboptimal = 0;
+        ctx->bounded.memory_limit = runs[r].limit;
+        for(uint32_t q = 0; q < num_queries; q++)
+        {
+            begin = nowNs();
+            bool reached = runs[r].search(graph, ctx, starts[q], ends[q]);
+            total_ns += nowNs() - begin;
+            found += reached;
+            suboptimal += reached && ctx->g_scores[ends[q]] != expected[q];
+            hits += ctx->bounded.limit_hit;
+            peak_sum += ctx->bounded.peak_bytes;
+            expanded += ctx->bounded.expanded;
+            if(ctx->bounded.peak_bytes > peak_max)peak_max = ctx->bounded.peak_bytes;
+        }
+        printf("%s,%zu,%.1f,%.0f,%zu,%.0f,%u,%u,%u\n", runs[r].name, runs[r].limit ? runs[r].limit : (size_t)BOUNDED_DEFAULT_LIMIT,
+            total_ns / 1e3 / num_queries, (double)peak_sum / num_queries, peak_max, (double)expanded / num_queries, found, hits, suboptimal);
+    }
+    ctx->bounded.memory_limit = 0;
+
+    free(starts);
+    free(ends);
+    free(expected);
+    searchContext_free(ctx);
+    graph_free(graph);
+    return 0;
+}
+
+/// @brief times whole graph traversals with the linked list containers
+///        against the array backed ones on a grid with millions of cities
+/// @return the process exit code
+int benchContainers()
+{
+    const uint32_t side = 1500, runs = 3;
+    Graph* graph = generateGridGraph(side, side, 0x51ed270bu);
+    SearchContext* ctx = searchContext_create(graph);
+
+    // the end is not a city so every search traverses the whole graph
+    uint32_t start = 0, end = NO_PARENT;
+    struct { const char* name; Algo* algo; } variants[4] = {
+        {"bfs_linked", breadthFirstLinked},
+        {"bfs_ring", breadthFirst},
+        {"dfs_linked", depthFirstLinked},
+        {"dfs_array", depthFirst}
+    };
+
+    printf("container,nodes,best_ms\n");
+    for(int v = 0; v < 4; v++)
+    {
+        double best_ms = 0;
+        for(uint32_t run = 0; run < runs; run++)
+        {
+            uint64_t begin = nowNs();
+            variants[v].algo(graph, ctx, start, end);
+            double ms = (nowNs() - begin) / 1e6;
+            if(run == 0 || ms < best_ms)best_ms = ms;
+        }
+        printf("%s,%u,%.2f\n", variants[v].name, graph->num_nodes, best_ms);
+    }
+
+    searchContext_free(ctx);
+    graph_free(graph);
+    return 0;
+}
+
+/// @brief preprocesses a grid into a contraction hierarchy and compares its
+///        queries against AStar on the same random city pairs
+/// @return the process exit code
+int benchContractionHierarchy()
+{
+    const uint32_t side = 200, num_queries = 1000;
+    Graph* graph = generateGridGraph(side, side, 0x6a09e667u);
+
+    uint64_t begin = nowNs();
+    graph->ch = contractionHierarchy_build(graph);
+    double build_ms = (nowNs() - begin) / 1e6;
+
+    SearchContext* ctx = searchContext_create(graph);
+    uint64_t astar_ns = 0, ch_ns = 0;
+    uint32_t mismatches = 0, seed = 0xbb67ae85u;
+    for(uint32_t q = 0; q < num_queries; q++)
+    {
+        uint32_t start = xorshift32(&seed) % graph->num_nodes, end = xorshift32(&seed) % graph->num_nodes;
+
+        begin = nowNs();
+        free(AStar(graph, ctx, start, end));
+        astar_ns += nowNs() - begin;
+        uint32_t astar_cost = ctx->g_scores[end];
+
+        begin = nowNs();
+        free(contractionHierarchySearch(graph, ctx, start, end));
+        ch_ns += nowNs() - begin;
+        if(ctx->g_scores[end] != astar_cost)mismatches++;
+    }
+
+    printf("nodes,shortcuts,build_ms,astar_us,ch_us,speedup,mismatches\n");
+    printf("%u,%u,%.1f,%.2f,%.2f,%.1f,%u\n", graph->num_nodes, graph->ch->num_shortcuts, build_ms,
+        astar_ns / 1e3 / num_queries, ch_ns / 1e3 / num_queries, (double)astar_ns / ch_ns, mismatches);
+
+    searchContext_free(ctx);
+    graph_free(graph);
+    return 0;
+}
+
+/// @brief compares AStar with and without landmark bounds on the same random
+///        city pairs of a grid, which has no straight line distances to use
+/// @return the process exit code
+int benchLandmarks()
+{
+    const uint32_t side = 300, num_queries = 300, num_landmarks = 8;
+    Graph* graph = generateGridGraph(side, side, 0x3c6ef372u);
+    SearchContext* ctx = searchContext_create(graph);
+
+    uint32_t* starts = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint32_t* ends = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint32_t* costs = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    if(!starts || !ends || !costs)
+    {
+        perror("unable to malloc landmark benchmark data");
+        exit(0);
+    }
+    uint32_t seed = 0xa54ff53au;
+    for(uint32_t q = 0; q < num_queries; q++)
+    {
+        starts[q] = xorshift32(&seed) % graph->num_nodes;
+        ends[q] = xorshift32(&seed) % graph->num_nodes;
+    }
+
+    uint64_t begin = nowNs();
+    for(uint32_t q = 0; q < num_queries; q++)
+    {
+        free(AStar(graph, ctx, starts[q], ends[q]));
+        costs[q] = ctx->g_scores[ends[q]];
+    }
+    double plain_us = (nowNs() - begin) / 1e3 / num_queries;
+
+    begin = nowNs();
+    graph->landmarks = landmarks_build(graph, num_landmarks);
+    double build_ms = (nowNs() - begin) / 1e6;
+
+    uint32_t mismatches = 0;
+    begin = nowNs();
+    for(uint32_t q = 0; q < num_queries; q++)
+    {
+        free(AStar(graph, ctx, starts[q], ends[q]));
+        if(ctx->g_scores[ends[q]] != costs[q])mismatches++;
+    }
+    double alt_us = (nowNs() - begin) / 1e3 / num_queries;
+
+    printf("nodes,landmarks,build_ms,astar_us,alt_us,speedup,mismatches\n");
+    printf("%u,%u,%.1f,%.2f,%.2f,%.1f,%u\n", graph->num_nodes, num_landmarks, build_ms, plain_us, alt_us, plain_us / alt_us, mismatches);
+
+    free(starts);
+    free(ends);
+    free(costs);
+    searchContext_free(ctx);
+    graph_free(graph);
+    return 0;
+}
+
+/// @brief compares repairing a route with the replanner after a few
+///        connections got longer against searching for it again with A*, once
+///        with the changes on random roads only and once with one of them on
+///        the current route every round
+/// @return the process exit code
+int benchReplanner()
+{
+    const uint32_t side = 300, num_queries = 50, rounds = 10, random_changes = 4;
+    printf("changes,nodes,queries,replans,changes_per_replan,first_plan_us,astar_us,replan_us,astar_reached,replan_expanded,speedup,mismatches\n");
+    for(int on_route = 0; on_route < 2; on_route++)
+    {
+        Graph* graph = generateGridGraph(side, side, 0x9b05688cu);
+        graph->landmarks = landmarks_build(graph, 8);
+        SearchContext* ctx = searchContext_create(graph);
+        uint32_t seed = 0x1f83d9abu, mismatches = 0;
+        uint64_t astar_ns = 0, first_ns = 0, replan_ns = 0, replan_expanded = 0, astar_reached = 0;
+
+        for(uint32_t q = 0; q < num_queries; q++)
+        {
+            uint32_t start = xorshift32(&seed) % graph->num_nodes, end = xorshift32(&seed) % graph->num_nodes;
+            Replanner* rp = replanner_create(graph, start, end);
+            uint64_t begin = nowNs();
+            City** path = replanner_plan(rp);
+            first_ns += nowNs() - begin;
+
+            for(uint32_t r = 0; r < rounds; r++)
+            {
+                // a connection on the route gets slower, every fifth round one is closed
+                uint32_t len = path ? nullTermArrLen((void**)path) : 0;
+                if(on_route && len > 1)
+                {
+                    uint32_t at = xorshift32(&seed) % (len - 1);
+                    uint32_t from = graph_cityId(graph, path[at]), to = graph_cityId(graph, path[at + 1]);
+                    uint32_t weight = r % 5 == 4 ? CONNECTION_CLOSED : costCalc(graph, from, to) * (2 + xorshift32(&seed) % 4);
+                    graph_setWeight(graph, from, to, weight);
+                    replanner_connectionChanged(rp, from, to);
+                }
+                for(uint32_t c = 0; c < random_changes; c++)
+                {
+                    uint32_t from = xorshift32(&seed) % graph->num_nodes;
+                    uint32_t degree = graph->offsets[from + 1] - graph->offsets[from];
+                    uint32_t to = graph->targets[graph->offsets[from] + xorshift32(&seed) % degree];
+                    uint32_t weight = costCalc(graph, from, to);
+                    if(weight == CONNECTION_CLOSED)continue;
+                    graph_setWeight(graph, from, to, weight * (2 + xorshift32(&seed) % 4));
+                    replanner_connectionChanged(rp, from, to);
+                }
+                free(path);
+
+                begin = nowNs();
+                path = replanner_plan(rp);
+                replan_ns += nowNs() - begin;
+                replan_expanded += rp->expanded;
+
+                begin = nowNs();
+                City** fresh = AStar(graph, ctx, start, end);
+                astar_ns += nowNs() - begin;
+                for(uint32_t v = 0; v < ctx->num_nodes; v++)
+                    astar_reached += ctx->stamps[v] == ctx->generation;
+
+                // the repaired route has to cost what a fresh search finds and
+                // its connections have to add up to that cost
+                uint32_t expected = fresh ? ctx->g_scores[end] : REPLAN_INFINITY, cost = 0;
+                len = path ? nullTermArrLen((void**)path) : 0;
+                for(uint32_t i = 0; i + 1 < len; i++)
+                    cost += costCalc(graph, graph_cityId(graph, path[i]), graph_cityId(graph, path[i + 1]));
+                if(replanner_cost(rp) != expected || (path && cost != expected) || (path == NULL) != (fresh == NULL))mismatches++;
+                free(fresh);
+            }
+            free(path);
+            replanner_free(rp);
+        }
+
+        uint32_t replans = num_queries * rounds;
+        printf("%s,%u,%u,%u,%u,%.1f,%.1f,%.1f,%.0f,%.0f,%.1f,%u\n", on_route ? "on_route" : "off_route", graph->num_nodes, num_queries,
+            replans, random_changes + on_route, first_ns / 1e3 / num_queries, astar_ns / 1e3 / replans, replan_ns / 1e3 / replans,
+            (double)astar_reached / replans, (double)replan_expanded / replans, (double)astar_ns / replan_ns, mismatches);
+        searchContext_free(ctx);
+        graph_free(graph);
+    }
+    return 0;
+}
+
+/// @brief compares building a grid graph from its connection list against
+///        mapping the same graph from a binary graph file
+/// @return the process exit code
+int benchGraphFile()
+{
+    const uint32_t side = 1000, runs = 5;
+    Graph* graph = generateGridGraph(side, side, 0x510e527fu);
+    char path[] = "/tmp/searches-graph-XXXXXX";
+    int fd = mkstemp(path);
+    if(fd < 0)
+    {
+        perror("unable to create a temporary graph file");
+        exit(0);
+    }
+    close(fd);
+
+    // the connection list graph_build starts from, rebuilt from the graph
+    EdgeList edges = {0};
+    for(uint32_t v = 0; v < graph->num_nodes; v++)
+    {
+        for(uint32_t i = graph->offsets[v]; i < graph->offsets[v + 1]; i++)
+            edgeList_add(&edges, v, graph->targets[i], graph->weights[i]);
+    }
+
+    uint64_t begin = nowNs();
+    bool saved = graph_save(graph, path);
+    double save_ms = (nowNs() - begin) / 1e6;
+    if(!saved)
+        exit(1);
+
+    double build_ms = 1e30, load_ms = 1e30;
+    uint32_t checksum = 0;
+    for(uint32_t r = 0; r < runs; r++)
+    {
+        begin = nowNs();
+        Graph* built = graph_build(graph->cities, graph->num_nodes, &edges);
+        double ms = (nowNs() - begin) / 1e6;
+        if(ms < build_ms)build_ms = ms;
+        graph_free(built);
+
+        begin = nowNs();
+        Graph* mapped = graph_load(path);
+        ms = (nowNs() - begin) / 1e6;
+        if(ms < load_ms)load_ms = ms;
+        if(mapped == NULL)
+            exit(1);
+        // touch every page once so a broken mapping shows up here
+        for(uint32_t i = 0; i < mapped->num_edges; i += 1024)
+            checksum += mapped->targets[i] ^ mapped->weights[i];
+        graph_free(mapped);
+    }
+
+    printf("nodes,edges,save_ms,build_ms,load_ms,checksum\n");
+    printf("%u,%u,%.1f,%.2f,%.3f,%u\n", graph->num_nodes, graph->num_edges, save_ms, build_ms, load_ms, checksum);
+
+    unlink(path);
+    edgeList_free(&edges);
+    graph_free(graph);
+    return 0;
+}
+
+/// @brief writes a grid graph as DIMACS and CSV files and times importing
+///        them, then compares resolving connection names with getCity against
+///        the name table the CSV importer uses
+/// @return the process exit code
+int benchImport()
+{
+    const uint32_t side = 1000, num_lookups = 200;
+    Graph* graph = generateGridGraph(side, side, 0x9b05688cu);
+    char gr_path[] = "/tmp/searches-gr-XXXXXX";
+    char co_path[] = "/tmp/searches-co-XXXXXX";
+    char csv_path[] = "/tmp/searches-csv-XXXXXX";
+    char nodes_path[] = "/tmp/searches-nodes-XXXXXX";
+    char* paths[] = {gr_path, co_path, csv_path, nodes_path};
+    FILE* files[4];
+    for(int f = 0; f < 4; f++)
+    {
+        int fd = mkstemp(paths[f]);
+        if(fd < 0 || (files[f] = fdopen(fd, "w")) == NULL)
+        {
+            perror("unable to create a temporary import file");
+            exit(0);
+        }
+    }
+    fprintf(files[0], "c grid benchmark\np sp %u %u\n", graph->num_nodes, graph->num_edges);
+    fprintf(files[1], "p aux sp co %u\n", graph->num_nodes);
+    fprintf(files[2], "from,to,distance\n");
+    fprintf(files[3], "name,straight_distance,x,y\n");
+    for(uint32_t v = 0; v < graph->num_nodes; v++)
+    {
+        fprintf(files[1], "v %u %u %u\n", v + 1, v % side, v / side);
+        fprintf(files[3], "c%u,0,%u,%u\n", v, v % side, v / side);
+        for(uint32_t i = graph->offsets[v]; i < graph->offsets[v + 1]; i++)
+        {
+            fprintf(files[0], "a %u %u %u\n", v + 1, graph->targets[i] + 1, graph->weights[i]);
+            fprintf(files[2], "c%u,c%u,%u\n", v, graph->targets[i], graph->weights[i]);
+        }
+    }
+    for(int f = 0; f < 4; f++)
+        fclose(files[f]);
+
+    uint64_t begin = nowNs();
+    Graph* dimacs = graph_importDimacs(gr_path, co_path);
+    double dimacs_ms = (nowNs() - begin) / 1e6;
+    begin = nowNs();
+    Graph* csv = graph_importCsv(csv_path, nodes_path, false);
+    double csv_ms = (nowNs() - begin) / 1e6;
+    if(dimacs == NULL || csv == NULL)
+        exit(1);
+
+    // both imports have to reproduce the grid connection for connection, the
+    // city file lists the CSV cities in grid order so their ids match too
+    uint32_t mismatches = 0;
+    for(uint32_t i = 0; i < graph->num_edges; i++)
+    {
+        if(dimacs->targets[i] != graph->targets[i] || dimacs->weights[i] != graph->weights[i])mismatches++;
+        if(csv->targets[i] != graph->targets[i] || csv->weights[i] != graph->weights[i])mismatches++;
+    }
+
+    NameTable names = {0};
+    for(uint32_t v = 0; v < csv->num_nodes; v++)
+        nameTable_intern(&names, csv->cities[v].name, NULL);
+    uint32_t seed = 0x1f83d9abu, checksum = 0;
+    uint32_t* lookups = (uint32_t*)malloc(num_lookups * sizeof(uint32_t));
+    if(lookups == NULL)
+    {
+        perror("unable to malloc import benchmark data");
+        exit(0);
+    }
+    for(uint32_t q = 0; q < num_lookups; q++)
+        lookups[q] = xorshift32(&seed) % csv->num_nodes;
+    begin = nowNs();
+    for(uint32_t q = 0; q < num_lookups; q++)
+        checksum += getCity(csv->cities[lookups[q]].name, csv->cities, csv->num_nodes);
+    double scan_us = (nowNs() - begin) / 1e3 / num_lookups;
+    begin = nowNs();
+    for(uint32_t q = 0; q < num_lookups; q++)
+        checksum -= nameTable_find(&names, csv->cities[lookups[q]].name);
+    double hash_us = (nowNs() - begin) / 1e3 / num_lookups;
+
+    printf("nodes,edges,dimacs_ms,csv_ms,getcity_us,hashed_us,mismatches\n");
+    printf("%u,%u,%.1f,%.1f,%.2f,%.3f,%u\n", graph->num_nodes, graph->num_edges, dimacs_ms, csv_ms, scan_us, hash_us, mismatches + (checksum != 0));
+
+    for(int f = 0; f < 4; f++)
+        unlink(paths[f]);
+    free(lookups);
+    nameTable_free(&names);
+    graph_free(dimacs);
+    graph_free(csv);
+    graph_free(graph);
+    return 0;
+}
+
+/// @brief computes a many to many distance table on a grid with a contraction
+///        hierarchy and checks a sample of it against single AStar queries,
+///        then compares one to all Dijkstra against PHAST
+/// @return the process exit code
+int benchDistanceTable()
+{
+    const uint32_t side = 200, num_sources = 1000, num_targets = 1000, num_samples = 1000, num_rows = 20;
+    Graph* graph = generateGridGraph(side, side, 0xcbbb9d5du);
+    SearchContext* ctx = searchContext_create(graph);
+    uint32_t* sources = (uint32_t*)malloc(num_sources * sizeof(uint32_t));
+    uint32_t* targets = (uint32_t*)malloc(num_targets * sizeof(uint32_t));
+    uint32_t* table = (uint32_t*)malloc((size_t)num_sources * num_targets * sizeof(uint32_t));
+    uint32_t* dijkstra = (uint32_t*)malloc(graph->num_nodes * sizeof(uint32_t));
+    uint32_t* phast = (uint32_t*)malloc(graph->num_nodes * sizeof(uint32_t));
+    if(!sources || !targets || !table || !dijkstra || !phast)
+    {
+        perror("unable to malloc distance table benchmark data");
+        exit(0);
+    }
+    uint32_t seed = 0x629a292au;
+    for(uint32_t s = 0; s < num_sources; s++)
+        sources[s] = xorshift32(&seed) % graph->num_nodes;
+    for(uint32_t t = 0; t < num_targets; t++)
+        targets[t] = xorshift32(&seed) % graph->num_nodes;
+
+    uint64_t begin = nowNs();
+    graph->ch = contractionHierarchy_build(graph);
+    double build_ms = (nowNs() - begin) / 1e6;
+
+    begin = nowNs();
+    distanceTable_manyToMany(graph, ctx, sources, num_sources, targets, num_targets, table);
+    double table_ms = (nowNs() - begin) / 1e6;
+
+    // AStar does not use the hierarchy, time a sample of it and scale up
+    uint32_t mismatches = 0;
+    ContractionHierarchy* ch = graph->ch;
+    graph->ch = NULL;
+    begin = nowNs();
+    for(uint32_t q = 0; q < num_samples; q++)
+    {
+        uint32_t s = xorshift32(&seed) % num_sources, t = xorshift32(&seed) % num_targets;
+        free(AStar(graph, ctx, sources[s], targets[t]));
+        if(ctx->g_scores[targets[t]] != table[(size_t)s * num_targets + t])mismatches++;
+    }
+    double astar_ms = (nowNs() - begin) / 1e6 * ((double)num_sources * num_targets / num_samples);
+
+    double dijkstra_ms = 0, phast_ms = 0;
+    for(uint32_t r = 0; r < num_rows; r++)
+    {
+        graph->ch = NULL;
+        begin = nowNs();
+        distanceTable_oneToAll(graph, ctx, sources[r], dijkstra);
+        dijkstra_ms += (nowNs() - begin) / 1e6 / num_rows;
+        graph->ch = ch;
+        begin = nowNs();
+        distanceTable_oneToAll(graph, ctx, sources[r], phast);
+        phast_ms += (nowNs() - begin) / 1e6 / num_rows;
+        mismatches += memcmp(dijkstra, phast, graph->num_nodes * sizeof(uint32_t)) != 0;
+    }
+
+    printf("nodes,sources,targets,ch_build_ms,table_ms,astar_estimate_ms,speedup,dijkstra_row_ms,phast_row_ms,mismatches\n");
+    printf("%u,%u,%u,%.0f,%.1f,%.0f,%.0f,%.2f,%.2f,%u\n", graph->num_nodes, num_sources, num_targets, build_ms, table_ms,
+        astar_ms, astar_ms / table_ms, dijkstra_ms, phast_ms, mismatches);
+
+    free(sources);
+    free(targets);
+    free(table);
+    free(dijkstra);
+    free(phast);
+    searchContext_free(ctx);
+    graph_free(graph);
+    return 0;
+}
+
+/// @brief compares the parallel breadth first search with and without bottom
+///        up levels against a plain queue based traversal, on a scale free
+///        graph where bottom up levels pay off and a grid where they do not
+/// @return the process exit code
+int benchParallelBfs()
+{
+    const uint32_t num_nodes = 1000000, runs = 3;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("graph,nodes,edges,workers,sequential_ms,top_down_ms,direction_optimizing_ms,levels,reached,mismatches\n");
+    for(int kind = 0; kind < 2; kind++)
+    {
+        Graph* graph = kind == 0 ? generateScaleFreeGraph(num_nodes, 8, 0x5be0cd19u) : generateGridGraph(1000, 1000, 0x5be0cd19u);
+        uint32_t source = graph->num_nodes / 3;
+
+        // the reference hop counts from a single threaded traversal
+        uint32_t* expected = (uint32_t*)malloc(graph->num_nodes * sizeof(uint32_t));
+        if(expected == NULL)
+        {
+            perror("unable to malloc breadth first benchmark data");
+            exit(0);
+        }
+        IdQueue queue = {0};
+        double sequential_ms = 1e30;
+        for(uint32_t r = 0; r < runs; r++)
+        {
+            uint64_t begin = nowNs();
+            for(uint32_t v = 0; v < graph->num_nodes; v++)
+                expected[v] = PARALLEL_BFS_UNREACHED;
+            expected[source] = 0;
+            idQueue_push(&queue, source);
+            uint32_t current = 0;
+            while(idQueue_pop(&queue, &current))
+            {
+                for(uint32_t i = graph->offsets[current]; i < graph->offsets[current + 1]; i++)
+                {
+                    if(expected[graph->targets[i]] != PARALLEL_BFS_UNREACHED)continue;
+                    expected[graph->targets[i]] = expected[current] + 1;
+                    idQueue_push(&queue, graph->targets[i]);
+                }
+            }
+            double ms = (nowNs() - begin) / 1e6;
+            if(ms < sequential_ms)sequential_ms = ms;
+        }
+        idQueue_free(&queue);
+
+        for(uint32_t workers = 1; workers <= (cores > 0 ? (uint32_t)cores : 1); workers *= 2)
+        {
+            ParallelBfs* bfs = parallelBfs_create(graph, workers);
+            double best_ms[2] = {1e30, 1e30};
+            uint32_t reached = 0, mismatches = 0, levels = 0;
+            for(int optimizing = 0; optimizing < 2; optimizing++)
+            {
+                for(uint32_t r = 0; r < runs; r++)
+                {
+                    uint64_t begin = nowNs();
+                    reached = parallelBfs_run(bfs, source, optimizing);
+                    double ms = (nowNs() - begin) / 1e6;
+                    if(ms < best_ms[optimizing])best_ms[optimizing] = ms;
+                }
+                // the hop counts have to match and every parent has to be one hop closer
+                for(uint32_t v = 0; v < graph->num_nodes; v++)
+                {
+                    uint32_t parent = atomic_load(&bfs->parents[v]);
+                    if(bfs->levels[v] != expected[v])mismatches++;
+                    else if(v != source && bfs->levels[v] != PARALLEL_BFS_UNREACHED && bfs->levels[parent] + 1 != bfs->levels[v])mismatches++;
+                }
+                levels = bfs->level - 1;
+            }
+            printf("%s,%u,%u,%u,%.1f,%.1f,%.1f,%u,%u,%u\n", kind == 0 ? "scalefree" : "grid", graph->num_nodes, graph->num_edges,
+                workers, sequential_ms, best_ms[0], best_ms[1], levels, reached, mismatches);
+            parallelBfs_free(bfs);
+        }
+        free(expected);
+        graph_free(graph);
+    }
+    return 0;
+}
+
+/// @brief compares delta stepping at a few bucket widths against a single
+///        threaded Dijkstra on a grid and a geometric graph, the distances
+///        have to match exactly and every parent has to lie on a shortest path
+/// @return the process exit code
+int benchDeltaStepping()
+{
+    const uint32_t runs = 3;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("graph,nodes,edges,workers,delta,dijkstra_ms,delta_stepping_ms,reached,mismatches\n");
+    for(int kind = 0; kind < 2; kind++)
+    {
+        Graph* graph = kind == 0 ? generateGridGraph(1000, 1000, 0x510e527fu) : generateGeometricGraph(1000000, 8, 0x510e527fu);
+        uint32_t source = graph->num_nodes / 3;
+        uint32_t* expected = (uint32_t*)malloc(graph->num_nodes * sizeof(uint32_t));
+        uint32_t* dist = (uint32_t*)malloc(graph->num_nodes * sizeof(uint32_t));
+        uint32_t* parents = (uint32_t*)malloc(graph->num_nodes * sizeof(uint32_t));
+        if(!expected || !dist || !parents)
+        {
+            perror("unable to malloc delta stepping benchmark data");
+            exit(0);
+        }
+
+        // the reference distances from a single threaded Dijkstra
+        IHeap heap = {0};
+        double dijkstra_ms = 1e30;
+        for(uint32_t r = 0; r < runs; r++)
+        {
+            uint64_t begin = nowNs();
+            landmarks_dijkstra(graph->num_nodes, graph->offsets, graph->targets, graph->weights, source, expected, &heap);
+            double ms = (nowNs() - begin) / 1e6;
+            if(ms < dijkstra_ms)dijkstra_ms = ms;
+        }
+        iheap_free(&heap);
+
+        uint64_t total = 0;
+        for(uint32_t i = 0; i < graph->num_edges; i++)
+            total += graph->weights[i];
+        uint32_t mean = graph->num_edges ? (uint32_t)(total / graph->num_edges) : 1;
+        const uint32_t deltas[] = {mean / 4 ? mean / 4 : 1, mean, mean * 4};
+
+        for(uint32_t workers = 1; workers <= (cores > 0 ? (uint32_t)cores : 1); workers *= 2)
+        {
+            for(uint32_t d = 0; d < sizeof(deltas) / sizeof(deltas[0]); d++)
+            {
+                DeltaStepping* ds = deltaStepping_create(graph, workers, deltas[d]);
+                double best_ms = 1e30;
+                for(uint32_t r = 0; r < runs; r++)
+                {
+                    uint64_t begin = nowNs();
+                    deltaStepping_run(ds, source, dist, parents);
+                    double ms = (nowNs() - begin) / 1e6;
+                    if(ms < best_ms)best_ms = ms;
+                }
+                uint32_t reached = 0, mismatches = 0;
+                for(uint32_t v = 0; v < graph->num_nodes; v++)
+                {
+                    if(dist[v] != expected[v])
+                    {
+                        mismatches++;
+                        continue;
+                    }
+                    if(dist[v] == DISTANCE_UNREACHABLE)continue;
+                    reached++;
+                    if(v == source)continue;
+                    bool tight = false;
+                    for(uint32_t i = graph->offsets[parents[v]]; i < graph->offsets[parents[v] + 1]; i++)
+                        tight |= graph->targets[i] == v && expected[parents[v]] + graph->weights[i] == dist[v];
+                    mismatches += !tight;
+                }
+                printf("%s,%u,%u,%u,%u,%.1f,%.1f,%u,%u\n", kind == 0 ? "grid" : "geometric", graph->num_nodes, graph->num_edges,
+                    workers, deltas[d], dijkstra_ms, best_ms, reached, mismatches);
+                deltaStepping_free(ds);
+            }
+        }
+        free(expected);
+        free(dist);
+        free(parents);
+        graph_free(graph);
+    }
+    return 0;
+}
+
+/// @brief compares reading paths as a list of cities, counted with
+///        nullTermArrLen and costed with costCalc, against path_read into
+///        buffers the caller owns, for many short A* queries on a grid
+/// @return the process exit code
+int benchPathOutput()
+{
+    const uint32_t side = 300, num_queries = 20000, reach = 12;
+    Graph* graph = generateGridGraph(side, side, 0x243f6a88u);
+    graph->landmarks = landmarks_build(graph, 8);
+    SearchContext* ctx = searchContext_create(graph);
+    uint32_t* starts = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint32_t* ends = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    if(!starts || !ends)
+    {
+        perror("unable to malloc path benchmark data");
+        exit(0);
+    }
+
+    // short trips, the end is at most reach cities away in each direction
+    uint32_t seed = 0x85a308d3u;
+    for(uint32_t q = 0; q < num_queries; q++)
+    {
+        uint32_t x = xorshift32(&seed) % (side - reach), y = xorshift32(&seed) % (side - reach);
+        starts[q] = y * side + x;
+        ends[q] = (y + xorshift32(&seed) % reach) * side + x + xorshift32(&seed) % reach;
+    }
+
+    uint32_t nodes[256], costs[256];
+    uint64_t checksum[2] = {0}, search_ns[2] = {0}, output_ns[2] = {0}, allocs[2] = {0};
+    for(uint32_t q = 0; q < num_queries; q++)
+    {
+        // the two ways take turns going first so neither always finds the cache warm
+        for(uint32_t turn = 0; turn < 2; turn++)
+        {
+            uint32_t way = (q + turn) % 2, len = 0, cost = 0;
+            uint64_t begin_allocs = allocationCount(), begin = nowNs();
+            bool found = AStar_run(graph, ctx, starts[q], ends[q]);
+            uint64_t searched = nowNs();
+            if(way == 0)
+            {
+                // a list of cities, its length and the costs looked up again
+                City** list = found ? walkBack(graph, ctx, starts[q], ends[q]) : NULL;
+                len = list ? nullTermArrLen((void**)list) : 0;
+                for(uint32_t i = 0; i + 1 < len; i++)
+                    cost += costCalc(graph, graph_cityId(graph, list[i]), graph_cityId(graph, list[i + 1]));
+                free(list);
+            }
+            else
+            {
+                // the ids and costs the search recorded read into buffers on the stack
+                Path path = path_init(nodes, costs, 256);
+                if(found)
+                    path_read(ctx, starts[q], ends[q], &path);
+                len = path.len;
+                cost = path.cost;
+                path_free(&path);
+            }
+            output_ns[way] += nowNs() - searched;
+            search_ns[way] += searched - begin;
+            allocs[way] += allocationCount() - begin_allocs;
+            checksum[way] += (uint64_t)len << 32 | cost;
+        }
+    }
+
+    printf("output,queries,search_ns,output_ns,allocations_per_query,checksum\n");
+    printf("city_list,%u,%.0f,%.0f,%.2f,%llu\n", num_queries, (double)search_ns[0] / num_queries, (double)output_ns[0] / num_queries,
+        (double)allocs[0] / num_queries, (unsigned long long)checksum[0]);
+    printf("path_read,%u,%.0f,%.0f,%.2f,%llu\n", num_queries, (double)search_ns[1] / num_queries, (double)output_ns[1] / num_queries,
+        (double)allocs[1] / num_queries, (unsigned long long)checksum[1]);
+
+    free(starts);
+    free(ends);
+    searchContext_free(ctx);
+    graph_free(graph);
+    return 0;
+}
+
+// a search algorithm the benchmark harness can be asked for by name
+typedef struct bench_algo{
+    const char* name;
+    Algo* func;
+} BenchAlgo;
+
+/// @brief orders latencies for qsort
+static int compareU64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/// @brief the number of nodes the last query reached in either direction
+static uint32_t benchReached(const SearchContext* ctx)
+{
+    uint32_t reached = 0;
+    for(uint32_t v = 0; v < ctx->num_nodes; v++)
+    {
+        reached += ctx->stamps[v] == ctx->generation;
+        if(ctx->back_stamps)
+            reached += ctx->back_stamps[v] == ctx->generation;
+    }
+    return reached;
+}
+
+/// @brief runs the search algorithms over random queries on a generated graph
+///        and prints one CSV row per algorithm, usage:
+///        bench <grid|geometric|scalefree> [nodes] [queries] [seed] [algorithms]
+///        where algorithms is a comma separated list of bfs, dfs, astar,
+///        bibfs, biastar and ch, all but ch by default since contracting the
+///        hubs of a large scale free graph takes minutes. Latencies are per query in microseconds,
+///        reached counts the nodes a query stamped, allocs counts allocator
+///        calls per query and peak_rss_kb is the high water mark of the process
+/// @param argc the number of arguments after "bench"
+/// @param argv the arguments after "bench"
+/// @return the process exit code
+int benchSearches(int argc, char* argv[])
+{
+    static const BenchAlgo algos[] = {
+        {"bfs", breadthFirst},
+        {"dfs", depthFirst},
+        {"astar", AStar},
+        {"bibfs", bidirectionalBreadthFirst},
+        {"biastar", bidirectionalAStar},
+        {"ch", contractionHierarchySearch},
+    };
+    const uint32_t num_algos = sizeof(algos) / sizeof(algos[0]);
+    if(argc < 1)
+    {
+        printf("usage: bench <grid|geometric|scalefree> [nodes] [queries] [seed] [algorithms]\n");
+        return 1;
+    }
+    const char* kind = argv[0];
+    uint32_t num_nodes = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 100000;
+    uint32_t num_queries = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 1000;
+    uint32_t seed = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : 1;
+    const char* selected = argc > 4 ? argv[4] : "bfs,dfs,astar,bibfs,biastar";
+    if(num_nodes == 0 || num_queries == 0 || seed == 0)
+    {
+        printf("nodes, queries and seed have to be positive\n");
+        return 1;
+    }
+
+    Graph* graph;
+    if(strcmp(kind, "grid") == 0)
+    {
+        uint32_t side = isqrtCeil(num_nodes);
+        graph = generateGridGraph(side, side, seed);
+    }
+    else if(strcmp(kind, "geometric") == 0)
+        graph = generateGeometricGraph(num_nodes, 6, seed);
+    else if(strcmp(kind, "scalefree") == 0)
+        graph = generateScaleFreeGraph(num_nodes, 3, seed);
+    else
+    {
+        printf("unknown graph kind %s\n", kind);
+        return 1;
+    }
+
+    SearchContext* ctx = searchContext_create(graph);
+    uint32_t* starts = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint32_t* ends = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint64_t* latencies = (uint64_t*)malloc(num_queries * sizeof(uint64_t));
+    if(!starts || !ends || !latencies)
+    {
+        perror("unable to malloc benchmark queries");
+        exit(0);
+    }
+    for(uint32_t q = 0; q < num_queries; q++)
+    {
+        starts[q] = xorshift32(&seed) % graph->num_nodes;
+        ends[q] = xorshift32(&seed) % graph->num_nodes;
+    }
+
+    printf("graph,nodes,edges,algorithm,queries,found,prep_ms,p50_us,p99_us,mean_us,reached,allocs,peak_rss_kb\n");
+    for(uint32_t a = 0; a < num_algos; a++)
+    {
+        // match whole names in the comma separated selection
+        size_t len = strlen(algos[a].name);
+        const char* at = selected;
+        while((at = strstr(at, algos[a].name)) != NULL)
+        {
+            if((at == selected || at[-1] == ',') && (at[len] == ',' || at[len] == '\0'))break;
+            at += len;
+        }
+        if(at == NULL)continue;
+
+        double prep_ms = 0;
+        if(algos[a].func == contractionHierarchySearch && graph->ch == NULL)
+        {
+            uint64_t begin = nowNs();
+            graph->ch = contractionHierarchy_build(graph);
+            prep_ms = (nowNs() - begin) / 1e6;
+        }
+
+        uint32_t found = 0;
+        uint64_t reached = 0, allocations = 0, total_ns = 0;
+        for(uint32_t q = 0; q < num_queries; q++)
+        {
+            uint64_t allocs_before = allocationCount();
+            uint64_t begin = nowNs();
+            City** path = algos[a].func(graph, ctx, starts[q], ends[q]);
+            latencies[q] = nowNs() - begin;
+            allocations += allocationCount() - allocs_before;
+            total_ns += latencies[q];
+            reached += benchReached(ctx);
+            found += path != NULL;
+            free(path);
+        }
+        qsort(latencies, num_queries, sizeof(uint64_t), compareU64);
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        printf("%s,%u,%u,%s,%u,%u,%.1f,%.2f,%.2f,%.2f,%.0f,%.2f,%ld\n", kind, graph->num_nodes, graph->num_edges,
+            algos[a].name, num_queries, found, prep_ms,
+            latencies[num_queries / 2] / 1e3, latencies[(uint64_t)num_queries * 99 / 100] / 1e3, total_ns / 1e3 / num_queries,
+            (double)reached / num_queries, (double)allocations / num_queries, usage.ru_maxrss);
+    }
+
+    free(starts);
+    free(ends);
+    free(latencies);
+    searchContext_free(ctx);
+    graph_free(graph);
+    return 0;
+}
+
+/// @brief times weighted and anytime A* against A* on a large grid, with the
+///        bound each search reported and how far its paths really were from the cheapest
+/// @return the process exit code
+int benchAnytime()
+{
+    const uint32_t side = 700, num_queries = 100;
+    Graph* graph = generateGridGraph(side, side, 0x6a09e667u);
+    graph->landmarks = landmarks_build(graph, 8);
+    SearchContext* ctx = searchContext_create(graph);
+    uint32_t* starts = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint32_t* ends = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint32_t* expected = (uint32_t*)malloc(num_queries * sizeof(uint32_t));
+    uint64_t* latencies = (uint64_t*)malloc(num_queries * sizeof(uint64_t));
+    if(!starts || !ends || !expected || !latencies)
+    {
+        perror("unable to malloc anytime benchmark data");
+        exit(0);
+    }
+    uint32_t seed = 0xbb67ae85u;
+    for(uint32_t q = 0; q < num_queries; q++)
+    {
+        starts[q] = xorshift32(&seed) % graph->num_nodes;
+        ends[q] = xorshift32(&seed) % graph->num_nodes;
+    }
+
+    const struct{ const char* name; Search* search; double weight; uint64_t budget_us; } runs[] = {
+        {"astar", AStar_run, 1, 0},
+        {"wastar", weightedAStar_run, 1.2, 0},
+        {"wastar", weightedAStar_run, 1.5, 0},
+        {"wastar", weightedAStar_run, 2, 0},
+        {"wastar", weightedAStar_run, 3, 0},
+        {"arastar", anytimeAStar_run, 3, 0},
+        {"arastar", anytimeAStar_run, 3, 20000},
+        {"arastar", anytimeAStar_run, 3, 5000},
+        {"arastar", anytimeAStar_run, 3, 1000},
+    };
+    printf("search,weight,budget_us,p50_us,p99_us,found,avg_first_us,avg_solutions,avg_expanded,avg_bound,max_bound,avg_ratio,max_ratio,violations\n");
+    for(uint32_t r = 0; r < sizeof(runs) / sizeof(runs[0]); r++)
+    {
+        ctx->anytime.weight = runs[r].weight;
+        ctx->anytime.initial_weight = runs[r].weight;
+        ctx->anytime.budget_ns = runs[r].budget_us * 1000;
+        uint64_t first_ns = 0, solutions = 0, expanded = 0;
+        double bound_sum = 0, bound_max = 0, ratio_sum = 0, ratio_max = 0;
+        uint32_t found = 0, violations = 0;
+        for(uint32_t q = 0; q < num_queries; q++)
+        {
+            uint64_t begin = nowNs();
+            bool reached = runs[r].search(graph, ctx, starts[q], ends[q]);
+            latencies[q] = nowNs() - begin;
+            if(r == 0)
+            {
+                expected[q] = reached ? ctx->g_scores[ends[q]] : UINT32_MAX;
+                continue;
+            }
+            first_ns += ctx->anytime.first_ns;
+            solutions += ctx->anytime.solutions;
+            expanded += ctx->anytime.expanded;
+            if(!reached)continue;
+
+            // a path found without a bound counts as a violation of it
+            double ratio = expected[q] ? (double)ctx->g_scores[ends[q]] / expected[q] : 1;
+            found++;
+            bound_sum += ctx->anytime.bound;
+            ratio_sum += ratio;
+            if(ctx->anytime.bound > bound_max)bound_max = ctx->anytime.bound;
+            if(ratio > ratio_max)ratio_max = ratio;
+            violations += ratio > ctx->anytime.bound * (1 + 1e-9);
+        }
+        qsort(latencies, num_queries, sizeof(uint64_t), compareU64);
+        double p50_us = latencies[num_queries / 2] / 1e3, p99_us = latencies[(uint64_t)num_queries * 99 / 100] / 1e3;
+        if(r == 0)
+        {
+            printf("astar,1,0,%.1f,%.1f,%u,-,-,-,1,1,1,1,0\n", p50_us, p99_us, num_queries);
+            continue;
+        }
+        printf("%s,%.1f,%llu,%.1f,%.1f,%u,%.1f,%.2f,%.0f,%.3f,%.3f,%.4f,%.4f,%u\n", runs[r].name, runs[r].weight,
+            (unsigned long long)runs[r].budget_us, p50_us, p99_us, found, first_ns / 1e3 / num_queries,
+            (double)solutions / num_queries, (double)expanded / num_queries, found ? bound_sum / found : 0, bound_max,
+            found ? ratio_sum / found : 0, ratio_max, violations);
+    }
+    ctx->anytime = (AnytimeSearch){0};
+
+    free(starts);
+    free(ends);
+    free(expected);
+    free(latencies);
+    searchContext_free(ctx);
+    graph_free(graph);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc > 1 && strcmp(argv[1], "bench-pqueue") == 0)
+        return benchPQueue();
+    if(argc > 1 && strcmp(argv[1], "bench-batch") == 0)
+        return benchBatch();
+    if(argc > 1 && strcmp(argv[1], "bench-containers") == 0)
+        return benchContainers();
+    if(argc > 1 && strcmp(argv[1], "bench-ch") == 0)
+        return benchContractionHierarchy();
+    if(argc > 1 && strcmp(argv[1], "bench-alt") == 0)
+        return benchLandmarks();
+    if(argc > 1 && strcmp(argv[1], "bench-load") == 0)
+        return benchGraphFile();
+    if(argc > 1 && strcmp(argv[1], "bench-import") == 0)
+        return benchImport();
+    if(argc > 1 && strcmp(argv[1], "bench-table") == 0)
+        return benchDistanceTable();
+    if(argc > 1 && strcmp(argv[1], "bench-pbfs") == 0)
+        return benchParallelBfs();
+    if(argc > 1 && strcmp(argv[1], "bench-delta") == 0)
+        return benchDeltaStepping();
+    if(argc > 1 && strcmp(argv[1], "bench-replan") == 0)
+        return benchReplanner();
+    if(argc > 1 && strcmp(argv[1], "bench-cache") == 0)
+        return benchRouteCache();
+    if(argc > 1 && strcmp(argv[1], "bench-relax") == 0)
+        return benchRelaxFilter();
+    if(argc > 1 && strcmp(argv[1], "bench-path") == 0)
+        return benchPathOutput();
+    if(argc > 1 && strcmp(argv[1], "bench-snap") == 0)
+        return benchSpatialIndex();
+    if(argc > 1 && strcmp(argv[1], "bench-reorder") == 0)
+        return benchReorder();
+#ifdef __linux__
+    if(argc > 1 && strcmp(argv[1], "bench-serve") == 0)
+        return benchQueryServer();
+#endif
+    if(argc > 1 && strcmp(argv[1], "bench-bounded") == 0)
+        return benchBoundedSearch();
+    if(argc > 1 && strcmp(argv[1], "bench-anytime") == 0)
+        return benchAnytime();
+    if(argc > 1 && strcmp(argv[1], "bench") == 0)
+        return benchSearches(argc - 2, argv + 2);
+
+    printf("usage: %s <benchmark> [arguments]\n", argc > 0 ? argv[0] : "searches_bench");
+    return 1;
+}
@@ -0,0 +1,289 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <float.h>
+#include "anytime_search.h"
+#include "containers.h"
+#include "graph.h"
+#include "search_context.h"
+#include "util.h"
+#include "search.h"
+
+// Searches that give up the guarantee of the cheapest path for latency.
+// weightedAStar orders its heap by the cost plus the estimate inflated by a
+// weight w, which expands far fewer cities and still finds a path costing at
+// most w times the cheapest one. anytimeAStar works in the manner of ARA*, it
+// finds a first path with a large weight and then lowers the weight round by
+// round, every round carries on from the costs the rounds before found and
+// only expands the cities whose cost improved, until the path is the cheapest
+// or ctx->anytime.budget_ns runs out. A city that gets cheaper after it was
+// expanded in a round waits in ctx->stack for the next round instead of being
+// expanded again, and the back stamps of the context remember which round
+// expanded a city. Both leave the best path they found in the context with
+// ctx->anytime.bound set to how far from the cheapest it can be
+#define ANYTIME_DEFAULT_WEIGHT 1.5
+#define ANYTIME_DEFAULT_INITIAL 3.0
+#define ANYTIME_DEFAULT_STEP 0.5
+#define ANYTIME_CLOCK_INTERVAL 64 // expansions between looks at the clock
+
+// the state of a weighted or anytime query
+typedef struct anytime_query{
+    const Graph* graph;
+    SearchContext* ctx;
+    uint32_t end;
+    double weight; // the inflation of the estimate in the current round
+    uint32_t round; // back_g_scores[v] == round when v was expanded in the current round
+    uint64_t begin; // nowNs() when the query started
+    uint64_t deadline; // nowNs() after which the query stops, UINT64_MAX for none
+} AnytimeQuery;
+
+/// @brief the heap key of a reached city, its cost plus its inflated estimate
+static inline uint32_t anytime_key(const AnytimeQuery* query, uint32_t node)
+{
+    uint64_t key = query->ctx->g_scores[node] + (uint64_t)(query->weight * heuristic(query->graph, node, query->end));
+    return key < UINT32_MAX ? (uint32_t)key : UINT32_MAX - 1;
+}
+
+/// @brief a function to check if a city was expanded in the current round
+static inline bool anytime_expanded(const AnytimeQuery* query, uint32_t node)
+{
+    return searchContext_visitedBack(query->ctx, node) && query->ctx->back_g_scores[node] == query->round;
+}
+
+/// @brief resets what the last query reported and pushes the start
+/// @param weight the inflation of the first round
+static AnytimeQuery anytime_begin(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end, double weight)
+{
+    uint64_t begin = nowNs();
+    searchContext_begin(ctx);
+    searchContext_enableBackward(ctx);
+    idStack_clear(&ctx->stack);
+    ctx->anytime.bound = DBL_MAX;
+    ctx->anytime.lower_bound = 0;
+    ctx->anytime.solutions = 0;
+    ctx->anytime.first_ns = 0;
+    ctx->anytime.expanded = 0;
+    ctx->anytime.deadline_hit = false;
+
+    AnytimeQuery query = {graph, ctx, end, weight, 0, begin,
+        ctx->anytime.budget_ns ? begin + ctx->anytime.budget_ns : UINT64_MAX};
+    searchContext_visit(ctx, start, NO_PARENT, 0);
+    iheap_push(&ctx->heap, start, anytime_key(&query, start));
+    return query;
+}
+
+/// @brief one round, expands cities in key order until no key on the heap is
+///        below the cost of the end, the end itself is never expanded
+/// @return false if the deadline passed before the round was over
+static bool anytime_improve(AnytimeQuery* query)
+{
+    const Graph* graph = query->graph;
+    SearchContext* ctx = query->ctx;
+    IHeap* heap = &ctx->heap;
+    uint32_t current = 0, expanded = 0;
+
+    while(heap->size > 0)
+    {
+        uint32_t end_cost = searchContext_visited(ctx, query->end) ? ctx->g_scores[query->end] : UINT32_MAX;
+        if(heap->entries[0].score >= end_cost)break;
+        if(++expanded % ANYTIME_CLOCK_INTERVAL == 0 && nowNs() > query->deadline)
+        {
+            ctx->anytime.deadline_hit = true;
+            return false;
+        }
+
+        iheap_pop(heap, &current, NULL);
+        SEARCH_STAT(ctx, popped, 1);
+        ctx->anytime.expanded++;
+        searchContext_visitBack(ctx, current, NO_PARENT, query->round);
+        uint32_t currentCost = ctx->g_scores[current];
+        SEARCH_TRACE(ctx, SEARCH_TRACE_EXPAND, current, currentCost);
+
+        for(uint32_t i = graph->offsets[current]; i < graph->offsets[current + 1]; i++)
+        {
+            uint32_t connected = graph->targets[i];
+            SEARCH_STAT(ctx, relaxed, 1);
+            if(graph->weights[i] == CONNECTION_CLOSED)continue;
+            uint32_t new_cost = currentCost + graph->weights[i];
+            if(searchContext_visited(ctx, connected) && ctx->g_scores[connected] <= new_cost)continue;
+
+            searchContext_visit(ctx, connected, current, new_cost);
+            if(iheap_contains(heap, connected))
+            {
+                iheap_decreaseKey(heap, connected, anytime_key(query, connected));
+                SEARCH_STAT(ctx, decrease_keys, 1);
+            }
+            // expanded this round already, it is picked up by the next one
+            else if(anytime_expanded(query, connected))
+                idStack_push(&ctx->stack, connected);
+            else
+            {
+                iheap_push(heap, connected, anytime_key(query, connected));
+                SEARCH_STAT(ctx, pushed, 1);
+                SEARCH_STAT_FRONTIER(ctx, heap->size);
+            }
+        }
+    }
+    return true;
+}
+
+/// @brief the lowest cost a path to the end can have, the first city of the
+///        cheapest path whose cost has not been passed on to the next city
+///        is on the heap or waiting for the next round, and the estimate
+///        never overstates the rest of the way
+static uint32_t anytime_lowerBound(const AnytimeQuery* query)
+{
+    const SearchContext* ctx = query->ctx;
+    uint64_t lowest = searchContext_visited(ctx, query->end) ? ctx->g_scores[query->end] : UINT32_MAX;
+    for(uint32_t i = 0; i < ctx->heap.size; i++)
+    {
+        uint32_t node = ctx->heap.entries[i].id;
+        uint64_t bound = (uint64_t)ctx->g_scores[node] + heuristic(query->graph, node, query->end);
+        if(bound < lowest)lowest = bound;
+    }
+    for(uint32_t i = 0; i < ctx->stack.len; i++)
+    {
+        uint32_t node = ctx->stack.items[i];
+        uint64_t bound = (uint64_t)ctx->g_scores[node] + heuristic(query->graph, node, query->end);
+        if(bound < lowest)lowest = bound;
+    }
+    return (uint32_t)lowest;
+}
+
+/// @brief a city can get cheaper after the cities past it on the path were
+///        reached, so this recounts the costs along the path to the end
+static void anytime_writePath(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    IdStack* stack = &ctx->stack;
+    idStack_clear(stack);
+    for(uint32_t current = end; current != start; current = ctx->parents[current])
+        idStack_push(stack, current);
+
+    uint32_t previous = start, current = 0, cost = 0;
+    while(idStack_pop(stack, &current))
+    {
+        // the cheapest open connection between the two
+        uint32_t weight = CONNECTION_CLOSED;
+        for(uint32_t i = graph->offsets[previous]; i < graph->offsets[previous + 1]; i++)
+        {
+            if(graph->targets[i] == current && graph->weights[i] < weight)
+                weight = graph->weights[i];
+        }
+        cost += weight;
+        ctx->g_scores[current] = cost;
+        previous = current;
+    }
+}
+
+/// @brief leaves the path to the end in the context and reports its bound
+/// @param bound the bound the completed rounds guarantee, DBL_MAX for none
+/// @return false if the end was not reached
+static bool anytime_finish(AnytimeQuery* query, uint32_t start, double bound)
+{
+    SearchContext* ctx = query->ctx;
+    if(!searchContext_visited(ctx, query->end))return false;
+
+    uint32_t lower = anytime_lowerBound(query);
+    anytime_writePath(query->graph, ctx, start, query->end);
+    uint32_t cost = ctx->g_scores[query->end];
+    if(lower > cost)lower = cost;
+    ctx->anytime.lower_bound = lower;
+    if(cost == 0)
+        ctx->anytime.bound = 1;
+    else if(lower > 0 && (double)cost / lower < bound)
+        ctx->anytime.bound = (double)cost / lower;
+    else
+        ctx->anytime.bound = bound;
+    return true;
+}
+
+/// @brief weighted A*, A* with the estimate inflated by ctx->anytime.weight
+/// @param graph the graph to search
+/// @param ctx the search context to use, its anytime state holds the weight and budget
+/// @param start the id of the city to start at
+/// @param end the id of the city to find
+/// @return true if a path was found, it costs at most ctx->anytime.bound times the cheapest
+bool weightedAStar_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    double weight = ctx->anytime.weight ? ctx->anytime.weight : ANYTIME_DEFAULT_WEIGHT;
+    if(weight < 1)weight = 1;
+
+    AnytimeQuery query = anytime_begin(graph, ctx, start, end, weight);
+    bool finished = anytime_improve(&query);
+    if(searchContext_visited(ctx, end))
+    {
+        ctx->anytime.solutions = 1;
+        ctx->anytime.first_ns = nowNs() - query.begin;
+    }
+    return anytime_finish(&query, start, finished ? weight : DBL_MAX);
+}
+
+/// @brief weighted A* for the City** interface
+City** weightedAStar(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    return weightedAStar_run(graph, ctx, start, end) ? walkBack(graph, ctx, start, end) : NULL;
+}
+
+/// @brief anytime repairing A*, finds a path quickly and improves it until it is
+///        the cheapest or the budget in ctx->anytime.budget_ns runs out
+/// @param graph the graph to search
+/// @param ctx the search context to use, its anytime state holds the weights and budget
+/// @param start the id of the city to start at
+/// @param end the id of the city to find
+/// @return true if a path was found in time, it costs at most ctx->anytime.bound times the cheapest
+bool anytimeAStar_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    double weight = ctx->anytime.initial_weight ? ctx->anytime.initial_weight : ANYTIME_DEFAULT_INITIAL;
+    double step = ctx->anytime.weight_step > 0 ? ctx->anytime.weight_step : ANYTIME_DEFAULT_STEP;
+    if(weight < 1)weight = 1;
+
+    AnytimeQuery query = anytime_begin(graph, ctx, start, end, weight);
+    IHeap* heap = &ctx->heap;
+    double bound = DBL_MAX;
+    uint32_t best = UINT32_MAX;
+    while(true)
+    {
+        bool finished = anytime_improve(&query);
+        if(!searchContext_visited(ctx, end))break;
+        if(ctx->g_scores[end] < best)
+        {
+            best = ctx->g_scores[end];
+            if(ctx->anytime.solutions++ == 0)
+                ctx->anytime.first_ns = nowNs() - query.begin;
+        }
+        if(!finished)break;
+
+        // a finished round leaves a path within its weight of the cheapest
+        if(weight < bound)bound = weight;
+        if(weight <= 1 || best <= anytime_lowerBound(&query))break;
+        if(nowNs() > query.deadline)
+        {
+            ctx->anytime.deadline_hit = true;
+            break;
+        }
+
+        // the next round works on the cities that got cheaper after they were
+        // expanded as well as the heap, all keyed with the lower weight
+        weight = weight - step > 1 ? weight - step : 1;
+        query.weight = weight;
+        query.round++;
+        uint32_t node = 0;
+        while(idStack_pop(&ctx->stack, &node))
+        {
+            if(!iheap_contains(heap, node))
+                iheap_push(heap, node, 0);
+        }
+        for(uint32_t i = 0; i < heap->size; i++)
+            heap->entries[i].score = anytime_key(&query, heap->entries[i].id);
+        iheap_rebuild(heap);
+    }
+    return anytime_finish(&query, start, bound);
+}
+
+/// @brief anytime repairing A* for the City** interface
+City** anytimeAStar(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    return anytimeAStar_run(graph, ctx, start, end) ? walkBack(graph, ctx, start, end) : NULL;
+}
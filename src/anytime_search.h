@@ -0,0 +1,14 @@
+#ifndef ANYTIME_SEARCH_H
+#define ANYTIME_SEARCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "graph.h"
+#include "search_context.h"
+
+bool weightedAStar_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+City** weightedAStar(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+bool anytimeAStar_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+City** anytimeAStar(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+
+#endif
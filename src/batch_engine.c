@@ -0,0 +1,141 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "batch_engine.h"
+#include "graph.h"
+#include "search_context.h"
+#include "util.h"
+#include "thread_pool.h"
+#include "route_cache.h"
+
+// Answers many independent (start, end) queries over one shared read only
+// graph. Each worker owns a search context that is reused for every query it
+// runs. Jobs are split into one contiguous range per worker, a worker claims
+// small chunks from the front of its own range and once that is empty it
+// steals chunks from the ranges of the other workers, so a worker that drew
+// slow queries does not hold up the batch
+#define BATCH_CHUNK 16
+
+/// @brief creates a batch engine with its own worker threads
+/// @param graph the graph the queries will run over
+/// @param num_workers the number of workers, 0 uses one per online core
+/// @return a new batch engine, free it with batchEngine_free
+BatchEngine* batchEngine_create(const Graph* graph, uint32_t num_workers)
+{
+    BatchEngine* engine = (BatchEngine*)calloc(1, sizeof(BatchEngine));
+    if(engine == NULL)
+    {
+        perror("unable to calloc batch engine");
+        exit(0);
+    }
+    engine->graph = graph;
+    engine->pool = threadPool_create(num_workers);
+    engine->contexts = (SearchContext**)calloc(engine->pool->num_workers, sizeof(SearchContext*));
+    engine->ranges = (BatchRange*)aligned_alloc(64, engine->pool->num_workers * sizeof(BatchRange));
+    if(!engine->contexts || !engine->ranges)
+    {
+        perror("unable to allocate batch engine workers");
+        exit(0);
+    }
+    for(uint32_t i = 0; i < engine->pool->num_workers; i++)
+        engine->contexts[i] = searchContext_create(graph);
+    return engine;
+}
+
+/// @brief claims the next chunk of jobs from a range
+/// @return false if the range had nothing left
+static bool batchRange_claim(BatchRange* range, uint32_t* begin, uint32_t* end)
+{
+    uint32_t claimed = atomic_fetch_add(&range->next, BATCH_CHUNK);
+    if(claimed >= range->end)return false;
+    *begin = claimed;
+    *end = claimed + BATCH_CHUNK < range->end ? claimed + BATCH_CHUNK : range->end;
+    return true;
+}
+
+/// @brief runs one job and fills in its result
+static void batchEngine_runJob(BatchEngine* engine, SearchContext* ctx, uint32_t index)
+{
+    const RouteJob* job = &engine->jobs[index];
+    RouteResult* result = &engine->results[index];
+
+#ifdef SEARCH_STATS
+    // a search resets the counters as it begins, a cached answer runs none
+    ctx->stats = (SearchStats){0};
+#endif
+    uint64_t begin = nowNs();
+    if(engine->cache)
+    {
+        result->path = routeCache_search(engine->cache, ctx, job->algo, job->start, job->end, &result->cost);
+        result->elapsed_ns = nowNs() - begin;
+        result->length = result->path ? nullTermArrLen((void**)result->path) : 0;
+#ifdef SEARCH_STATS
+        result->expanded = ctx->stats.popped;
+#endif
+        return;
+    }
+    result->path = job->algo(engine->graph, ctx, job->start, job->end);
+    result->elapsed_ns = nowNs() - begin;
+#ifdef SEARCH_STATS
+    result->expanded = ctx->stats.popped;
+#endif
+
+    // every search records the cost it reached each city with
+    result->length = result->path ? nullTermArrLen((void**)result->path) : 0;
+    result->cost = result->path ? ctx->g_scores[job->end] : 0;
+}
+
+/// @brief the pool task, drains the workers own range then steals from the others
+static void batchEngine_worker(void* arg, uint32_t worker)
+{
+    BatchEngine* engine = (BatchEngine*)arg;
+    SearchContext* ctx = engine->contexts[worker];
+    uint32_t num_workers = engine->pool->num_workers;
+    uint32_t begin = 0, end = 0;
+
+    for(uint32_t offset = 0; offset < num_workers; offset++)
+    {
+        BatchRange* range = &engine->ranges[(worker + offset) % num_workers];
+        while(batchRange_claim(range, &begin, &end))
+        {
+            for(uint32_t i = begin; i < end; i++)
+                batchEngine_runJob(engine, ctx, i);
+        }
+    }
+}
+
+/// @brief runs a batch of queries across the workers of the engine
+/// @param engine the engine to run on
+/// @param jobs the queries to run
+/// @param results filled with one result per job in the same order as the jobs
+/// @param count the number of jobs
+void batchEngine_run(BatchEngine* engine, const RouteJob* jobs, RouteResult* results, uint32_t count)
+{
+    uint32_t num_workers = engine->pool->num_workers;
+    for(uint32_t i = 0; i < num_workers; i++)
+    {
+        atomic_store(&engine->ranges[i].next, (uint32_t)((uint64_t)count * i / num_workers));
+        engine->ranges[i].end = (uint32_t)((uint64_t)count * (i + 1) / num_workers);
+    }
+    engine->jobs = jobs;
+    engine->results = results;
+    graph_acquire(engine->graph);
+    threadPool_run(engine->pool, batchEngine_worker, engine);
+    graph_release(engine->graph);
+    engine->jobs = NULL;
+    engine->results = NULL;
+}
+
+/// @brief stops the workers and releases the engine, the graph is not freed
+void batchEngine_free(BatchEngine* engine)
+{
+    for(uint32_t i = 0; i < engine->pool->num_workers; i++)
+        searchContext_free(engine->contexts[i]);
+    threadPool_free(engine->pool);
+    free(engine->contexts);
+    free(engine->ranges);
+    free(engine);
+}
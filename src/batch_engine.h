@@ -0,0 +1,51 @@
+#ifndef BATCH_ENGINE_H
+#define BATCH_ENGINE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "graph.h"
+#include "search_context.h"
+#include "search.h"
+#include "thread_pool.h"
+#include "route_cache.h"
+
+// a single query for the batch engine
+typedef struct route_job{
+    uint32_t start; // the id of the city to start at
+    uint32_t end; // the id of the city to end at
+    Algo* algo; // the search to run
+} RouteJob;
+
+// the answer to a single query, in the same position as its job
+typedef struct route_result{
+    City** path; // the path found or NULL, owned by the caller
+    uint32_t length; // the number of cities in the path
+    uint32_t cost; // the total cost of the path
+    uint64_t elapsed_ns; // how long the search took
+#ifdef SEARCH_STATS
+    uint64_t expanded; // the cities the search took off its frontier, 0 when the cache answered
+#endif
+} RouteResult;
+
+// a range of jobs owned by one worker, padded so workers do not share a cache line
+typedef struct batch_range{
+    _Atomic uint32_t next; // the next unclaimed job in the range
+    uint32_t end; // one past the last job in the range
+    char padding[56];
+} BatchRange;
+
+typedef struct batch_engine{
+    const Graph* graph; // the shared graph
+    ThreadPool* pool; // the workers running the queries
+    SearchContext** contexts; // one reusable search context per worker
+    BatchRange* ranges; // one job range per worker
+    const RouteJob* jobs; // the jobs of the running batch
+    RouteResult* results; // the results of the running batch
+    RouteCache* cache; // answers repeated queries when set, NULL by default
+} BatchEngine;
+
+BatchEngine* batchEngine_create(const Graph* graph, uint32_t num_workers);
+void batchEngine_run(BatchEngine* engine, const RouteJob* jobs, RouteResult* results, uint32_t count);
+void batchEngine_free(BatchEngine* engine);
+
+#endif
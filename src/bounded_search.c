@@ -0,0 +1,549 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "bounded_search.h"
+#include "graph.h"
+#include "search_context.h"
+#include "search.h"
+
+#define BOUNDED_INFINITE UINT32_MAX
+#define BOUNDED_REEXPANSIONS 64 // memoryBoundedAStar gives up after this many expansions per pool node
+
+/// @brief resets what the last bounded query used
+/// @return the memory ceiling of this query in bytes
+static size_t bounded_begin(SearchContext* ctx)
+{
+    ctx->bounded.peak_bytes = 0;
+    ctx->bounded.expanded = 0;
+    ctx->bounded.best = NO_PARENT;
+    ctx->bounded.limit_hit = false;
+    return ctx->bounded.memory_limit ? ctx->bounded.memory_limit : BOUNDED_DEFAULT_LIMIT;
+}
+
+// a city on the path idaStar is following and the next connection to try from it
+typedef struct ida_frame{
+    uint32_t node;
+    uint32_t next; // the index of the next connection to try
+    uint32_t g; // the cost of the path to the city
+} IdaFrame;
+
+/// @brief iterative deepening A*, depth first searches that only follow paths
+///        whose cost plus estimate is within a limit, the limit of each round
+///        is the lowest one that was over the limit of the round before.
+///        Every round walks again all the paths of the rounds before it, on
+///        the queries of bench-bounded (grid cities at most 25 apart) that
+///        made it about 6.9 ms a query against 48 us for AStar_run, so it only
+///        suits tiny ceilings on short queries
+/// @param graph the graph to search
+/// @param ctx the search context to use, its bounded state holds the ceiling
+/// @param start the id of the city to start at
+/// @param end the id of the city to find
+/// @return true if a path was found, read it with path_read
+bool idaStar_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    size_t limit = bounded_begin(ctx);
+    searchContext_begin(ctx);
+
+    // the path being followed and a copy of the best one with its costs
+    const size_t per_city = sizeof(IdaFrame) + 2 * sizeof(uint32_t);
+    uint32_t max_depth = (uint32_t)(limit / per_city < UINT32_MAX ? limit / per_city : UINT32_MAX);
+    if(max_depth == 0)
+    {
+        ctx->bounded.limit_hit = true;
+        return false;
+    }
+    IdaFrame* frames = (IdaFrame*)malloc((max_depth < 64 ? max_depth : 64) * sizeof(IdaFrame));
+    uint32_t* best_path = (uint32_t*)malloc((max_depth < 64 ? max_depth : 64) * 2 * sizeof(uint32_t));
+    uint32_t capacity = max_depth < 64 ? max_depth : 64, best_len = 0, best_h = BOUNDED_INFINITE, peak_depth = 1;
+    if(frames == NULL || best_path == NULL)
+    {
+        perror("unable to malloc IDA* path");
+        exit(0);
+    }
+
+    bool found = false;
+    uint32_t threshold = heuristic(graph, start, end);
+    while(!found)
+    {
+        // the cities of the path are stamped while they are on it, so the
+        // stamps are taken back off on the way up
+        uint32_t depth = 0, over = BOUNDED_INFINITE;
+        frames[depth++] = (IdaFrame){start, graph->offsets[start], 0};
+        searchContext_visit(ctx, start, NO_PARENT, 0);
+        if(start == end)
+        {
+            found = true;
+            break;
+        }
+        while(depth > 0 && !found)
+        {
+            IdaFrame* top = &frames[depth - 1];
+            if(top->next == graph->offsets[top->node + 1])
+            {
+                ctx->stamps[top->node] = ctx->generation - 1;
+                depth--;
+                continue;
+            }
+            uint32_t i = top->next++;
+            uint32_t connected = graph->targets[i];
+            if(graph->weights[i] == CONNECTION_CLOSED || searchContext_visited(ctx, connected))continue;
+
+            uint32_t g = top->g + graph->weights[i], h = heuristic(graph, connected, end);
+            if(g + h > threshold)
+            {
+                if(g + h < over)over = g + h;
+                continue;
+            }
+            if(depth == max_depth)
+            {
+                ctx->bounded.limit_hit = true;
+                continue;
+            }
+            if(depth == capacity)
+            {
+                capacity = capacity * 2 < max_depth ? capacity * 2 : max_depth;
+                frames = (IdaFrame*)realloc(frames, capacity * sizeof(IdaFrame));
+                best_path = (uint32_t*)realloc(best_path, capacity * 2 * sizeof(uint32_t));
+                if(frames == NULL || best_path == NULL)
+                {
+                    perror("unable to realloc IDA* path");
+                    exit(0);
+                }
+                top = &frames[depth - 1];
+            }
+            ctx->bounded.expanded++;
+            searchContext_visit(ctx, connected, top->node, g);
+            frames[depth++] = (IdaFrame){connected, graph->offsets[connected], g};
+            if(depth > peak_depth)peak_depth = depth;
+            if(connected == end)
+                found = true;
+            else if(h < best_h)
+            {
+                best_h = h;
+                best_len = depth;
+                for(uint32_t d = 0; d < depth; d++)
+                {
+                    best_path[2 * d] = frames[d].node;
+                    best_path[2 * d + 1] = frames[d].g;
+                }
+            }
+        }
+        // a round that was cut short by the ceiling gives up instead of raising
+        // the limit, the rounds only get longer and the cut path stays out of reach
+        if(found || over == BOUNDED_INFINITE || ctx->bounded.limit_hit)break;
+        threshold = over;
+    }
+
+    ctx->bounded.peak_bytes = (size_t)peak_depth * per_city;
+    if(!found && best_len > 0)
+    {
+        // the path to the city that got closest replaces whatever the stamps say
+        searchContext_begin(ctx);
+        for(uint32_t d = 0; d < best_len; d++)
+            searchContext_visit(ctx, best_path[2 * d], d ? best_path[2 * d - 2] : NO_PARENT, best_path[2 * d + 1]);
+        ctx->bounded.best = best_path[2 * best_len - 2];
+    }
+    else
+        ctx->bounded.best = found ? end : start;
+    free(frames);
+    free(best_path);
+    return found;
+}
+
+/// @brief iterative deepening A* for the City** interface
+City** idaStar(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    return idaStar_run(graph, ctx, start, end) ? walkBack(graph, ctx, start, end) : NULL;
+}
+
+// a search node of memoryBoundedAStar, one city reached by one path
+typedef struct bounded_node{
+    uint32_t city;
+    uint32_t parent; // the pool index of the node it was reached from, NO_PARENT for the start
+    uint32_t g; // the cost of its path
+    uint32_t estimate; // g plus the heuristic, never below the estimate of its parent
+    uint32_t f; // its place on the frontier, the estimate or the lowest estimate it forgot when higher
+    uint32_t forgotten; // the lowest f of the children it forgot, BOUNDED_INFINITE when none
+    uint32_t children; // the nodes in the pool reached from it
+    uint32_t version; // changed with f and on reuse of the slot, older heap entries are skipped
+    bool open; // waiting on the frontier to be expanded
+} BoundedNode;
+
+// a lazy heap entry, only counts while the node still has this version and f
+typedef struct bounded_entry{
+    uint32_t f;
+    uint32_t node;
+    uint32_t version;
+} BoundedEntry;
+
+// a binary heap of entries, the lowest f on top or the highest when max is set
+typedef struct bounded_heap{
+    BoundedEntry* entries;
+    uint32_t len, capacity;
+    bool max;
+} BoundedHeap;
+
+// the node pool of memoryBoundedAStar with a table from city to node
+typedef struct bounded_pool{
+    BoundedNode* nodes;
+    uint32_t capacity, used, free_list; // free slots are chained through their parent
+    uint32_t* table; // open addressing by city, NO_PARENT marks an empty slot
+    uint32_t table_mask;
+    BoundedHeap frontier; // open nodes by lowest f
+    BoundedHeap leaves; // nodes without children by highest f, the ones that can be forgotten
+} BoundedPool;
+
+/// @brief true when entry a belongs above entry b
+static inline bool boundedHeap_above(const BoundedHeap* heap, const BoundedEntry* a, const BoundedEntry* b)
+{
+    return heap->max ? a->f > b->f : a->f < b->f;
+}
+
+/// @brief adds an entry to a heap that has room for it
+static void boundedHeap_push(BoundedHeap* heap, BoundedEntry entry)
+{
+    uint32_t i = heap->len++;
+    while(i > 0 && boundedHeap_above(heap, &entry, &heap->entries[(i - 1) / 2]))
+    {
+        heap->entries[i] = heap->entries[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->entries[i] = entry;
+}
+
+/// @brief removes the top entry of a heap that is not empty
+static BoundedEntry boundedHeap_pop(BoundedHeap* heap)
+{
+    BoundedEntry top = heap->entries[0], last = heap->entries[--heap->len];
+    uint32_t i = 0;
+    while(true)
+    {
+        uint32_t child = 2 * i + 1;
+        if(child >= heap->len)break;
+        if(child + 1 < heap->len && boundedHeap_above(heap, &heap->entries[child + 1], &heap->entries[child]))child++;
+        if(!boundedHeap_above(heap, &heap->entries[child], &last))break;
+        heap->entries[i] = heap->entries[child];
+        i = child;
+    }
+    if(heap->len)heap->entries[i] = last;
+    return top;
+}
+
+/// @brief true when a frontier entry still describes an open node
+static inline bool boundedPool_isOpen(const BoundedPool* pool, BoundedEntry entry)
+{
+    const BoundedNode* node = &pool->nodes[entry.node];
+    return node->version == entry.version && node->f == entry.f && node->open;
+}
+
+/// @brief true when a leaf entry still describes a node that can be forgotten
+static inline bool boundedPool_isLeaf(const BoundedPool* pool, BoundedEntry entry)
+{
+    const BoundedNode* node = &pool->nodes[entry.node];
+    return node->version == entry.version && node->f == entry.f && node->children == 0 && node->parent != NO_PARENT;
+}
+
+/// @brief adds an entry to a heap, dropping the entries that no longer count
+///        first when it is full so the heaps stay within the pool budget
+static void boundedPool_push(BoundedPool* pool, BoundedHeap* heap, uint32_t node)
+{
+    if(heap->len == heap->capacity)
+    {
+        uint32_t kept = 0;
+        for(uint32_t i = 0; i < heap->len; i++)
+        {
+            BoundedEntry entry = heap->entries[i];
+            if(heap == &pool->frontier ? boundedPool_isOpen(pool, entry) : boundedPool_isLeaf(pool, entry))
+                heap->entries[kept++] = entry;
+        }
+        heap->len = 0;
+        for(uint32_t i = 0; i < kept; i++)
+            boundedHeap_push(heap, heap->entries[i]);
+    }
+    boundedHeap_push(heap, (BoundedEntry){pool->nodes[node].f, node, pool->nodes[node].version});
+}
+
+/// @brief the table slot of a city, either holding its node or empty
+static inline uint32_t boundedPool_slot(const BoundedPool* pool, uint32_t city)
+{
+    uint32_t slot = (city * 0x9e3779b1u) & pool->table_mask;
+    while(pool->table[slot] != NO_PARENT && pool->nodes[pool->table[slot]].city != city)
+        slot = (slot + 1) & pool->table_mask;
+    return slot;
+}
+
+/// @brief removes a city from the table, moving later entries of its probe run back
+static void boundedPool_unlink(BoundedPool* pool, uint32_t city)
+{
+    uint32_t hole = boundedPool_slot(pool, city), slot = hole;
+    pool->table[hole] = NO_PARENT;
+    while(true)
+    {
+        slot = (slot + 1) & pool->table_mask;
+        if(pool->table[slot] == NO_PARENT)return;
+        uint32_t home = (pool->nodes[pool->table[slot]].city * 0x9e3779b1u) & pool->table_mask;
+        // an entry may fill the hole when its home is not between the hole and itself
+        if(((slot - home) & pool->table_mask) >= ((slot - hole) & pool->table_mask))
+        {
+            pool->table[hole] = pool->table[slot];
+            pool->table[slot] = NO_PARENT;
+            hole = slot;
+        }
+    }
+}
+
+/// @brief changes the f of a node and queues it again where it belongs
+static void boundedPool_setF(BoundedPool* pool, uint32_t node, uint32_t f)
+{
+    BoundedNode* n = &pool->nodes[node];
+    n->f = f;
+    n->version++;
+    if(n->open)boundedPool_push(pool, &pool->frontier, node);
+    if(n->children == 0 && n->parent != NO_PARENT)boundedPool_push(pool, &pool->leaves, node);
+}
+
+/// @brief takes a child off its parent, a parent left without children can
+///        itself be forgotten, with an f of infinity once nothing under it is
+///        worth coming back to
+static void boundedPool_detach(BoundedPool* pool, uint32_t parent)
+{
+    BoundedNode* p = &pool->nodes[parent];
+    if(--p->children > 0)return;
+    if(!p->open && p->forgotten == BOUNDED_INFINITE)
+        boundedPool_setF(pool, parent, BOUNDED_INFINITE);
+    else if(p->parent != NO_PARENT)
+        boundedPool_push(pool, &pool->leaves, parent);
+}
+
+/// @brief forgets the leaf with the highest f, its parent remembers the f and
+///        goes back on the frontier to bring it back when it is worth it
+/// @param pool the pool to make room in
+/// @param keep a node that must stay, the one being expanded
+/// @return false if every node is on the path of another and none can go
+static bool boundedPool_evict(BoundedPool* pool, uint32_t keep)
+{
+    BoundedEntry skipped = {0};
+    bool have_skipped = false, evicted = false;
+    while(pool->leaves.len > 0)
+    {
+        BoundedEntry entry = boundedHeap_pop(&pool->leaves);
+        if(!boundedPool_isLeaf(pool, entry))continue;
+        if(entry.node == keep)
+        {
+            skipped = entry;
+            have_skipped = true;
+            continue;
+        }
+
+        BoundedNode* leaf = &pool->nodes[entry.node];
+        BoundedNode* parent = &pool->nodes[leaf->parent];
+        if(leaf->f < parent->forgotten)parent->forgotten = leaf->f;
+        uint32_t parent_id = leaf->parent;
+        boundedPool_unlink(pool, leaf->city);
+        leaf->version++;
+        leaf->open = false;
+        leaf->parent = pool->free_list;
+        pool->free_list = entry.node;
+        pool->used--;
+
+        // the parent has to be expanded again to bring the leaf back, as soon
+        // as the lowest estimate it forgot is the best on the frontier
+        BoundedNode* p = &pool->nodes[parent_id];
+        uint32_t reopen_f = p->forgotten > p->estimate ? p->forgotten : p->estimate;
+        if(p->forgotten != BOUNDED_INFINITE && parent_id != keep && (!p->open || reopen_f < p->f))
+        {
+            p->open = true;
+            boundedPool_setF(pool, parent_id, reopen_f);
+        }
+        boundedPool_detach(pool, parent_id);
+        evicted = true;
+        break;
+    }
+    if(have_skipped)
+        boundedHeap_push(&pool->leaves, skipped);
+    return evicted;
+}
+
+/// @brief writes the path of a pool node into the context so path_read finds it
+static void boundedPool_writePath(const BoundedPool* pool, SearchContext* ctx, uint32_t node)
+{
+    for(; node != NO_PARENT; node = pool->nodes[node].parent)
+    {
+        uint32_t parent = pool->nodes[node].parent;
+        searchContext_visit(ctx, pool->nodes[node].city, parent == NO_PARENT ? NO_PARENT : pool->nodes[parent].city, pool->nodes[node].g);
+    }
+}
+
+/// @brief memory bounded A* in the manner of SMA*, see the top of the region
+/// @param graph the graph to search
+/// @param ctx the search context to use, its bounded state holds the ceiling
+/// @param start the id of the city to start at
+/// @param end the id of the city to find
+/// @return true if a path was found, read it with path_read
+bool memoryBoundedAStar_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    size_t limit = bounded_begin(ctx);
+    searchContext_begin(ctx);
+
+    // a node takes its own slot, two entries in each heap and at least two
+    // table slots, the table rounds up to a power of two and the nodes then
+    // get whatever it leaves of the ceiling
+    const size_t per_node = sizeof(BoundedNode) + 4 * sizeof(BoundedEntry);
+    size_t wanted = limit / (per_node + 2 * sizeof(uint32_t));
+    uint32_t capacity = (uint32_t)(wanted < graph->num_nodes ? wanted : graph->num_nodes);
+    uint32_t table_len = 4;
+    while(table_len < 2 * capacity)table_len *= 2;
+    size_t table_bytes = table_len * sizeof(uint32_t);
+    size_t left = table_bytes < limit ? (limit - table_bytes) / per_node : 0;
+    if(left < capacity)capacity = (uint32_t)left;
+    if(capacity < 2)
+    {
+        ctx->bounded.limit_hit = true;
+        return false;
+    }
+
+    BoundedPool pool = {0};
+    pool.nodes = (BoundedNode*)malloc(capacity * sizeof(BoundedNode));
+    pool.table = (uint32_t*)malloc(table_len * sizeof(uint32_t));
+    pool.frontier = (BoundedHeap){(BoundedEntry*)malloc(2 * capacity * sizeof(BoundedEntry)), 0, 2 * capacity, false};
+    pool.leaves = (BoundedHeap){(BoundedEntry*)malloc(2 * capacity * sizeof(BoundedEntry)), 0, 2 * capacity, true};
+    if(!pool.nodes || !pool.table || !pool.frontier.entries || !pool.leaves.entries)
+    {
+        perror("unable to allocate memory bounded A* pool");
+        exit(0);
+    }
+    memset(pool.table, 0xff, table_len * sizeof(uint32_t));
+    pool.capacity = capacity;
+    pool.table_mask = table_len - 1;
+    pool.free_list = NO_PARENT;
+
+    uint32_t peak = 1, found = NO_PARENT;
+    pool.nodes[0] = (BoundedNode){start, NO_PARENT, 0, 0, 0, BOUNDED_INFINITE, 0, 0, true};
+    pool.nodes[0].estimate = pool.nodes[0].f = heuristic(graph, start, end);
+    pool.table[boundedPool_slot(&pool, start)] = 0;
+    pool.used = 1;
+    uint32_t next_unused = 1;
+    boundedPool_push(&pool, &pool.frontier, 0);
+
+    uint64_t max_expansions = (uint64_t)capacity * BOUNDED_REEXPANSIONS;
+    while(pool.frontier.len > 0)
+    {
+        BoundedEntry entry = boundedHeap_pop(&pool.frontier);
+        if(!boundedPool_isOpen(&pool, entry))continue;
+        if(entry.f == BOUNDED_INFINITE)break;
+        uint32_t current = entry.node;
+        BoundedNode* node = &pool.nodes[current];
+        if(node->city == end)
+        {
+            found = current;
+            break;
+        }
+        if(++ctx->bounded.expanded > max_expansions)
+        {
+            // forgetting and regenerating is going in circles, the pool is too small
+            ctx->bounded.limit_hit = true;
+            break;
+        }
+        node->open = false;
+        node->forgotten = BOUNDED_INFINITE;
+        uint32_t city = node->city, g = node->g, estimate = node->estimate;
+
+        for(uint32_t i = graph->offsets[city]; i < graph->offsets[city + 1]; i++)
+        {
+            if(graph->weights[i] == CONNECTION_CLOSED)continue;
+            uint32_t connected = graph->targets[i], new_g = g + graph->weights[i];
+            // pathmax, a child is never estimated lower than its parent
+            uint32_t h = heuristic(graph, connected, end), new_f = new_g + h > estimate ? new_g + h : estimate;
+            uint32_t slot = boundedPool_slot(&pool, connected);
+            uint32_t existing = pool.table[slot];
+            if(existing != NO_PARENT)
+            {
+                // a cheaper path to a city already in the pool moves it under this
+                // node and opens it again, the nodes below it pick up the cheaper
+                // cost when it is expanded. A node is never cheaper than its
+                // ancestors so this can not make a cycle
+                BoundedNode* other = &pool.nodes[existing];
+                if(new_g >= other->g)continue;
+                uint32_t old_parent = other->parent;
+                other->g = new_g;
+                other->estimate = new_f;
+                other->open = true;
+                if(old_parent != current)
+                {
+                    other->parent = current;
+                    pool.nodes[current].children++;
+                }
+                boundedPool_setF(&pool, existing, new_f);
+                if(old_parent != current && old_parent != NO_PARENT)boundedPool_detach(&pool, old_parent);
+                continue;
+            }
+
+            if(pool.used == pool.capacity && !boundedPool_evict(&pool, current))
+            {
+                // nothing can be forgotten, remember the rest to come back for it
+                ctx->bounded.limit_hit = true;
+                if(new_f < pool.nodes[current].forgotten)pool.nodes[current].forgotten = new_f;
+                continue;
+            }
+            uint32_t fresh = next_unused, version = 0;
+            if(pool.free_list != NO_PARENT)
+            {
+                fresh = pool.free_list;
+                pool.free_list = pool.nodes[fresh].parent;
+                version = pool.nodes[fresh].version + 1;
+            }
+            else
+                next_unused++;
+            pool.nodes[fresh] = (BoundedNode){connected, current, new_g, new_f, new_f, BOUNDED_INFINITE, 0, version, true};
+            pool.table[boundedPool_slot(&pool, connected)] = fresh;
+            pool.used++;
+            pool.nodes[current].children++;
+            boundedPool_push(&pool, &pool.frontier, fresh);
+            boundedPool_push(&pool, &pool.leaves, fresh);
+            if(pool.used > peak)peak = pool.used;
+        }
+
+        // a node that kept nothing is only worth what it forgot
+        node = &pool.nodes[current];
+        if(node->forgotten != BOUNDED_INFINITE)
+        {
+            node->open = true;
+            boundedPool_setF(&pool, current, node->forgotten > node->estimate ? node->forgotten : node->estimate);
+        }
+        else if(node->children == 0)
+            boundedPool_setF(&pool, current, BOUNDED_INFINITE);
+    }
+
+    ctx->bounded.peak_bytes = (size_t)peak * per_node + table_bytes;
+    if(found == NO_PARENT)
+    {
+        // the node still in the pool that looked closest to the end
+        uint32_t best_h = BOUNDED_INFINITE;
+        for(uint32_t i = 0; i < next_unused; i++)
+        {
+            if(pool.table[boundedPool_slot(&pool, pool.nodes[i].city)] != i)continue;
+            uint32_t h = heuristic(graph, pool.nodes[i].city, end);
+            if(found == NO_PARENT || h < best_h)
+            {
+                best_h = h;
+                found = i;
+            }
+        }
+    }
+    boundedPool_writePath(&pool, ctx, found);
+    ctx->bounded.best = pool.nodes[found].city;
+    bool reached = pool.nodes[found].city == end;
+    free(pool.nodes);
+    free(pool.table);
+    free(pool.frontier.entries);
+    free(pool.leaves.entries);
+    return reached;
+}
+
+/// @brief memory bounded A* for the City** interface
+City** memoryBoundedAStar(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    return memoryBoundedAStar_run(graph, ctx, start, end) ? walkBack(graph, ctx, start, end) : NULL;
+}
@@ -0,0 +1,27 @@
+#ifndef BOUNDED_SEARCH_H
+#define BOUNDED_SEARCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "graph.h"
+#include "search_context.h"
+
+// Searches that keep the memory of a query under a ceiling set in
+// ctx->bounded.memory_limit, on top of the per city arrays of the context
+// which they share with every other search. idaStar holds nothing but the path
+// it is following and repeats depth first searches with a growing cost limit.
+// memoryBoundedAStar is A* over a fixed pool of search nodes in the manner of
+// SMA*: when the pool is full it forgets the leaf with the highest estimate,
+// its parent remembers the lowest estimate it forgot and is expanded again
+// once that becomes the best on the frontier, so forgotten cities come back
+// when they are worth it. Both find the cheapest path when the ceiling allows
+// and otherwise fail with ctx->bounded.limit_hit set and the path to the city
+// that got closest by the heuristic in the context, read it with path_read
+#define BOUNDED_DEFAULT_LIMIT (64u << 20)
+
+bool idaStar_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+City** idaStar(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+bool memoryBoundedAStar_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+City** memoryBoundedAStar(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+
+#endif
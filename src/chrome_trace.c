@@ -0,0 +1,76 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "chrome_trace.h"
+#include "search_context.h"
+#include "util.h"
+
+#ifdef SEARCH_STATS
+/// @brief writes the separator and the fields shared by every event
+static void chromeTrace_event(ChromeTrace* trace, const char* name, const char* phase)
+{
+    fprintf(trace->file, "%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":1",
+        trace->any_event ? "," : "", name, phase, (nowNs() - trace->origin_ns) / 1e3);
+    trace->any_event = true;
+}
+
+/// @brief starts a trace file
+/// @param path the path of the file, replaced if it exists
+/// @return a new trace to hand to searches as the trace_arg of chromeTrace_hook
+///         or NULL if the file could not be created, finish it with chromeTrace_close
+ChromeTrace* chromeTrace_open(const char* path)
+{
+    ChromeTrace* trace = (ChromeTrace*)calloc(1, sizeof(ChromeTrace));
+    if(trace == NULL)
+    {
+        perror("unable to calloc chrome trace");
+        exit(0);
+    }
+    trace->file = fopen(path, "w");
+    if(trace->file == NULL)
+    {
+        perror(path);
+        free(trace);
+        return NULL;
+    }
+    trace->origin_ns = nowNs();
+    fprintf(trace->file, "{\"traceEvents\":[");
+    return trace;
+}
+
+/// @brief the SearchTraceHook that records into a ChromeTrace, a query ends
+///        when the next one begins or the trace is closed
+void chromeTrace_hook(void* arg, SearchTraceEvent event, uint32_t node, uint32_t g_score)
+{
+    ChromeTrace* trace = (ChromeTrace*)arg;
+    if(event == SEARCH_TRACE_BEGIN)
+    {
+        if(trace->in_query)
+        {
+            chromeTrace_event(trace, "query", "E");
+            fprintf(trace->file, "}");
+        }
+        chromeTrace_event(trace, "query", "B");
+        fprintf(trace->file, "}");
+        trace->in_query = true;
+        return;
+    }
+    chromeTrace_event(trace, event == SEARCH_TRACE_EXPAND ? "expand" : "expand backward", "i");
+    fprintf(trace->file, ",\"s\":\"t\",\"args\":{\"node\":%u,\"g\":%u}}", node, g_score);
+}
+
+/// @brief ends the last query, finishes the file and releases the trace
+void chromeTrace_close(ChromeTrace* trace)
+{
+    if(trace->in_query)
+    {
+        chromeTrace_event(trace, "query", "E");
+        fprintf(trace->file, "}");
+    }
+    fprintf(trace->file, "\n]}\n");
+    fclose(trace->file);
+    free(trace);
+}
+#endif
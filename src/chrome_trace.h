@@ -0,0 +1,25 @@
+#ifndef CHROME_TRACE_H
+#define CHROME_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "search_context.h"
+
+#ifdef SEARCH_STATS
+// A trace hook that writes the Chrome trace event format, open the file in
+// chrome://tracing or Perfetto. Every query is a duration event and every
+// expansion an instant event inside it carrying the city and its cost
+typedef struct chrome_trace{
+    FILE* file;
+    uint64_t origin_ns; // the time the trace was opened, events are relative to it
+    bool in_query; // a query duration event is open
+    bool any_event; // an event has been written, the next one needs a comma
+} ChromeTrace;
+
+ChromeTrace* chromeTrace_open(const char* path);
+void chromeTrace_hook(void* arg, SearchTraceEvent event, uint32_t node, uint32_t g_score);
+void chromeTrace_close(ChromeTrace* trace);
+#endif
+
+#endif
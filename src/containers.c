@@ -0,0 +1,394 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "containers.h"
+
+Node* node_createNode(void* data)
+{
+    Node* node = (Node*)calloc(1, sizeof(Node));
+    node->data = data;
+    return node;
+}
+
+PNode* pnode_createNode(void* data, uint32_t score)
+{
+    PNode* node = (PNode*)calloc(1, sizeof(PNode));
+    node->data = data;
+    node->score = score;
+    return node;
+}
+
+void queue_enqueue(Queue* queue, Node* node)
+{
+    if(!queue->tail)
+    {
+        queue->head = node;
+        queue->tail = node;
+    }
+    else
+    {
+        queue->tail->next = node;
+        queue->tail = node;
+    } 
+}
+
+Node* queue_dequeue(Queue* queue)
+{
+    if(queue->head == NULL)return NULL;
+
+    Node *temp = queue->head;
+
+    queue->head = queue->head->next;
+    if(queue->head == NULL)queue->tail = NULL;
+    
+    return temp;
+}
+
+/// @brief a function to check if a specific data value is in the queue
+/// @param queue the queue you want to search
+/// @param data the data you want to search for
+/// @return a bool indicating if the data is in the queue
+bool queue_inqueue(Queue* queue, void* data)
+{
+    Node* activeNode = queue->head;
+    while(activeNode)
+    {
+        if(activeNode->data == data)return true;
+        activeNode = activeNode->next;
+    }
+    return false;
+}
+
+void pqueue_enqueue(PQueue* pqueue, PNode* node)
+{
+    PNode** insert_location = &pqueue->head;
+    while(true)
+    {
+        if(*insert_location == NULL || (*insert_location)->score > node->score)
+        {
+            node->next = *insert_location;
+            *insert_location = node;
+            break;
+        }
+        else
+        {
+            insert_location = &((*insert_location)->next);
+        }
+    }
+    return;
+}
+
+PNode* pqueue_dequeue(PQueue* pqueue)
+{
+    PNode *temp = pqueue->head;
+
+    if(temp == NULL)return NULL;
+    pqueue->head = temp->next;
+
+    return temp;
+}
+
+/// @brief a function to check if a specific data value is in the queue
+/// @param Pqueue the queue you want to search
+/// @param data the data you want to search for
+/// @return a bool indicating if the data is in the queue
+bool pqueue_inqueue(PQueue* pqueue, void* data)
+{
+    PNode* activeNode = pqueue->head;
+    while(activeNode)
+    {
+        if(activeNode->data == data)
+            return true;
+        activeNode = activeNode->next;
+    }
+    return false;
+}
+
+/// @brief a function to return a Node with a matching piece of data
+/// @param pqueue the queue you want to search
+/// @param city the data you want to match against
+/// @return a PNode with data matching the provided data, priority
+///         should not be modified unless reinserted with replaceSpecific
+PNode* pqueue_findInQueue(PQueue *pqueue, void* city)
+{
+    PNode* activeNode = pqueue->head;
+    while(activeNode)
+    {
+        if(activeNode->data == city)
+            return activeNode;
+        activeNode = activeNode->next;
+    }
+    return NULL;
+}
+
+/// @brief The same as findInQueue except it returns a pointer to the parent of the matched item
+/// @param pqueue the queue you want to search
+/// @param city the data you want to match against
+/// @return a PNode with next->data matching the provided data, priority
+///         should not be modified unless reinserted with replaceSpecific
+PNode** pqueue_findInQueueParent(PQueue *pqueue, void* city)
+{
+    PNode **activeNodePtr = &pqueue->head;
+
+    while(*activeNodePtr != NULL)
+    {
+        if((*activeNodePtr)->data == city)
+            return activeNodePtr;
+        activeNodePtr = &((*activeNodePtr)->next);
+    }
+
+    return NULL;
+}
+
+/// @brief Changes the score of a Node in the priority queue with matching data
+/// @param pqueue the queue you want to search
+/// @param city the data you want to match against
+/// @param new_score the new score you want to assign
+void pqueue_replaceSpecific(PQueue *pqueue, void* city, uint32_t new_score)
+{
+    PNode** nodeToBeChanged = pqueue_findInQueueParent(pqueue, city);
+    if(nodeToBeChanged == NULL)return;
+
+    PNode* cpy = *nodeToBeChanged;
+    (*nodeToBeChanged) = cpy->next;
+    cpy->score = new_score;
+    pqueue_enqueue(pqueue, cpy);
+}
+
+// The linked list priority queue above needs a linear walk for every insert
+// and every lookup, the indexed heap keeps a slot table keyed by an integer id
+// so lookups are O(1) and push/pop/decrease key are O(log n)
+#define IHEAP_ARITY 4
+
+/// @brief makes sure the slot table can index the given id
+/// @param heap the heap to grow
+/// @param id the id that needs a slot
+void iheap_reserveId(IHeap* heap, uint32_t id)
+{
+    if(id < heap->slots_len)return;
+
+    uint32_t new_len = heap->slots_len ? heap->slots_len : 64;
+    while(new_len <= id)
+        new_len *= 2;
+
+    uint32_t* slots = (uint32_t*)realloc(heap->slots, new_len * sizeof(uint32_t));
+    if(slots == NULL)
+    {
+        perror("unable to realloc heap slots");
+        exit(0);
+    }
+    for(uint32_t i = heap->slots_len; i < new_len; i++)
+        slots[i] = IHEAP_NOT_IN_HEAP;
+
+    heap->slots = slots;
+    heap->slots_len = new_len;
+}
+
+/// @brief writes an entry into a position of the heap and records its slot
+static inline void iheap_place(IHeap* heap, uint32_t pos, IHeapEntry entry)
+{
+    heap->entries[pos] = entry;
+    heap->slots[entry.id] = pos;
+}
+
+/// @brief moves the entry at pos towards the root until the heap property holds
+static void iheap_siftUp(IHeap* heap, uint32_t pos)
+{
+    IHeapEntry entry = heap->entries[pos];
+    while(pos > 0)
+    {
+        uint32_t parent = (pos - 1) / IHEAP_ARITY;
+        if(heap->entries[parent].score <= entry.score)break;
+        iheap_place(heap, pos, heap->entries[parent]);
+        pos = parent;
+    }
+    iheap_place(heap, pos, entry);
+}
+
+/// @brief moves the entry at pos towards the leaves until the heap property holds
+static void iheap_siftDown(IHeap* heap, uint32_t pos)
+{
+    IHeapEntry entry = heap->entries[pos];
+    while(true)
+    {
+        uint32_t first_child = pos * IHEAP_ARITY + 1;
+        if(first_child >= heap->size)break;
+
+        // find the child with the lowest score
+        uint32_t last_child = first_child + IHEAP_ARITY;
+        if(last_child > heap->size)last_child = heap->size;
+        uint32_t best = first_child;
+        for(uint32_t child = first_child + 1; child < last_child; child++)
+        {
+            if(heap->entries[child].score < heap->entries[best].score)
+                best = child;
+        }
+
+        if(heap->entries[best].score >= entry.score)break;
+        iheap_place(heap, pos, heap->entries[best]);
+        pos = best;
+    }
+    iheap_place(heap, pos, entry);
+}
+
+/// @brief adds an id to the heap, the id must not already be in the heap
+/// @param heap the heap to add to
+/// @param id the id to add
+/// @param score the priority of the id, lower scores are popped first
+void iheap_push(IHeap* heap, uint32_t id, uint64_t score)
+{
+    iheap_reserveId(heap, id);
+    if(heap->size == heap->capacity)
+    {
+        uint32_t new_capacity = heap->capacity ? heap->capacity * 2 : 64;
+        IHeapEntry* entries = (IHeapEntry*)realloc(heap->entries, new_capacity * sizeof(IHeapEntry));
+        if(entries == NULL)
+        {
+            perror("unable to realloc heap entries");
+            exit(0);
+        }
+        heap->entries = entries;
+        heap->capacity = new_capacity;
+    }
+
+    heap->entries[heap->size] = (IHeapEntry){score, id};
+    iheap_siftUp(heap, heap->size++);
+}
+
+/// @brief removes the id with the lowest score from the heap
+/// @param heap the heap to pop from
+/// @param id out parameter for the popped id
+/// @param score out parameter for the popped score (may be NULL)
+/// @return false if the heap was empty
+bool iheap_pop(IHeap* heap, uint32_t* id, uint64_t* score)
+{
+    if(heap->size == 0)return false;
+
+    IHeapEntry top = heap->entries[0];
+    heap->slots[top.id] = IHEAP_NOT_IN_HEAP;
+    if(--heap->size > 0)
+    {
+        heap->entries[0] = heap->entries[heap->size];
+        iheap_siftDown(heap, 0);
+    }
+
+    *id = top.id;
+    if(score)*score = top.score;
+    return true;
+}
+
+/// @brief lowers the score of an id that is already in the heap
+/// @param heap the heap containing the id
+/// @param id the id whose score should change
+/// @param new_score the new score, must not be greater than the current one
+void iheap_decreaseKey(IHeap* heap, uint32_t id, uint64_t new_score)
+{
+    uint32_t pos = heap->slots[id];
+    heap->entries[pos].score = new_score;
+    iheap_siftUp(heap, pos);
+}
+
+/// @brief restores the heap property after the scores were changed in place
+void iheap_rebuild(IHeap* heap)
+{
+    if(heap->size < 2)return;
+    for(uint32_t pos = (heap->size - 2) / IHEAP_ARITY + 1; pos-- > 0;)
+        iheap_siftDown(heap, pos);
+}
+
+/// @brief empties the heap while keeping its memory for reuse
+void iheap_clear(IHeap* heap)
+{
+    for(uint32_t i = 0; i < heap->size; i++)
+        heap->slots[heap->entries[i].id] = IHEAP_NOT_IN_HEAP;
+    heap->size = 0;
+}
+
+/// @brief releases the memory held by the heap
+void iheap_free(IHeap* heap)
+{
+    free(heap->entries);
+    free(heap->slots);
+    *heap = (IHeap){0};
+}
+
+void push(Stack* stack, Node* node)
+{
+    if(stack->head == NULL)
+    {
+        stack->head = node;
+    }
+    else
+    {
+        node->next = stack->head;
+        stack->head = node;
+    }
+    stack->size++;
+}
+
+Node* pop(Stack* stack)
+{
+    if(stack->head == NULL)
+        return NULL;
+    else
+    {
+        Node* temp = stack->head;
+        stack->head = temp->next;
+        stack->size--;
+        return temp;
+    }
+}
+
+// The search loops only ever queue node ids, these keep them in one
+// contiguous growable buffer rather than a linked list of nodes so a
+// push or pop is an array access, and the buffers are kept between
+// queries so they stop allocating once they have grown to fit the graph
+
+/// @brief doubles the buffer of a full queue, keeping the ids in order
+void idQueue_grow(IdQueue* queue)
+{
+    uint32_t old_capacity = queue->capacity;
+    uint32_t new_capacity = old_capacity ? old_capacity * 2 : 256;
+    uint32_t* items = (uint32_t*)realloc(queue->items, new_capacity * sizeof(uint32_t));
+    if(items == NULL)
+    {
+        perror("unable to realloc id queue");
+        exit(0);
+    }
+    // the ids that wrapped around to the front of the old buffer
+    // have to move so they follow on from the end of it again
+    uint32_t wrapped = queue->head + queue->len > old_capacity ? queue->head + queue->len - old_capacity : 0;
+    memcpy(items + old_capacity, items, wrapped * sizeof(uint32_t));
+    queue->items = items;
+    queue->capacity = new_capacity;
+}
+
+/// @brief releases the buffer of the queue
+void idQueue_free(IdQueue* queue)
+{
+    free(queue->items);
+    *queue = (IdQueue){0};
+}
+
+/// @brief doubles the buffer of a full stack
+void idStack_grow(IdStack* stack)
+{
+    uint32_t new_capacity = stack->capacity ? stack->capacity * 2 : 256;
+    uint32_t* items = (uint32_t*)realloc(stack->items, new_capacity * sizeof(uint32_t));
+    if(items == NULL)
+    {
+        perror("unable to realloc id stack");
+        exit(0);
+    }
+    stack->items = items;
+    stack->capacity = new_capacity;
+}
+
+/// @brief releases the buffer of the stack
+void idStack_free(IdStack* stack)
+{
+    free(stack->items);
+    *stack = (IdStack){0};
+}
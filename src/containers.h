@@ -0,0 +1,159 @@
+#ifndef CONTAINERS_H
+#define CONTAINERS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct node Node;
+typedef struct node{
+    void *data;
+    Node *next;
+} Node;
+
+// The following is a node with a score for the 
+// priority queue, its mostly the same
+typedef struct pnode PNode;
+typedef struct pnode{
+    void *data;
+    PNode *next;
+    uint32_t score;
+} PNode;
+
+typedef struct queue{
+    Node* head;
+    Node* tail;
+} Queue;
+
+typedef struct pqueue{
+    PNode* head;
+} PQueue;
+
+#define IHEAP_NOT_IN_HEAP UINT32_MAX
+
+typedef struct iheap_entry{
+    uint64_t score; // wide enough for keys that add up several costs
+    uint32_t id;
+} IHeapEntry;
+
+typedef struct iheap{
+    IHeapEntry* entries; // the heap ordered array of entries
+    uint32_t size; // the number of entries currently in the heap
+    uint32_t capacity; // the number of entries that fit in the entries array
+    uint32_t* slots; // slots[id] is the position of id in entries or IHEAP_NOT_IN_HEAP
+    uint32_t slots_len; // the number of ids the slot table can index
+} IHeap;
+
+typedef struct stack{
+    Node* head;
+    uint32_t size;
+} Stack;
+
+// a FIFO ring buffer of ids, the capacity is always a power of two
+typedef struct id_queue{
+    uint32_t* items;
+    uint32_t capacity; // the size of items
+    uint32_t head; // the position of the oldest id
+    uint32_t len; // the number of ids in the queue
+} IdQueue;
+
+// a LIFO stack of ids
+typedef struct id_stack{
+    uint32_t* items;
+    uint32_t capacity; // the size of items
+    uint32_t len; // the number of ids on the stack
+} IdStack;
+
+Node* node_createNode(void* data);
+PNode* pnode_createNode(void* data, uint32_t score);
+void queue_enqueue(Queue* queue, Node* node);
+Node* queue_dequeue(Queue* queue);
+bool queue_inqueue(Queue* queue, void* data);
+void pqueue_enqueue(PQueue* pqueue, PNode* node);
+PNode* pqueue_dequeue(PQueue* pqueue);
+bool pqueue_inqueue(PQueue* pqueue, void* data);
+PNode* pqueue_findInQueue(PQueue *pqueue, void* city);
+PNode** pqueue_findInQueueParent(PQueue *pqueue, void* city);
+void pqueue_replaceSpecific(PQueue *pqueue, void* city, uint32_t new_score);
+void iheap_reserveId(IHeap* heap, uint32_t id);
+void iheap_push(IHeap* heap, uint32_t id, uint64_t score);
+bool iheap_pop(IHeap* heap, uint32_t* id, uint64_t* score);
+void iheap_decreaseKey(IHeap* heap, uint32_t id, uint64_t new_score);
+void iheap_rebuild(IHeap* heap);
+void iheap_clear(IHeap* heap);
+void iheap_free(IHeap* heap);
+void push(Stack* stack, Node* node);
+Node* pop(Stack* stack);
+void idQueue_grow(IdQueue* queue);
+void idQueue_free(IdQueue* queue);
+void idStack_grow(IdStack* stack);
+void idStack_free(IdStack* stack);
+
+/// @brief a function to check if an id is in the heap
+/// @param heap the heap you want to search
+/// @param id the id you want to search for
+/// @return a bool indicating if the id is in the heap
+static inline bool iheap_contains(const IHeap* heap, uint32_t id)
+{
+    return id < heap->slots_len && heap->slots[id] != IHEAP_NOT_IN_HEAP;
+}
+
+/// @brief gets the score of an id that is in the heap, check with iheap_contains first
+static inline uint64_t iheap_score(const IHeap* heap, uint32_t id)
+{
+    return heap->entries[heap->slots[id]].score;
+}
+
+/// @brief adds an id to the back of the queue
+static inline void idQueue_push(IdQueue* queue, uint32_t id)
+{
+    if(queue->len == queue->capacity)
+        idQueue_grow(queue);
+    queue->items[(queue->head + queue->len++) & (queue->capacity - 1)] = id;
+}
+
+/// @brief removes the id at the front of the queue
+/// @param queue the queue to take from
+/// @param id out parameter for the removed id
+/// @return false if the queue was empty
+static inline bool idQueue_pop(IdQueue* queue, uint32_t* id)
+{
+    if(queue->len == 0)return false;
+    *id = queue->items[queue->head];
+    queue->head = (queue->head + 1) & (queue->capacity - 1);
+    queue->len--;
+    return true;
+}
+
+/// @brief empties the queue while keeping its buffer
+static inline void idQueue_clear(IdQueue* queue)
+{
+    queue->head = 0;
+    queue->len = 0;
+}
+
+/// @brief pushes an id on top of the stack
+static inline void idStack_push(IdStack* stack, uint32_t id)
+{
+    if(stack->len == stack->capacity)
+        idStack_grow(stack);
+    stack->items[stack->len++] = id;
+}
+
+/// @brief pops the id on top of the stack
+/// @param stack the stack to take from
+/// @param id out parameter for the removed id
+/// @return false if the stack was empty
+static inline bool idStack_pop(IdStack* stack, uint32_t* id)
+{
+    if(stack->len == 0)return false;
+    *id = stack->items[--stack->len];
+    return true;
+}
+
+/// @brief empties the stack while keeping its buffer
+static inline void idStack_clear(IdStack* stack)
+{
+    stack->len = 0;
+}
+
+#endif
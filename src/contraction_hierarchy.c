@@ -0,0 +1,497 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "contraction_hierarchy.h"
+#include "containers.h"
+#include "graph.h"
+#include "search_context.h"
+#include "search.h"
+
+// Preprocessing contracts the cities one at a time in order of importance.
+// Removing a city adds a shortcut between each pair of its neighbours whose
+// shortest path ran through it, so every shortest path of the graph also
+// exists as a path that only climbs in rank and then only descends. A query
+// runs one Dijkstra upward from each end, which only ever sees a small part
+// of the graph, and unpacks the shortcuts on the path where the two meet
+#define CH_WITNESS_SETTLE_LIMIT 500
+#define CH_PRIORITY_BIAS (1u << 30)
+
+// the working state of preprocessing, a mutable copy of the graph that
+// loses cities as they are contracted and gains shortcuts
+typedef struct ch_builder{
+    uint32_t num_nodes;
+    CHEdgeList* out; // out[v] is every connection leaving v to an uncontracted city
+    CHEdgeList* in; // in[v] is every connection entering v from an uncontracted city
+    bool* contracted; // whether each city has been contracted yet
+    uint32_t* deleted_neighbours; // how many neighbours of each city have been contracted
+    SearchContext* witness; // scratch space for the witness searches
+} CHBuilder;
+
+/// @brief adds a connection to a hierarchy edge list
+void chEdgeList_add(CHEdgeList* list, CHEdge edge)
+{
+    if(list->len == list->capacity)
+    {
+        uint32_t new_capacity = list->capacity ? list->capacity * 2 : 4;
+        CHEdge* edges = (CHEdge*)realloc(list->edges, new_capacity * sizeof(CHEdge));
+        if(edges == NULL)
+        {
+            perror("unable to realloc hierarchy edge list");
+            exit(0);
+        }
+        list->edges = edges;
+        list->capacity = new_capacity;
+    }
+    list->edges[list->len++] = edge;
+}
+
+/// @brief finds the connection to a city in a hierarchy edge list
+/// @return the index of the connection or NO_PARENT if there is none
+static uint32_t chEdgeList_find(const CHEdgeList* list, uint32_t node)
+{
+    for(uint32_t i = 0; i < list->len; i++)
+    {
+        if(list->edges[i].node == node)return i;
+    }
+    return NO_PARENT;
+}
+
+/// @brief removes the connection to a city from a hierarchy edge list if there is one
+static void chEdgeList_remove(CHEdgeList* list, uint32_t node)
+{
+    uint32_t index = chEdgeList_find(list, node);
+    if(index != NO_PARENT)
+        list->edges[index] = list->edges[--list->len];
+}
+
+/// @brief adds a connection between two uncontracted cities to the builder,
+///        when they are already connected only the shorter connection is kept
+/// @param builder the preprocessing state
+/// @param from the city the connection starts at
+/// @param to the city the connection goes to
+/// @param weight the length of the connection
+/// @param middle the city a shortcut skips over, NO_PARENT for original connections
+static void chBuilder_addEdge(CHBuilder* builder, uint32_t from, uint32_t to, uint32_t weight, uint32_t middle)
+{
+    uint32_t index = chEdgeList_find(&builder->out[from], to);
+    if(index != NO_PARENT)
+    {
+        if(builder->out[from].edges[index].weight <= weight)return;
+        builder->out[from].edges[index] = (CHEdge){to, weight, middle};
+        builder->in[to].edges[chEdgeList_find(&builder->in[to], from)] = (CHEdge){from, weight, middle};
+        return;
+    }
+    chEdgeList_add(&builder->out[from], (CHEdge){to, weight, middle});
+    chEdgeList_add(&builder->in[to], (CHEdge){from, weight, middle});
+}
+
+/// @brief a Dijkstra search over the uncontracted cities that never passes
+///        through one city, the distances are left in the witness context
+/// @param builder the preprocessing state
+/// @param source the city to search from
+/// @param avoid the city being contracted
+/// @param max_cost paths longer than this are not of interest
+static void chBuilder_witnessSearch(CHBuilder* builder, uint32_t source, uint32_t avoid, uint32_t max_cost)
+{
+    SearchContext* ctx = builder->witness;
+    uint32_t current = 0, settled = 0;
+    uint64_t cost = 0;
+
+    searchContext_begin(ctx);
+    searchContext_visit(ctx, source, NO_PARENT, 0);
+    iheap_push(&ctx->heap, source, 0);
+
+    // the search is cut off after a fixed number of cities, a missed witness
+    // only means an unnecessary shortcut, never a wrong answer
+    while(iheap_pop(&ctx->heap, &current, &cost) && cost <= max_cost && ++settled <= CH_WITNESS_SETTLE_LIMIT)
+    {
+        const CHEdgeList* out = &builder->out[current];
+        for(uint32_t i = 0; i < out->len; i++)
+        {
+            uint32_t connected = out->edges[i].node;
+            uint32_t new_cost = cost + out->edges[i].weight;
+            if(connected == avoid || new_cost > max_cost)continue;
+
+            if(searchContext_visited(ctx, connected))
+            {
+                if(!iheap_contains(&ctx->heap, connected) || ctx->g_scores[connected] <= new_cost)continue;
+                ctx->g_scores[connected] = new_cost;
+                iheap_decreaseKey(&ctx->heap, connected, new_cost);
+            }
+            else
+            {
+                searchContext_visit(ctx, connected, current, new_cost);
+                iheap_push(&ctx->heap, connected, new_cost);
+            }
+        }
+    }
+}
+
+/// @brief works out which shortcuts contracting a city needs
+/// @param builder the preprocessing state
+/// @param node the city to contract
+/// @param apply whether the shortcuts should actually be added
+/// @return the number of shortcuts needed
+static uint32_t chBuilder_shortcuts(CHBuilder* builder, uint32_t node, bool apply)
+{
+    const CHEdgeList* in = &builder->in[node];
+    const CHEdgeList* out = &builder->out[node];
+    SearchContext* witness = builder->witness;
+    uint32_t shortcuts = 0, max_out = 0;
+
+    for(uint32_t o = 0; o < out->len; o++)
+    {
+        if(out->edges[o].weight > max_out)max_out = out->edges[o].weight;
+    }
+
+    for(uint32_t i = 0; i < in->len; i++)
+    {
+        CHEdge in_edge = in->edges[i];
+        chBuilder_witnessSearch(builder, in_edge.node, node, in_edge.weight + max_out);
+
+        for(uint32_t o = 0; o < out->len; o++)
+        {
+            CHEdge out_edge = out->edges[o];
+            uint32_t via = in_edge.weight + out_edge.weight;
+            if(out_edge.node == in_edge.node)continue;
+
+            // a path at least as short that avoids the city makes the shortcut unnecessary
+            if(searchContext_visited(witness, out_edge.node) && witness->g_scores[out_edge.node] <= via)continue;
+
+            shortcuts++;
+            if(apply)
+                chBuilder_addEdge(builder, in_edge.node, out_edge.node, via, node);
+        }
+    }
+    return shortcuts;
+}
+
+/// @brief the contraction priority of a city, cities that add few shortcuts
+///        compared to the connections they remove and whose neighbours have not
+///        been contracted much yet go first
+static uint32_t chBuilder_priority(CHBuilder* builder, uint32_t node)
+{
+    int64_t shortcuts = chBuilder_shortcuts(builder, node, false);
+    int64_t removed = builder->in[node].len + builder->out[node].len;
+    return (uint32_t)(CH_PRIORITY_BIAS + 2 * shortcuts - removed + builder->deleted_neighbours[node]);
+}
+
+/// @brief contracts a city, adding its shortcuts and disconnecting it from the
+///        uncontracted cities, what is left in its lists are its hierarchy connections
+static void chBuilder_contract(CHBuilder* builder, uint32_t node)
+{
+    chBuilder_shortcuts(builder, node, true);
+
+    CHEdgeList* out = &builder->out[node];
+    CHEdgeList* in = &builder->in[node];
+    for(uint32_t o = 0; o < out->len; o++)
+    {
+        chEdgeList_remove(&builder->in[out->edges[o].node], node);
+        builder->deleted_neighbours[out->edges[o].node]++;
+    }
+    for(uint32_t i = 0; i < in->len; i++)
+    {
+        chEdgeList_remove(&builder->out[in->edges[i].node], node);
+        builder->deleted_neighbours[in->edges[i].node]++;
+    }
+    builder->contracted[node] = true;
+}
+
+/// @brief packs one set of per city edge lists into a contiguous array
+static void chBuilder_pack(const CHEdgeList* lists, uint32_t num_nodes, uint32_t** offsets, CHEdge** edges, uint32_t* num_shortcuts)
+{
+    *offsets = (uint32_t*)malloc((num_nodes + 1) * sizeof(uint32_t));
+    if(*offsets == NULL)
+    {
+        perror("unable to malloc hierarchy offsets");
+        exit(0);
+    }
+    (*offsets)[0] = 0;
+    for(uint32_t v = 0; v < num_nodes; v++)
+        (*offsets)[v + 1] = (*offsets)[v] + lists[v].len;
+
+    *edges = (CHEdge*)malloc(((*offsets)[num_nodes] ? (*offsets)[num_nodes] : 1) * sizeof(CHEdge));
+    if(*edges == NULL)
+    {
+        perror("unable to malloc hierarchy edges");
+        exit(0);
+    }
+    for(uint32_t v = 0; v < num_nodes; v++)
+    {
+        memcpy(*edges + (*offsets)[v], lists[v].edges, lists[v].len * sizeof(CHEdge));
+        for(uint32_t i = 0; i < lists[v].len; i++)
+        {
+            if(lists[v].edges[i].middle != NO_PARENT)(*num_shortcuts)++;
+        }
+    }
+}
+
+/// @brief builds the contraction hierarchy of a graph, attach the result to
+///        graph->ch to make contractionHierarchySearch use it
+/// @param graph the graph to preprocess
+/// @return a newly allocated hierarchy, freed along with the graph
+ContractionHierarchy* contractionHierarchy_build(const Graph* graph)
+{
+    uint32_t n = graph->num_nodes, len = n ? n : 1;
+    CHBuilder builder = {.num_nodes = n};
+    builder.out = (CHEdgeList*)calloc(len, sizeof(CHEdgeList));
+    builder.in = (CHEdgeList*)calloc(len, sizeof(CHEdgeList));
+    builder.contracted = (bool*)calloc(len, sizeof(bool));
+    builder.deleted_neighbours = (uint32_t*)calloc(len, sizeof(uint32_t));
+    ContractionHierarchy* ch = (ContractionHierarchy*)calloc(1, sizeof(ContractionHierarchy));
+    if(!builder.out || !builder.in || !builder.contracted || !builder.deleted_neighbours || !ch)
+    {
+        perror("unable to allocate contraction hierarchy");
+        exit(0);
+    }
+    builder.witness = searchContext_create(graph);
+    ch->num_nodes = n;
+    ch->rank = (uint32_t*)malloc(len * sizeof(uint32_t));
+    ch->by_rank = (uint32_t*)malloc(len * sizeof(uint32_t));
+    if(ch->rank == NULL || ch->by_rank == NULL)
+    {
+        perror("unable to malloc hierarchy ranks");
+        exit(0);
+    }
+
+    // start from the original connections, loops are never on a shortest path
+    for(uint32_t v = 0; v < n; v++)
+    {
+        for(uint32_t i = graph->offsets[v]; i < graph->offsets[v + 1]; i++)
+        {
+            if(graph->targets[i] != v && graph->weights[i] != CONNECTION_CLOSED)
+                chBuilder_addEdge(&builder, v, graph->targets[i], graph->weights[i], NO_PARENT);
+        }
+    }
+
+    // contract cities in priority order, priorities go stale as neighbours are
+    // contracted so each one is recomputed when it reaches the top and the city
+    // goes back in the queue if it is no longer the cheapest
+    IHeap order = {0};
+    for(uint32_t v = 0; v < n; v++)
+        iheap_push(&order, v, chBuilder_priority(&builder, v));
+
+    uint32_t node = 0, next_rank = 0;
+    while(iheap_pop(&order, &node, NULL))
+    {
+        uint32_t priority = chBuilder_priority(&builder, node);
+        if(order.size > 0 && priority > order.entries[0].score)
+        {
+            iheap_push(&order, node, priority);
+            continue;
+        }
+        chBuilder_contract(&builder, node);
+        ch->rank[node] = next_rank++;
+        ch->by_rank[n - next_rank] = node;
+    }
+    iheap_free(&order);
+
+    chBuilder_pack(builder.out, n, &ch->up_offsets, &ch->up_edges, &ch->num_shortcuts);
+    chBuilder_pack(builder.in, n, &ch->down_offsets, &ch->down_edges, &ch->num_shortcuts);
+
+    for(uint32_t v = 0; v < n; v++)
+    {
+        free(builder.out[v].edges);
+        free(builder.in[v].edges);
+    }
+    free(builder.out);
+    free(builder.in);
+    free(builder.contracted);
+    free(builder.deleted_neighbours);
+    searchContext_free(builder.witness);
+    return ch;
+}
+
+/// @brief releases the memory held by a contraction hierarchy
+void contractionHierarchy_free(ContractionHierarchy* ch)
+{
+    free(ch->rank);
+    free(ch->by_rank);
+    free(ch->up_offsets);
+    free(ch->up_edges);
+    free(ch->down_offsets);
+    free(ch->down_edges);
+    free(ch);
+}
+
+/// @brief finds the hierarchy connection between two cities, it is stored
+///        with whichever of the two cities has the lower rank
+static const CHEdge* contractionHierarchy_findEdge(const ContractionHierarchy* ch, uint32_t from, uint32_t to)
+{
+    if(ch->rank[from] < ch->rank[to])
+    {
+        for(uint32_t i = ch->up_offsets[from]; i < ch->up_offsets[from + 1]; i++)
+        {
+            if(ch->up_edges[i].node == to)return &ch->up_edges[i];
+        }
+    }
+    else
+    {
+        for(uint32_t i = ch->down_offsets[to]; i < ch->down_offsets[to + 1]; i++)
+        {
+            if(ch->down_edges[i].node == from)return &ch->down_edges[i];
+        }
+    }
+    return NULL;
+}
+
+/// @brief turns the hierarchy path through meet into the original path and
+///        records it in the forward state of the context so walkBack can read it
+static void contractionHierarchy_unpack(const ContractionHierarchy* ch, SearchContext* ctx, uint32_t start, uint32_t meet)
+{
+    // collect the hierarchy path, the forward half is walked backwards so it
+    // gets reversed, then the backward half already runs towards the end
+    IdQueue* hops = &ctx->queue;
+    idQueue_clear(hops);
+    for(uint32_t v = meet; v != NO_PARENT; v = ctx->parents[v])
+        idQueue_push(hops, v);
+    for(uint32_t i = 0, j = hops->len - 1; i < j; i++, j--)
+    {
+        uint32_t temp = hops->items[i];
+        hops->items[i] = hops->items[j];
+        hops->items[j] = temp;
+    }
+    for(uint32_t v = ctx->back_parents[meet]; v != NO_PARENT; v = ctx->back_parents[v])
+        idQueue_push(hops, v);
+
+    // unpack with a stack of (from, to) pairs, the first connection of the path
+    // is on top and a shortcut is replaced by the two connections it skips
+    IdStack* pending = &ctx->stack;
+    idStack_clear(pending);
+    for(uint32_t i = hops->len - 1; i > 0; i--)
+    {
+        idStack_push(pending, hops->items[i]);
+        idStack_push(pending, hops->items[i - 1]);
+    }
+
+    uint32_t from = 0, to = 0;
+    searchContext_visit(ctx, start, NO_PARENT, 0);
+    while(idStack_pop(pending, &from))
+    {
+        idStack_pop(pending, &to);
+        const CHEdge* edge = contractionHierarchy_findEdge(ch, from, to);
+        if(edge->middle == NO_PARENT)
+        {
+            searchContext_visit(ctx, to, from, ctx->g_scores[from] + edge->weight);
+        }
+        else
+        {
+            idStack_push(pending, to);
+            idStack_push(pending, edge->middle);
+            idStack_push(pending, edge->middle);
+            idStack_push(pending, from);
+        }
+    }
+}
+
+/// @brief Contraction hierarchy search of a graph, needs graph->ch to be built
+///        with contractionHierarchy_build and uses bidirectionalAStar otherwise
+/// @param graph the graph to search
+/// @param ctx the search context to keep the query state in
+/// @param start the id of the city you wish to start at
+/// @param end the id of the city you wish to end at
+/// @return true if a path was found, it is left in the context for path_read
+bool contractionHierarchySearch_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    const ContractionHierarchy* ch = graph->ch;
+    if(ch == NULL)
+        return bidirectionalAStar_run(graph, ctx, start, end);
+
+    searchContext_enableBackward(ctx);
+    searchContext_begin(ctx);
+    searchContext_visit(ctx, start, NO_PARENT, 0);
+    if(start == end)
+        return true;
+    searchContext_visitBack(ctx, end, NO_PARENT, 0);
+
+    SearchSide forward = searchSide_get(ctx, false, start, end);
+    SearchSide backward = searchSide_get(ctx, true, start, end);
+    iheap_push(forward.heap, start, 0);
+    iheap_push(backward.heap, end, 0);
+
+    uint32_t best_cost = UINT32_MAX, meet = NO_PARENT;
+    while(true)
+    {
+        uint32_t top_forward = forward.heap->size ? forward.heap->entries[0].score : UINT32_MAX;
+        uint32_t top_backward = backward.heap->size ? backward.heap->entries[0].score : UINT32_MAX;
+
+        // neither upward search can improve on the best meeting point any more
+        if(top_forward >= best_cost && top_backward >= best_cost)break;
+
+        // the forward search climbs the up connections, the backward search
+        // climbs the connections coming down into each city in reverse
+        bool expand_backward = top_backward < top_forward;
+        SearchSide* side = expand_backward ? &backward : &forward;
+        SearchSide* other = expand_backward ? &forward : &backward;
+        const uint32_t* offsets = expand_backward ? ch->down_offsets : ch->up_offsets;
+        const CHEdge* edges = expand_backward ? ch->down_edges : ch->up_edges;
+        const uint32_t* stall_offsets = expand_backward ? ch->up_offsets : ch->down_offsets;
+        const CHEdge* stall_edges = expand_backward ? ch->up_edges : ch->down_edges;
+
+        uint32_t current = 0;
+        uint64_t currentCost = 0;
+        iheap_pop(side->heap, &current, &currentCost);
+        SEARCH_STAT(ctx, popped, 1);
+
+        // stall on demand, if a higher ranked city this side has already reached
+        // offers a shorter way into the current city then the upward search
+        // reached it by a path that is not shortest and need not go on from it
+        bool stalled = false;
+        for(uint32_t i = stall_offsets[current]; i < stall_offsets[current + 1] && !stalled; i++)
+        {
+            uint32_t higher = stall_edges[i].node;
+            stalled = side->stamps[higher] == ctx->generation && side->g_scores[higher] + stall_edges[i].weight < currentCost;
+        }
+        if(stalled)
+        {
+            SEARCH_STAT(ctx, stalled, 1);
+            continue;
+        }
+        SEARCH_TRACE(ctx, expand_backward ? SEARCH_TRACE_EXPAND_BACKWARD : SEARCH_TRACE_EXPAND, current, currentCost);
+
+        for(uint32_t i = offsets[current]; i < offsets[current + 1]; i++)
+        {
+            uint32_t connected = edges[i].node;
+            uint32_t new_cost = currentCost + edges[i].weight;
+            SEARCH_STAT(ctx, relaxed, 1);
+
+            if(side->stamps[connected] == ctx->generation)
+            {
+                if(!iheap_contains(side->heap, connected) || side->g_scores[connected] <= new_cost)continue;
+                side->parents[connected] = current;
+                side->g_scores[connected] = new_cost;
+                iheap_decreaseKey(side->heap, connected, new_cost);
+                SEARCH_STAT(ctx, decrease_keys, 1);
+            }
+            else
+            {
+                side->stamps[connected] = ctx->generation;
+                side->parents[connected] = current;
+                side->g_scores[connected] = new_cost;
+                iheap_push(side->heap, connected, new_cost);
+                SEARCH_STAT(ctx, pushed, 1);
+                SEARCH_STAT_FRONTIER(ctx, forward.heap->size + backward.heap->size);
+            }
+
+            if(other->stamps[connected] == ctx->generation && new_cost + other->g_scores[connected] < best_cost)
+            {
+                best_cost = new_cost + other->g_scores[connected];
+                meet = connected;
+            }
+        }
+    }
+
+    if(meet == NO_PARENT)
+        return false;
+    contractionHierarchy_unpack(ch, ctx, start, meet);
+    return true;
+}
+
+/// @brief contractionHierarchySearch_run followed by walkBack, for callers that want a list of cities
+/// @return a list of cities in the order of the path found, NULL if there is none
+City** contractionHierarchySearch(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    return contractionHierarchySearch_run(graph, ctx, start, end) ? walkBack(graph, ctx, start, end) : NULL;
+}
@@ -0,0 +1,40 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "graph.h"
+#include "search_context.h"
+
+// a connection in the hierarchy, shortcuts remember the city they skip over
+typedef struct ch_edge{
+    uint32_t node; // the city at the other end of the connection
+    uint32_t weight; // the length of the connection
+    uint32_t middle; // the contracted city a shortcut replaces, NO_PARENT for original connections
+} CHEdge;
+
+// a growable list of hierarchy connections
+typedef struct ch_edge_list{
+    CHEdge* edges;
+    uint32_t len;
+    uint32_t capacity;
+} CHEdgeList;
+
+struct contraction_hierarchy{
+    uint32_t num_nodes; // the number of cities in the hierarchy
+    uint32_t num_shortcuts; // the number of shortcuts preprocessing added
+    uint32_t* rank; // the position of each city in the contraction order
+    uint32_t* by_rank; // the cities from the highest rank down
+    uint32_t* up_offsets; // up_edges[up_offsets[v]] to up_edges[up_offsets[v + 1]]
+    CHEdge* up_edges; // connections from v to higher ranked cities
+    uint32_t* down_offsets; // down_edges[down_offsets[v]] to down_edges[down_offsets[v + 1]]
+    CHEdge* down_edges; // connections into v from higher ranked cities
+};
+
+void chEdgeList_add(CHEdgeList* list, CHEdge edge);
+ContractionHierarchy* contractionHierarchy_build(const Graph* graph);
+void contractionHierarchy_free(ContractionHierarchy* ch);
+bool contractionHierarchySearch_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+City** contractionHierarchySearch(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+
+#endif
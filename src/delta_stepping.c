@@ -0,0 +1,276 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "delta_stepping.h"
+#include "containers.h"
+#include "graph.h"
+#include "search_context.h"
+#include "thread_pool.h"
+
+// Shortest paths from one city to every city across the workers of a thread
+// pool. Tentative distances are sorted into buckets of width delta and the
+// buckets are settled in order, every city in the lowest bucket is expanded
+// in parallel rather than one heap pop at a time. Connections no longer than
+// delta can lead back into the bucket being settled, so they are relaxed in
+// rounds until the bucket stays empty, longer ones always lead to a later
+// bucket and are relaxed once from every city the bucket settled. A distance
+// and its parent are packed into one 64 bit word so a single compare and swap
+// lowers both, the result is the same distances as a sequential Dijkstra
+#define DELTA_STEPPING_CHUNK 256 // cities claimed by a worker at a time
+#define DELTA_STEPPING_UNREACHED UINT64_MAX
+
+/// @brief creates a delta stepping search with its own worker threads
+/// @param graph the graph to search
+/// @param num_workers the number of workers, 0 uses one per online core
+/// @param delta the width of a bucket, 0 uses the average length of the open connections.
+///        Small buckets do less wasted work, large ones have more parallel work per round
+/// @return a new search, free it with deltaStepping_free
+DeltaStepping* deltaStepping_create(const Graph* graph, uint32_t num_workers, uint32_t delta)
+{
+    DeltaStepping* ds = (DeltaStepping*)calloc(1, sizeof(DeltaStepping));
+    if(ds == NULL)
+    {
+        perror("unable to calloc delta stepping");
+        exit(0);
+    }
+    uint32_t len = graph->num_nodes ? graph->num_nodes : 1;
+    if(delta == 0)
+    {
+        uint64_t total = 0;
+        uint32_t open = 0;
+        for(uint32_t i = 0; i < graph->num_edges; i++)
+        {
+            if(graph->weights[i] == CONNECTION_CLOSED)continue;
+            total += graph->weights[i];
+            open++;
+        }
+        delta = open ? (uint32_t)(total / open) : 1;
+    }
+    ds->graph = graph;
+    ds->delta = delta ? delta : 1;
+    ds->pool = threadPool_create(num_workers);
+    ds->state = (_Atomic uint64_t*)malloc(len * sizeof(uint64_t));
+    ds->settled_in = (_Atomic uint32_t*)malloc(len * sizeof(uint32_t));
+    ds->settled = (uint32_t*)malloc(len * sizeof(uint32_t));
+    ds->workers = (DeltaSteppingWorker*)aligned_alloc(64, ds->pool->num_workers * sizeof(DeltaSteppingWorker));
+    if(!ds->state || !ds->settled_in || !ds->settled || !ds->workers)
+    {
+        perror("unable to allocate delta stepping arrays");
+        exit(0);
+    }
+    memset(ds->workers, 0, ds->pool->num_workers * sizeof(DeltaSteppingWorker));
+    return ds;
+}
+
+/// @brief claims the next chunk of the cities of the current round
+/// @return false once everything has been claimed
+static bool deltaStepping_claim(DeltaStepping* ds, uint32_t limit, uint32_t* begin, uint32_t* end)
+{
+    uint32_t claimed = atomic_fetch_add_explicit(&ds->next_claim, DELTA_STEPPING_CHUNK, memory_order_relaxed);
+    if(claimed >= limit)return false;
+    *begin = claimed;
+    *end = claimed + DELTA_STEPPING_CHUNK < limit ? claimed + DELTA_STEPPING_CHUNK : limit;
+    return true;
+}
+
+/// @brief lowers the distance of a city if the new one is shorter and puts
+///        the city in the bin of its new bucket
+static inline void deltaStepping_relax(DeltaStepping* ds, DeltaSteppingWorker* worker, uint32_t node, uint32_t parent, uint32_t dist)
+{
+    uint64_t desired = (uint64_t)dist << 32 | parent;
+    uint64_t current = atomic_load_explicit(&ds->state[node], memory_order_relaxed);
+    do
+    {
+        if((current >> 32) <= dist)return;
+    }
+    while(!atomic_compare_exchange_weak_explicit(&ds->state[node], &current, desired, memory_order_relaxed, memory_order_relaxed));
+
+    uint32_t bucket = dist / ds->delta;
+    if(bucket >= worker->num_bins)
+    {
+        uint32_t num_bins = worker->num_bins ? worker->num_bins : 64;
+        while(num_bins <= bucket)num_bins *= 2;
+        IdStack* bins = (IdStack*)realloc(worker->bins, num_bins * sizeof(IdStack));
+        if(bins == NULL)
+        {
+            perror("unable to realloc delta stepping bins");
+            exit(0);
+        }
+        memset(bins + worker->num_bins, 0, (num_bins - worker->num_bins) * sizeof(IdStack));
+        worker->bins = bins;
+        worker->num_bins = num_bins;
+    }
+    idStack_push(&worker->bins[bucket], node);
+}
+
+/// @brief the pool task that forgets the previous search
+static void deltaStepping_clear(void* arg, uint32_t worker)
+{
+    DeltaStepping* ds = (DeltaStepping*)arg;
+    uint32_t begin = 0, end = 0;
+    (void)worker;
+    while(deltaStepping_claim(ds, ds->graph->num_nodes, &begin, &end))
+    {
+        for(uint32_t v = begin; v < end; v++)
+        {
+            atomic_store_explicit(&ds->state[v], DELTA_STEPPING_UNREACHED, memory_order_relaxed);
+            atomic_store_explicit(&ds->settled_in[v], 0, memory_order_relaxed);
+        }
+    }
+}
+
+/// @brief the pool task that expands the frontier along its short connections
+static void deltaStepping_light(void* arg, uint32_t worker)
+{
+    DeltaStepping* ds = (DeltaStepping*)arg;
+    DeltaSteppingWorker* self = &ds->workers[worker];
+    const Graph* graph = ds->graph;
+    uint32_t begin = 0, end = 0;
+    while(deltaStepping_claim(ds, ds->frontier.len, &begin, &end))
+    {
+        for(uint32_t f = begin; f < end; f++)
+        {
+            uint32_t v = ds->frontier.items[f];
+            uint32_t dist = (uint32_t)(atomic_load_explicit(&ds->state[v], memory_order_relaxed) >> 32);
+
+            // a city left in a bin it has since moved out of is skipped, and
+            // one listed twice is only settled once
+            if(dist / ds->delta != ds->bucket)continue;
+            if(atomic_exchange_explicit(&ds->settled_in[v], ds->bucket + 1, memory_order_relaxed) != ds->bucket + 1)
+                ds->settled[atomic_fetch_add_explicit(&ds->settled_len, 1, memory_order_relaxed)] = v;
+
+            for(uint32_t i = graph->offsets[v]; i < graph->offsets[v + 1]; i++)
+            {
+                if(graph->weights[i] <= ds->delta)
+                    deltaStepping_relax(ds, self, graph->targets[i], v, dist + graph->weights[i]);
+            }
+        }
+    }
+}
+
+/// @brief the pool task that relaxes the long connections of the settled bucket
+static void deltaStepping_heavy(void* arg, uint32_t worker)
+{
+    DeltaStepping* ds = (DeltaStepping*)arg;
+    DeltaSteppingWorker* self = &ds->workers[worker];
+    const Graph* graph = ds->graph;
+    uint32_t begin = 0, end = 0;
+    while(deltaStepping_claim(ds, ds->settled_len, &begin, &end))
+    {
+        for(uint32_t s = begin; s < end; s++)
+        {
+            uint32_t v = ds->settled[s];
+            uint32_t dist = (uint32_t)(atomic_load_explicit(&ds->state[v], memory_order_relaxed) >> 32);
+            for(uint32_t i = graph->offsets[v]; i < graph->offsets[v + 1]; i++)
+            {
+                if(graph->weights[i] > ds->delta && graph->weights[i] != CONNECTION_CLOSED)
+                    deltaStepping_relax(ds, self, graph->targets[i], v, dist + graph->weights[i]);
+            }
+        }
+    }
+}
+
+/// @brief the pool task that unpacks the distances and parents for the caller
+static void deltaStepping_copy(void* arg, uint32_t worker)
+{
+    DeltaStepping* ds = (DeltaStepping*)arg;
+    uint32_t begin = 0, end = 0;
+    (void)worker;
+    while(deltaStepping_claim(ds, ds->graph->num_nodes, &begin, &end))
+    {
+        for(uint32_t v = begin; v < end; v++)
+        {
+            uint64_t state = atomic_load_explicit(&ds->state[v], memory_order_relaxed);
+            ds->dist[v] = (uint32_t)(state >> 32);
+            if(ds->parents)
+                ds->parents[v] = (uint32_t)state;
+        }
+    }
+}
+
+/// @brief moves every worker's bin of the current bucket into the frontier
+/// @return false if the bucket is empty
+static bool deltaStepping_gather(DeltaStepping* ds)
+{
+    idStack_clear(&ds->frontier);
+    for(uint32_t w = 0; w < ds->pool->num_workers; w++)
+    {
+        DeltaSteppingWorker* worker = &ds->workers[w];
+        if(ds->bucket >= worker->num_bins)continue;
+        IdStack* bin = &worker->bins[ds->bucket];
+        for(uint32_t i = 0; i < bin->len; i++)
+            idStack_push(&ds->frontier, bin->items[i]);
+        idStack_clear(bin);
+    }
+    return ds->frontier.len > 0;
+}
+
+/// @brief the distance from one city to every city of a graph
+/// @param ds the search to run
+/// @param source the city to measure from
+/// @param dist filled with num_nodes distances, DISTANCE_UNREACHABLE where there is no path
+/// @param parents filled with the city each city is reached from on a shortest
+///        path, NO_PARENT for the source and unreached cities, may be NULL
+void deltaStepping_run(DeltaStepping* ds, uint32_t source, uint32_t* dist, uint32_t* parents)
+{
+    atomic_store(&ds->next_claim, 0);
+    threadPool_run(ds->pool, deltaStepping_clear, ds);
+    ds->bucket = 0;
+    deltaStepping_relax(ds, &ds->workers[0], source, NO_PARENT, 0);
+
+    while(true)
+    {
+        // settle the bucket, short connections can refill it so keep going until it stays empty
+        atomic_store(&ds->settled_len, 0);
+        while(deltaStepping_gather(ds))
+        {
+            atomic_store(&ds->next_claim, 0);
+            threadPool_run(ds->pool, deltaStepping_light, ds);
+        }
+        atomic_store(&ds->next_claim, 0);
+        threadPool_run(ds->pool, deltaStepping_heavy, ds);
+
+        // move on to the lowest bucket any worker has cities in
+        uint32_t next = UINT32_MAX;
+        for(uint32_t w = 0; w < ds->pool->num_workers; w++)
+        {
+            DeltaSteppingWorker* worker = &ds->workers[w];
+            for(uint32_t b = ds->bucket + 1; b < worker->num_bins && b < next; b++)
+            {
+                if(worker->bins[b].len > 0)
+                {
+                    next = b;
+                    break;
+                }
+            }
+        }
+        if(next == UINT32_MAX)break;
+        ds->bucket = next;
+    }
+
+    ds->dist = dist;
+    ds->parents = parents;
+    atomic_store(&ds->next_claim, 0);
+    threadPool_run(ds->pool, deltaStepping_copy, ds);
+}
+
+/// @brief stops the workers and releases the search, the graph is not freed
+void deltaStepping_free(DeltaStepping* ds)
+{
+    for(uint32_t w = 0; w < ds->pool->num_workers; w++)
+    {
+        for(uint32_t b = 0; b < ds->workers[w].num_bins; b++)
+            idStack_free(&ds->workers[w].bins[b]);
+        free(ds->workers[w].bins);
+    }
+    threadPool_free(ds->pool);
+    free(ds->workers);
+    free((void*)ds->state);
+    free((void*)ds->settled_in);
+    free(ds->settled);
+    idStack_free(&ds->frontier);
+    free(ds);
+}
@@ -0,0 +1,37 @@
+#ifndef DELTA_STEPPING_H
+#define DELTA_STEPPING_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "containers.h"
+#include "graph.h"
+#include "thread_pool.h"
+
+// the buckets one worker has moved cities into, padded so workers do not share a cache line
+typedef struct delta_stepping_worker{
+    IdStack* bins; // bins[b] holds cities this worker gave a distance in bucket b, some may have moved on since
+    uint32_t num_bins;
+    char padding[52];
+} DeltaSteppingWorker;
+
+typedef struct delta_stepping{
+    const Graph* graph; // the graph being searched
+    ThreadPool* pool; // the workers
+    uint32_t delta; // the width of a bucket
+    _Atomic uint64_t* state; // the distance of each city in the high half and its parent in the low half
+    _Atomic uint32_t* settled_in; // the bucket each city was last settled in plus one, 0 for none yet
+    DeltaSteppingWorker* workers; // one per worker
+    IdStack frontier; // the cities of the current bucket to expand this round
+    uint32_t* settled; // the cities the current bucket has settled, for the long connections
+    _Atomic uint32_t settled_len;
+    _Atomic uint32_t next_claim; // the first city of the round not yet claimed
+    uint32_t bucket; // the bucket being settled
+    uint32_t* dist; // where the run copies its distances to
+    uint32_t* parents; // where the run copies its parents to, may be NULL
+} DeltaStepping;
+
+DeltaStepping* deltaStepping_create(const Graph* graph, uint32_t num_workers, uint32_t delta);
+void deltaStepping_run(DeltaStepping* ds, uint32_t source, uint32_t* dist, uint32_t* parents);
+void deltaStepping_free(DeltaStepping* ds);
+
+#endif
@@ -0,0 +1,191 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "distance_table.h"
+#include "containers.h"
+#include "graph.h"
+#include "search_context.h"
+#include "landmarks.h"
+#include "contraction_hierarchy.h"
+
+/// @brief a Dijkstra over the connections to higher ranked cities with stall
+///        on demand, the cities it settles without stalling are left in
+///        ctx->queue in settling order with their distances in ctx->g_scores
+/// @param ch the hierarchy to search
+/// @param ctx the context to search in, a new query is started
+/// @param origin the city to search from
+/// @param backward true to search the connections coming down into each city
+///        in reverse, which gives distances to the origin instead of from it
+static void distanceTable_upward(const ContractionHierarchy* ch, SearchContext* ctx, uint32_t origin, bool backward)
+{
+    const uint32_t* offsets = backward ? ch->down_offsets : ch->up_offsets;
+    const CHEdge* edges = backward ? ch->down_edges : ch->up_edges;
+    const uint32_t* stall_offsets = backward ? ch->up_offsets : ch->down_offsets;
+    const CHEdge* stall_edges = backward ? ch->up_edges : ch->down_edges;
+    IHeap* heap = &ctx->heap;
+
+    searchContext_begin(ctx);
+    searchContext_visit(ctx, origin, NO_PARENT, 0);
+    iheap_push(heap, origin, 0);
+
+    uint32_t current = 0;
+    uint64_t currentCost = 0;
+    while(iheap_pop(heap, &current, &currentCost))
+    {
+        SEARCH_STAT(ctx, popped, 1);
+        bool stalled = false;
+        for(uint32_t i = stall_offsets[current]; i < stall_offsets[current + 1] && !stalled; i++)
+        {
+            uint32_t higher = stall_edges[i].node;
+            stalled = searchContext_visited(ctx, higher) && ctx->g_scores[higher] + stall_edges[i].weight < currentCost;
+        }
+        if(stalled)
+        {
+            SEARCH_STAT(ctx, stalled, 1);
+            continue;
+        }
+        idQueue_push(&ctx->queue, current);
+
+        for(uint32_t i = offsets[current]; i < offsets[current + 1]; i++)
+        {
+            uint32_t connected = edges[i].node;
+            uint32_t new_cost = currentCost + edges[i].weight;
+            SEARCH_STAT(ctx, relaxed, 1);
+            if(searchContext_visited(ctx, connected))
+            {
+                if(!iheap_contains(heap, connected) || ctx->g_scores[connected] <= new_cost)continue;
+                searchContext_visit(ctx, connected, current, new_cost);
+                iheap_decreaseKey(heap, connected, new_cost);
+                SEARCH_STAT(ctx, decrease_keys, 1);
+            }
+            else
+            {
+                searchContext_visit(ctx, connected, current, new_cost);
+                iheap_push(heap, connected, new_cost);
+                SEARCH_STAT(ctx, pushed, 1);
+                SEARCH_STAT_FRONTIER(ctx, heap->size);
+            }
+        }
+    }
+}
+
+/// @brief the distance from one city to every city of a graph
+/// @param graph the graph to search, uses PHAST when graph->ch is built
+/// @param ctx the search context to use as scratch space
+/// @param source the city to measure from
+/// @param dist filled with num_nodes distances, DISTANCE_UNREACHABLE where there is no path
+void distanceTable_oneToAll(const Graph* graph, SearchContext* ctx, uint32_t source, uint32_t* dist)
+{
+    const ContractionHierarchy* ch = graph->ch;
+    if(ch == NULL)
+    {
+        landmarks_dijkstra(graph->num_nodes, graph->offsets, graph->targets, graph->weights, source, dist, &ctx->heap);
+        return;
+    }
+
+    // every shortest path climbs to its highest city and then only descends,
+    // the upward search finds the climb and the sweep finds the descent since
+    // each city is only swept after all the higher cities that lead down into it
+    for(uint32_t v = 0; v < graph->num_nodes; v++)
+        dist[v] = DISTANCE_UNREACHABLE;
+    distanceTable_upward(ch, ctx, source, false);
+    uint32_t settled = 0;
+    while(idQueue_pop(&ctx->queue, &settled))
+        dist[settled] = ctx->g_scores[settled];
+
+    for(uint32_t r = 0; r < ch->num_nodes; r++)
+    {
+        uint32_t v = ch->by_rank[r], best = dist[v];
+        for(uint32_t i = ch->down_offsets[v]; i < ch->down_offsets[v + 1]; i++)
+        {
+            uint32_t higher = ch->down_edges[i].node;
+            if(dist[higher] != DISTANCE_UNREACHABLE && dist[higher] + ch->down_edges[i].weight < best)
+                best = dist[higher] + ch->down_edges[i].weight;
+        }
+        dist[v] = best;
+    }
+}
+
+/// @brief the distance from every source to every target
+/// @param graph the graph to search, uses the bucket method when graph->ch is
+///        built and one one to all query per source otherwise
+/// @param ctx the search context to use as scratch space
+/// @param sources the cities to measure from
+/// @param num_sources the number of sources
+/// @param targets the cities to measure to
+/// @param num_targets the number of targets
+/// @param table filled with num_sources rows of num_targets distances,
+///        DISTANCE_UNREACHABLE where there is no path
+void distanceTable_manyToMany(const Graph* graph, SearchContext* ctx, const uint32_t* sources, uint32_t num_sources,
+    const uint32_t* targets, uint32_t num_targets, uint32_t* table)
+{
+    for(size_t c = 0; c < (size_t)num_sources * num_targets; c++)
+        table[c] = DISTANCE_UNREACHABLE;
+
+    const ContractionHierarchy* ch = graph->ch;
+    if(ch == NULL)
+    {
+        uint32_t* dist = (uint32_t*)malloc((graph->num_nodes ? graph->num_nodes : 1) * sizeof(uint32_t));
+        if(dist == NULL)
+        {
+            perror("unable to malloc distance row");
+            exit(0);
+        }
+        for(uint32_t s = 0; s < num_sources; s++)
+        {
+            distanceTable_oneToAll(graph, ctx, sources[s], dist);
+            for(uint32_t t = 0; t < num_targets; t++)
+                table[(size_t)s * num_targets + t] = dist[targets[t]];
+        }
+        free(dist);
+        return;
+    }
+
+    // each backward search leaves (city, target column, distance to the target)
+    // entries, which are then grouped by city with a counting sort
+    EdgeList entries = {0};
+    uint32_t current = 0;
+    for(uint32_t t = 0; t < num_targets; t++)
+    {
+        distanceTable_upward(ch, ctx, targets[t], true);
+        while(idQueue_pop(&ctx->queue, &current))
+            edgeList_add(&entries, current, t, ctx->g_scores[current]);
+    }
+    uint32_t* bucket_offsets = (uint32_t*)calloc((size_t)ch->num_nodes + 1, sizeof(uint32_t));
+    Edge* buckets = (Edge*)malloc((entries.len ? entries.len : 1) * sizeof(Edge));
+    if(!bucket_offsets || !buckets)
+    {
+        perror("unable to allocate distance table buckets");
+        exit(0);
+    }
+    for(uint32_t i = 0; i < entries.len; i++)
+        bucket_offsets[entries.edges[i].from + 1]++;
+    for(uint32_t v = 0; v < ch->num_nodes; v++)
+        bucket_offsets[v + 1] += bucket_offsets[v];
+    for(uint32_t i = 0; i < entries.len; i++)
+        buckets[bucket_offsets[entries.edges[i].from]++] = entries.edges[i];
+    for(uint32_t v = ch->num_nodes; v > 0; v--)
+        bucket_offsets[v] = bucket_offsets[v - 1];
+    bucket_offsets[0] = 0;
+    edgeList_free(&entries);
+
+    // a forward search reaching a city with a bucket completes a path to every target in it
+    for(uint32_t s = 0; s < num_sources; s++)
+    {
+        uint32_t* row = table + (size_t)s * num_targets;
+        distanceTable_upward(ch, ctx, sources[s], false);
+        while(idQueue_pop(&ctx->queue, &current))
+        {
+            uint32_t cost = ctx->g_scores[current];
+            for(uint32_t i = bucket_offsets[current]; i < bucket_offsets[current + 1]; i++)
+            {
+                if(cost + buckets[i].distance < row[buckets[i].to])
+                    row[buckets[i].to] = cost + buckets[i].distance;
+            }
+        }
+    }
+    free(bucket_offsets);
+    free(buckets);
+}
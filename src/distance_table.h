@@ -0,0 +1,23 @@
+#ifndef DISTANCE_TABLE_H
+#define DISTANCE_TABLE_H
+
+#include <stdint.h>
+#include "graph.h"
+#include "search_context.h"
+#include "landmarks.h"
+
+// Travel costs between whole sets of cities at once. Without a contraction
+// hierarchy a one to all query is a Dijkstra into a flat distance array, with
+// one it is a PHAST query, a short upward search followed by a single sweep
+// over every city from the highest rank down. Many to many tables use the
+// bucket method, an upward search from each target leaves its distance at
+// every city it settles and an upward search from each source reads what was
+// left at the cities it settles, so the searches never leave the small upward
+// part of the hierarchy around their own city
+#define DISTANCE_UNREACHABLE LANDMARK_UNREACHABLE
+
+void distanceTable_oneToAll(const Graph* graph, SearchContext* ctx, uint32_t source, uint32_t* dist);
+void distanceTable_manyToMany(const Graph* graph, SearchContext* ctx, const uint32_t* sources, uint32_t num_sources,
+    const uint32_t* targets, uint32_t num_targets, uint32_t* table);
+
+#endif
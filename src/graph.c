@@ -0,0 +1,362 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/mman.h>
+#include "graph.h"
+#include "landmarks.h"
+#include "spatial_index.h"
+#include "contraction_hierarchy.h"
+
+/// @brief an initializer function for a city struct
+/// @param name the name of the city
+/// @param dist the straight distance to Bucharest
+/// @return a city struct with the given data
+City createCity(char* name, uint16_t dist)
+{
+    City res = {0};
+    res.straight_distance = dist;
+    res.name = name;
+    return res;
+}
+
+/// @brief a function to search an array for a city of a specific name
+/// @param name name of the target city 
+/// @param city_list a list of cities
+/// @param list_len the length of the list of cities
+/// @return the index of the city in the list
+uint32_t getCity(char* name, City city_list[], uint32_t list_len)
+{
+    for(uint32_t i = 0; i < list_len; i++)
+    {
+        if(strcmp(name, city_list[i].name) == 0)
+            return i;
+    }
+    printf("Could not find city %s\n", name);
+    exit(1);
+}
+
+/// @brief adds a one way connection to an edge list
+/// @param list the list to add to
+/// @param from the index of the city the connection starts at
+/// @param to the index of the city the connection goes to
+/// @param dist the distance of the connection
+void edgeList_add(EdgeList* list, uint32_t from, uint32_t to, uint32_t dist)
+{
+    if(list->len == list->capacity)
+    {
+        uint32_t new_capacity = list->capacity ? list->capacity * 2 : 64;
+        Edge* edges = (Edge*)realloc(list->edges, new_capacity * sizeof(Edge));
+        if(edges == NULL)
+        {
+            perror("unable to realloc edge list");
+            exit(0);
+        }
+        list->edges = edges;
+        list->capacity = new_capacity;
+    }
+    list->edges[list->len++] = (Edge){from, to, dist};
+}
+
+/// @brief makes room for at least capacity edges so a list of known size
+///        is allocated once instead of grown by doubling
+/// @param list the list to reserve space in
+/// @param capacity the number of edges the list should hold
+void edgeList_reserve(EdgeList* list, uint32_t capacity)
+{
+    if(capacity <= list->capacity)
+        return;
+    Edge* edges = (Edge*)realloc(list->edges, capacity * sizeof(Edge));
+    if(edges == NULL)
+    {
+        perror("unable to realloc edge list");
+        exit(0);
+    }
+    list->edges = edges;
+    list->capacity = capacity;
+}
+
+/// @brief releases the memory held by an edge list
+void edgeList_free(EdgeList* list)
+{
+    free(list->edges);
+    *list = (EdgeList){0};
+}
+
+/// @brief wraps arrays already in compressed sparse row form in a graph
+/// @param cities the cities of the graph, the graph takes ownership of the
+///        malloced array and frees it in graph_free
+/// @param num_nodes the number of cities
+/// @param offsets num_nodes + 1 offsets into targets and weights, taken over like cities
+/// @param targets the city each connection goes to, taken over like cities
+/// @param weights the length of each connection, taken over like cities
+/// @return a newly allocated graph, free it with graph_free
+Graph* graph_buildCsr(City* cities, uint32_t num_nodes, uint32_t* offsets, uint32_t* targets, uint32_t* weights)
+{
+    Graph* graph = (Graph*)calloc(1, sizeof(Graph));
+    if(graph == NULL)
+    {
+        perror("unable to calloc graph");
+        exit(0);
+    }
+    graph->num_nodes = num_nodes;
+    graph->num_edges = offsets[num_nodes];
+    graph->offsets = offsets;
+    graph->targets = targets;
+    graph->weights = weights;
+    graph->cities = cities;
+    graph->asymmetric = graph_countAsymmetric(graph);
+    return graph;
+}
+
+/// @brief builds a graph from a list of cities and the connections between them,
+///        connections keep the order they were added in for each city
+/// @param cities the cities of the graph, the graph takes ownership of the
+///        malloced array and frees it in graph_free
+/// @param num_nodes the number of cities
+/// @param list the connections between the cities
+/// @return a newly allocated graph, free it with graph_free
+Graph* graph_buildOwned(City* cities, uint32_t num_nodes, const EdgeList* list)
+{
+    uint32_t* offsets = (uint32_t*)calloc(num_nodes + 1, sizeof(uint32_t));
+    uint32_t* targets = (uint32_t*)malloc((list->len ? list->len : 1) * sizeof(uint32_t));
+    uint32_t* weights = (uint32_t*)malloc((list->len ? list->len : 1) * sizeof(uint32_t));
+    if(!offsets || !targets || !weights)
+    {
+        perror("unable to allocate graph arrays");
+        exit(0);
+    }
+
+    // count the degree of each city, then turn the counts into offsets
+    for(uint32_t i = 0; i < list->len; i++)
+        offsets[list->edges[i].from + 1]++;
+    for(uint32_t v = 0; v < num_nodes; v++)
+        offsets[v + 1] += offsets[v];
+
+    // place every edge in its cities range, offsets[v] is used as the
+    // insert cursor and is shifted back into place afterwards
+    for(uint32_t i = 0; i < list->len; i++)
+    {
+        uint32_t slot = offsets[list->edges[i].from]++;
+        targets[slot] = list->edges[i].to;
+        weights[slot] = list->edges[i].distance;
+    }
+    for(uint32_t v = num_nodes; v > 0; v--)
+        offsets[v] = offsets[v - 1];
+    offsets[0] = 0;
+    return graph_buildCsr(cities, num_nodes, offsets, targets, weights);
+}
+
+/// @brief builds a graph from a list of cities and the connections between them,
+///        connections keep the order they were added in for each city
+/// @param cities the cities of the graph, copied into the graph
+/// @param num_nodes the number of cities
+/// @param list the connections between the cities
+/// @return a newly allocated graph, free it with graph_free
+Graph* graph_build(const City* cities, uint32_t num_nodes, const EdgeList* list)
+{
+    City* copy = (City*)malloc((num_nodes ? num_nodes : 1) * sizeof(City));
+    if(copy == NULL)
+    {
+        perror("unable to malloc graph cities");
+        exit(0);
+    }
+    memcpy(copy, cities, num_nodes * sizeof(City));
+    return graph_buildOwned(copy, num_nodes, list);
+}
+
+/// @brief the cheapest open connection from one city to another
+/// @return its length or CONNECTION_CLOSED if there is none
+static uint32_t graph_cheapest(const Graph* graph, uint32_t from, uint32_t to)
+{
+    uint32_t best = CONNECTION_CLOSED;
+    for(uint32_t i = graph->offsets[from]; i < graph->offsets[from + 1]; i++)
+    {
+        if(graph->targets[i] == to && graph->weights[i] < best)best = graph->weights[i];
+    }
+    return best;
+}
+
+/// @brief changes the length of the connections from one city to another in
+///        place, searches started afterwards travel the new length. The
+///        contraction hierarchy is dropped because its shortcuts add up the old
+///        lengths, rebuild it once the updates settle down
+/// @param graph the graph to change
+/// @param from the id of the city the connections start at
+/// @param to the id of the city the connections go to
+/// @param weight the new length or CONNECTION_CLOSED to close the road. It may
+///        not be shorter than the length the graph was built with, the straight
+///        line and landmark heuristics are measured over those lengths and stay
+///        consistent through any later change as long as they are the floor
+/// @return false if there is no such connection, the length is too short or
+///        the graph is being searched from other threads
+bool graph_setWeight(Graph* graph, uint32_t from, uint32_t to, uint32_t weight)
+{
+    // the weights array is swapped and the hierarchy freed without a lock,
+    // changes have to wait until every batch and server let go of the graph
+    if(atomic_load_explicit(&graph->searchers, memory_order_acquire))return false;
+    const uint32_t* base = graph->base_weights ? graph->base_weights : graph->weights;
+    bool found = false;
+    for(uint32_t i = graph->offsets[from]; i < graph->offsets[from + 1]; i++)
+    {
+        if(graph->targets[i] != to)continue;
+        if(weight < base[i])return false;
+        found = true;
+    }
+    if(!found)return false;
+
+    // the weights the graph was built with are kept, as the floor for later
+    // changes and because a mapped graph file cannot be written to
+    if(graph->base_weights == NULL)
+    {
+        uint32_t* weights = (uint32_t*)malloc((graph->num_edges ? graph->num_edges : 1) * sizeof(uint32_t));
+        if(weights == NULL)
+        {
+            perror("unable to malloc graph weights");
+            exit(0);
+        }
+        memcpy(weights, graph->weights, graph->num_edges * sizeof(uint32_t));
+        graph->base_weights = graph->weights;
+        graph->weights = weights;
+    }
+    bool was_asymmetric = graph_cheapest(graph, from, to) != graph_cheapest(graph, to, from);
+    for(uint32_t i = graph->offsets[from]; i < graph->offsets[from + 1]; i++)
+    {
+        if(graph->targets[i] == to)
+            graph->weights[i] = weight;
+    }
+    // the pair counts once from each of its cities
+    bool is_asymmetric = graph_cheapest(graph, from, to) != graph_cheapest(graph, to, from);
+    if(is_asymmetric && !was_asymmetric)graph->asymmetric += 2;
+    if(was_asymmetric && !is_asymmetric)graph->asymmetric -= 2;
+    if(graph->ch)
+    {
+        contractionHierarchy_free(graph->ch);
+        graph->ch = NULL;
+    }
+    atomic_fetch_add_explicit(&graph->version, 1, memory_order_release);
+    return true;
+}
+
+/// @brief releases the memory held by a graph
+void graph_free(Graph* graph)
+{
+    // the weights the graph was built with are the ones it allocated or mapped
+    if(graph->base_weights)
+    {
+        free(graph->weights);
+        graph->weights = graph->base_weights;
+    }
+    if(graph->mapping)
+        munmap(graph->mapping, graph->mapping_len);
+    else
+    {
+        free(graph->offsets);
+        free(graph->targets);
+        free(graph->weights);
+    }
+    free(graph->cities);
+    free(graph->names);
+    free(graph->original_ids);
+    free(graph->reordered_ids);
+    if(graph->ch)
+        contractionHierarchy_free(graph->ch);
+    if(graph->landmarks)
+        landmarks_free(graph->landmarks);
+    if(graph->spatial)
+        spatialIndex_free(graph->spatial);
+    free(graph);
+}
+
+/// @brief builds the graph with every connection reversed, the cities are copied
+/// @param graph the graph to reverse
+/// @return a newly allocated graph, free it with graph_free
+Graph* graph_transpose(const Graph* graph)
+{
+    EdgeList reversed = {0};
+    for(uint32_t v = 0; v < graph->num_nodes; v++)
+    {
+        for(uint32_t i = graph->offsets[v]; i < graph->offsets[v + 1]; i++)
+            edgeList_add(&reversed, graph->targets[i], v, graph->weights[i]);
+    }
+    Graph* result = graph_build(graph->cities, graph->num_nodes, &reversed);
+    edgeList_free(&reversed);
+    return result;
+}
+
+/// @brief counts the ordered pairs of cities where the cheapest open connection
+///        one way is not as long as the cheapest open connection back, a
+///        missing or closed connection counting as CONNECTION_CLOSED. A graph
+///        without such pairs can be searched backwards along its connections
+///        as they are stored, which is what the bidirectional searches do
+/// @param graph the graph to check
+/// @return the number of such pairs, 0 for a graph with every connection both ways
+uint32_t graph_countAsymmetric(const Graph* graph)
+{
+    uint32_t n = graph->num_nodes, m = graph->num_edges, len = n ? n : 1;
+    uint32_t* in_offsets = (uint32_t*)calloc(n + 1, sizeof(uint32_t));
+    uint32_t* in_sources = (uint32_t*)malloc((m ? m : 1) * sizeof(uint32_t));
+    uint32_t* in_weights = (uint32_t*)malloc((m ? m : 1) * sizeof(uint32_t));
+    uint32_t* out_best = (uint32_t*)malloc(len * sizeof(uint32_t));
+    uint32_t* in_best = (uint32_t*)malloc(len * sizeof(uint32_t));
+    if(!in_offsets || !in_sources || !in_weights || !out_best || !in_best)
+    {
+        perror("unable to allocate symmetry check");
+        exit(0);
+    }
+
+    // the connections coming into each city, placed the same way graph_buildOwned does
+    for(uint32_t i = 0; i < m; i++)
+        in_offsets[graph->targets[i] + 1]++;
+    for(uint32_t v = 0; v < n; v++)
+        in_offsets[v + 1] += in_offsets[v];
+    for(uint32_t v = 0; v < n; v++)
+    {
+        for(uint32_t i = graph->offsets[v]; i < graph->offsets[v + 1]; i++)
+        {
+            uint32_t slot = in_offsets[graph->targets[i]]++;
+            in_sources[slot] = v;
+            in_weights[slot] = graph->weights[i];
+        }
+    }
+    for(uint32_t v = n; v > 0; v--)
+        in_offsets[v] = in_offsets[v - 1];
+    in_offsets[0] = 0;
+
+    // for every city the cheapest way to each neighbour and back, the scratch
+    // entries go back to CONNECTION_CLOSED as each pair is compared
+    for(uint32_t v = 0; v < n; v++)
+        out_best[v] = in_best[v] = CONNECTION_CLOSED;
+    uint32_t count = 0;
+    for(uint32_t u = 0; u < n; u++)
+    {
+        for(uint32_t i = graph->offsets[u]; i < graph->offsets[u + 1]; i++)
+        {
+            if(graph->weights[i] < out_best[graph->targets[i]])out_best[graph->targets[i]] = graph->weights[i];
+        }
+        for(uint32_t i = in_offsets[u]; i < in_offsets[u + 1]; i++)
+        {
+            if(in_weights[i] < in_best[in_sources[i]])in_best[in_sources[i]] = in_weights[i];
+        }
+        for(uint32_t i = graph->offsets[u]; i < graph->offsets[u + 1]; i++)
+        {
+            uint32_t v = graph->targets[i];
+            if(out_best[v] != in_best[v])count++;
+            out_best[v] = in_best[v] = CONNECTION_CLOSED;
+        }
+        for(uint32_t i = in_offsets[u]; i < in_offsets[u + 1]; i++)
+        {
+            uint32_t v = in_sources[i];
+            if(out_best[v] != in_best[v])count++;
+            out_best[v] = in_best[v] = CONNECTION_CLOSED;
+        }
+    }
+
+    free(in_offsets);
+    free(in_sources);
+    free(in_weights);
+    free(out_best);
+    free(in_best);
+    return count;
+}
@@ -0,0 +1,103 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+typedef struct city City;
+
+/// @brief a struct to store data about a city
+struct city
+{
+    char* name; // the name of the city
+    uint16_t straight_distance; // the straight distance to bucharest
+    int32_t x, y; // planar coordinates of the city, 0 when unknown
+};
+
+// a struct representing a one way connection between two cities by index
+typedef struct edge{
+    uint32_t from; // the index of the city the connection starts at
+    uint32_t to; // the index of the city the connection goes to
+    uint32_t distance; // the length of the connection
+} Edge;
+
+// a growable list of edges the graph is built from
+typedef struct edge_list{
+    Edge* edges;
+    uint32_t len;
+    uint32_t capacity;
+} EdgeList;
+
+// indexes derived from a graph by preprocessing, owned by the graph they index
+typedef struct contraction_hierarchy ContractionHierarchy;
+
+typedef struct landmarks Landmarks;
+
+typedef struct spatial_index SpatialIndex;
+
+// the weight of a closed connection, searches never travel along it
+#define CONNECTION_CLOSED UINT32_MAX
+
+/// @brief a graph in compressed sparse row form, the connections of city v are
+///        targets/weights[offsets[v]] up to offsets[v + 1]. Only the weights
+///        change after the graph is built, through graph_setWeight, and the
+///        numbering of the cities, through graph_renumber. Neither may run while
+///        other threads search the graph, see graph_acquire
+typedef struct graph{
+    uint32_t num_nodes; // the number of cities in the graph
+    uint32_t num_edges; // the number of one way connections in the graph
+    uint32_t* offsets; // num_nodes + 1 offsets into targets/weights
+    uint32_t* targets; // the index of the city each connection goes to
+    uint32_t* weights; // the length of each connection
+    City* cities; // the cities of the graph indexed by node id
+    ContractionHierarchy* ch; // shortcuts for contractionHierarchySearch, NULL until built
+    Landmarks* landmarks; // distance tables for the ALT heuristic, NULL until built
+    SpatialIndex* spatial; // k-d tree over the city coordinates for snapping and the coordinate heuristic, NULL until built
+    void* mapping; // the mapped graph file the arrays point into, NULL when they are allocated
+    char* names; // the string pool the city names point into when the graph owns it, else NULL
+    size_t mapping_len; // the length of the mapping in bytes
+    uint32_t* base_weights; // the weights the graph was built with once weights has been changed, else NULL
+    _Atomic uint64_t version; // counts the changes to the weights and ids, for caches of search results
+    _Atomic uint32_t searchers; // the batches and servers searching the graph from other threads, see graph_acquire
+    uint32_t asymmetric; // ordered pairs of cities whose cheapest open connections differ by direction, see graph_countAsymmetric
+    uint32_t* original_ids; // the id each city had when the graph was built once graph_renumber has run, else NULL
+    uint32_t* reordered_ids; // the current id of each city by the id it was built with, alongside original_ids
+} Graph;
+
+City createCity(char* name, uint16_t dist);
+uint32_t getCity(char* name, City city_list[], uint32_t list_len);
+void edgeList_add(EdgeList* list, uint32_t from, uint32_t to, uint32_t dist);
+void edgeList_reserve(EdgeList* list, uint32_t capacity);
+void edgeList_free(EdgeList* list);
+Graph* graph_buildCsr(City* cities, uint32_t num_nodes, uint32_t* offsets, uint32_t* targets, uint32_t* weights);
+Graph* graph_buildOwned(City* cities, uint32_t num_nodes, const EdgeList* list);
+Graph* graph_build(const City* cities, uint32_t num_nodes, const EdgeList* list);
+bool graph_setWeight(Graph* graph, uint32_t from, uint32_t to, uint32_t weight);
+void graph_free(Graph* graph);
+Graph* graph_transpose(const Graph* graph);
+uint32_t graph_countAsymmetric(const Graph* graph);
+
+/// @brief marks a graph as searched from other threads until graph_release,
+///        graph_setWeight refuses every change in the meantime because the
+///        searches read the weights without a lock
+static inline void graph_acquire(const Graph* graph)
+{
+    // only the counter changes, the graph was never const to begin with
+    atomic_fetch_add_explicit(&((Graph*)graph)->searchers, 1, memory_order_acquire);
+}
+
+/// @brief ends a graph_acquire once the other threads stopped searching
+static inline void graph_release(const Graph* graph)
+{
+    atomic_fetch_sub_explicit(&((Graph*)graph)->searchers, 1, memory_order_release);
+}
+
+/// @brief the node id of a city that belongs to the graph
+static inline uint32_t graph_cityId(const Graph* graph, const City* city)
+{
+    return (uint32_t)(city - graph->cities);
+}
+
+#endif
@@ -0,0 +1,234 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "graph_file.h"
+#include "graph.h"
+
+// A graph file is the CSR arrays exactly as they sit in memory behind a small
+// header, so loading maps the file and points the graph at it. Nothing is
+// parsed and the pages are shared through the page cache by every process
+// that maps the same file. Sections start on 64 byte boundaries, integers are
+// in the byte order of the machine that wrote the file, the byte_order field
+// lets a reader on another machine refuse it instead of misreading it
+#define GRAPH_FILE_MAGIC "CSRGRAPH"
+#define GRAPH_FILE_VERSION 2
+#define GRAPH_FILE_BYTE_ORDER 0x01020304u
+#define GRAPH_FILE_ALIGN 64
+#define GRAPH_FILE_NO_NAME UINT32_MAX
+
+typedef struct graph_file_header{
+    char magic[8]; // GRAPH_FILE_MAGIC without the terminator
+    uint32_t version; // GRAPH_FILE_VERSION of the writer
+    uint32_t byte_order; // GRAPH_FILE_BYTE_ORDER as written by the writer
+    uint32_t num_nodes; // the number of cities in the graph
+    uint32_t num_edges; // the number of one way connections in the graph
+    uint32_t asymmetric; // graph->asymmetric of the saved graph, so loading does not count it again
+    uint32_t reserved; // zero
+    uint64_t nodes; // byte offset of num_nodes GraphFileNode records
+    uint64_t offsets; // byte offset of num_nodes + 1 uint32_t CSR offsets
+    uint64_t targets; // byte offset of num_edges uint32_t targets
+    uint64_t weights; // byte offset of num_edges uint32_t weights
+    uint64_t strings; // byte offset of the NUL terminated city names
+    uint64_t strings_len; // the length of the string pool in bytes
+    uint64_t file_len; // the length of the whole file in bytes
+} GraphFileHeader;
+
+// a city as it is stored in a graph file
+typedef struct graph_file_node{
+    uint32_t name; // offset of the name in the string pool or GRAPH_FILE_NO_NAME
+    uint16_t straight_distance; // the straight distance to bucharest
+    uint16_t reserved; // zero
+    int32_t x, y; // planar coordinates of the city
+} GraphFileNode;
+
+/// @brief rounds a file offset up to the next section boundary
+static inline uint64_t graphFile_align(uint64_t offset)
+{
+    return (offset + GRAPH_FILE_ALIGN - 1) & ~(uint64_t)(GRAPH_FILE_ALIGN - 1);
+}
+
+/// @brief writes len bytes at offset, zero filling the gap from the current position
+static bool graphFile_writeAt(FILE* file, uint64_t* position, uint64_t offset, const void* data, size_t len)
+{
+    static const char zeros[GRAPH_FILE_ALIGN] = {0};
+    if(fwrite(zeros, 1, offset - *position, file) != offset - *position)
+        return false;
+    if(len && fwrite(data, 1, len, file) != len)
+        return false;
+    *position = offset + len;
+    return true;
+}
+
+/// @brief writes a graph to a binary graph file that graph_load can map,
+///        the contraction hierarchy and landmarks are not stored
+/// @param graph the graph to write
+/// @param path the path of the file, replaced if it exists
+/// @return true if the whole file was written
+bool graph_save(const Graph* graph, const char* path)
+{
+    uint32_t n = graph->num_nodes;
+    GraphFileNode* nodes = (GraphFileNode*)calloc(n ? n : 1, sizeof(GraphFileNode));
+    if(nodes == NULL)
+    {
+        perror("unable to calloc graph file nodes");
+        exit(0);
+    }
+    uint64_t strings_len = 0;
+    for(uint32_t v = 0; v < n; v++)
+    {
+        const City* city = &graph->cities[v];
+        nodes[v].name = city->name ? (uint32_t)strings_len : GRAPH_FILE_NO_NAME;
+        nodes[v].straight_distance = city->straight_distance;
+        nodes[v].x = city->x;
+        nodes[v].y = city->y;
+        if(city->name)
+            strings_len += strlen(city->name) + 1;
+    }
+    if(strings_len >= GRAPH_FILE_NO_NAME)
+    {
+        printf("City names of %s do not fit a graph file\n", path);
+        free(nodes);
+        return false;
+    }
+
+    GraphFileHeader header = {0};
+    memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic));
+    header.version = GRAPH_FILE_VERSION;
+    header.byte_order = GRAPH_FILE_BYTE_ORDER;
+    header.num_nodes = n;
+    header.num_edges = graph->num_edges;
+    header.asymmetric = graph->asymmetric;
+    header.nodes = graphFile_align(sizeof(header));
+    header.offsets = graphFile_align(header.nodes + (uint64_t)n * sizeof(GraphFileNode));
+    header.targets = graphFile_align(header.offsets + ((uint64_t)n + 1) * sizeof(uint32_t));
+    header.weights = graphFile_align(header.targets + (uint64_t)graph->num_edges * sizeof(uint32_t));
+    header.strings = graphFile_align(header.weights + (uint64_t)graph->num_edges * sizeof(uint32_t));
+    header.strings_len = strings_len;
+    header.file_len = header.strings + strings_len;
+
+    FILE* file = fopen(path, "wb");
+    if(file == NULL)
+    {
+        perror(path);
+        free(nodes);
+        return false;
+    }
+    uint64_t position = 0;
+    bool ok = graphFile_writeAt(file, &position, 0, &header, sizeof(header))
+        && graphFile_writeAt(file, &position, header.nodes, nodes, (size_t)n * sizeof(GraphFileNode))
+        && graphFile_writeAt(file, &position, header.offsets, graph->offsets, ((size_t)n + 1) * sizeof(uint32_t))
+        && graphFile_writeAt(file, &position, header.targets, graph->targets, (size_t)graph->num_edges * sizeof(uint32_t))
+        && graphFile_writeAt(file, &position, header.weights, graph->weights, (size_t)graph->num_edges * sizeof(uint32_t))
+        && graphFile_writeAt(file, &position, header.strings, NULL, 0);
+    for(uint32_t v = 0; ok && v < n; v++)
+    {
+        const char* name = graph->cities[v].name;
+        if(name)
+            ok = fwrite(name, 1, strlen(name) + 1, file) == strlen(name) + 1;
+    }
+    free(nodes);
+    if(fclose(file) != 0 || !ok)
+    {
+        perror(path);
+        return false;
+    }
+    return true;
+}
+
+/// @brief maps a binary graph file written by graph_save, the CSR arrays are
+///        used in place and only the city table is allocated, with the names
+///        pointing into the mapping. The header and section bounds are checked,
+///        the arrays themselves are trusted
+/// @param path the path of the file
+/// @return a newly allocated graph or NULL if the file can not be used, free it with graph_free
+Graph* graph_load(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        perror(path);
+        return NULL;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (uint64_t)info.st_size < sizeof(GraphFileHeader))
+    {
+        printf("%s is not a graph file\n", path);
+        close(fd);
+        return NULL;
+    }
+    size_t len = (size_t)info.st_size;
+    void* mapping = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    const GraphFileHeader* header = (const GraphFileHeader*)mapping;
+    if(memcmp(header->magic, GRAPH_FILE_MAGIC, sizeof(header->magic)) != 0 || header->byte_order != GRAPH_FILE_BYTE_ORDER)
+    {
+        printf("%s is not a graph file\n", path);
+        munmap(mapping, len);
+        return NULL;
+    }
+    if(header->version != GRAPH_FILE_VERSION)
+    {
+        printf("%s is version %u, expected %u\n", path, header->version, GRAPH_FILE_VERSION);
+        munmap(mapping, len);
+        return NULL;
+    }
+    // every section has to lie inside the file in the order graph_save writes them
+    char* base = (char*)mapping;
+    uint64_t n = header->num_nodes, m = header->num_edges;
+    bool valid = header->file_len == len
+        && header->nodes % GRAPH_FILE_ALIGN == 0 && header->offsets % GRAPH_FILE_ALIGN == 0
+        && header->targets % GRAPH_FILE_ALIGN == 0 && header->weights % GRAPH_FILE_ALIGN == 0
+        && header->nodes >= sizeof(GraphFileHeader)
+        && header->nodes + n * sizeof(GraphFileNode) <= header->offsets
+        && header->offsets + (n + 1) * sizeof(uint32_t) <= header->targets
+        && header->targets + m * sizeof(uint32_t) <= header->weights
+        && header->weights + m * sizeof(uint32_t) <= header->strings
+        && header->strings + header->strings_len == len
+        && (header->strings_len == 0 || base[len - 1] == '\0');
+    uint32_t* offsets = (uint32_t*)(base + header->offsets);
+    if(!valid || offsets[n] != m)
+    {
+        printf("%s is truncated or corrupt\n", path);
+        munmap(mapping, len);
+        return NULL;
+    }
+
+    Graph* graph = (Graph*)calloc(1, sizeof(Graph));
+    City* cities = (City*)malloc((n ? n : 1) * sizeof(City));
+    if(graph == NULL || cities == NULL)
+    {
+        perror("unable to allocate graph");
+        exit(0);
+    }
+    const GraphFileNode* nodes = (const GraphFileNode*)(base + header->nodes);
+    char* strings = base + header->strings;
+    for(uint32_t v = 0; v < n; v++)
+    {
+        bool named = nodes[v].name < header->strings_len;
+        cities[v] = createCity(named ? strings + nodes[v].name : NULL, nodes[v].straight_distance);
+        cities[v].x = nodes[v].x;
+        cities[v].y = nodes[v].y;
+    }
+    graph->num_nodes = (uint32_t)n;
+    graph->num_edges = (uint32_t)m;
+    graph->offsets = offsets;
+    graph->targets = (uint32_t*)(base + header->targets);
+    graph->weights = (uint32_t*)(base + header->weights);
+    graph->asymmetric = header->asymmetric;
+    graph->cities = cities;
+    graph->mapping = mapping;
+    graph->mapping_len = len;
+    return graph;
+}
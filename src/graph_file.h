@@ -0,0 +1,11 @@
+#ifndef GRAPH_FILE_H
+#define GRAPH_FILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "graph.h"
+
+bool graph_save(const Graph* graph, const char* path);
+Graph* graph_load(const char* path);
+
+#endif
@@ -0,0 +1,203 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "graph_generate.h"
+#include "graph.h"
+#include "util.h"
+
+/// @brief builds a width by height grid of unnamed cities where every city
+///        is connected both ways to its horizontal and vertical neighbours
+/// @param width the number of cities in each row
+/// @param height the number of rows
+/// @param seed the seed for the random connection lengths
+/// @return a newly allocated graph, free it with graph_free
+Graph* generateGridGraph(uint32_t width, uint32_t height, uint32_t seed)
+{
+    uint32_t num_nodes = width * height;
+    City* cities = (City*)calloc(num_nodes, sizeof(City));
+    if(cities == NULL)
+    {
+        perror("unable to calloc grid cities");
+        exit(0);
+    }
+
+    EdgeList edges = {0};
+    for(uint32_t y = 0; y < height; y++)
+    {
+        for(uint32_t x = 0; x < width; x++)
+        {
+            uint32_t v = y * width + x;
+            if(x + 1 < width)
+            {
+                uint32_t dist = 10 + xorshift32(&seed) % 90;
+                edgeList_add(&edges, v, v + 1, dist);
+                edgeList_add(&edges, v + 1, v, dist);
+            }
+            if(y + 1 < height)
+            {
+                uint32_t dist = 10 + xorshift32(&seed) % 90;
+                edgeList_add(&edges, v, v + width, dist);
+                edgeList_add(&edges, v + width, v, dist);
+            }
+        }
+    }
+
+    Graph* graph = graph_build(cities, num_nodes, &edges);
+    edgeList_free(&edges);
+    free(cities);
+    return graph;
+}
+
+/// @brief the integer square root of a number rounded up
+uint32_t isqrtCeil(uint64_t value)
+{
+    uint64_t root = 0, bit = 1ull << 62;
+    while(bit > value)bit >>= 2;
+    for(; bit; bit >>= 2)
+    {
+        if(value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+            root >>= 1;
+    }
+    return (uint32_t)(root + (value != 0));
+}
+
+/// @brief scatters cities uniformly over a square and connects every pair
+///        closer than a radius chosen for the requested average degree, the
+///        length of a connection is its straight line length rounded up
+/// @param num_nodes the number of cities
+/// @param degree the average number of connections of each city
+/// @param seed the seed for the city positions
+/// @return a newly allocated graph, free it with graph_free
+Graph* generateGeometricGraph(uint32_t num_nodes, uint32_t degree, uint32_t seed)
+{
+    // cities are about 100 apart on average and pi * radius^2 * density = degree
+    uint32_t extent = 100 * isqrtCeil(num_nodes);
+    uint64_t radius2 = 10000ull * degree * 113 / 355;
+    uint32_t radius = isqrtCeil(radius2);
+    uint32_t cells_side = extent / radius + 1;
+    City* cities = (City*)calloc(num_nodes ? num_nodes : 1, sizeof(City));
+    uint32_t* cell_starts = (uint32_t*)calloc((size_t)cells_side * cells_side + 1, sizeof(uint32_t));
+    uint32_t* by_cell = (uint32_t*)malloc((num_nodes ? num_nodes : 1) * sizeof(uint32_t));
+    if(!cities || !cell_starts || !by_cell)
+    {
+        perror("unable to allocate geometric graph");
+        exit(0);
+    }
+    for(uint32_t v = 0; v < num_nodes; v++)
+    {
+        cities[v].x = (int32_t)(xorshift32(&seed) % extent);
+        cities[v].y = (int32_t)(xorshift32(&seed) % extent);
+    }
+
+    // bucket the cities by radius sized cells so each one is only compared
+    // with the cities of its own and the eight neighbouring cells
+    #define cellOf(v) ((uint32_t)cities[v].y / radius * cells_side + (uint32_t)cities[v].x / radius)
+    for(uint32_t v = 0; v < num_nodes; v++)
+        cell_starts[cellOf(v) + 1]++;
+    for(uint32_t c = 0; c < cells_side * cells_side; c++)
+        cell_starts[c + 1] += cell_starts[c];
+    for(uint32_t v = 0; v < num_nodes; v++)
+        by_cell[cell_starts[cellOf(v)]++] = v;
+    for(uint32_t c = cells_side * cells_side; c > 0; c--)
+        cell_starts[c] = cell_starts[c - 1];
+    cell_starts[0] = 0;
+
+    EdgeList edges = {0};
+    edgeList_reserve(&edges, num_nodes * (degree + 1));
+    for(uint32_t v = 0; v < num_nodes; v++)
+    {
+        uint32_t cx = (uint32_t)cities[v].x / radius, cy = (uint32_t)cities[v].y / radius;
+        for(uint32_t y = cy ? cy - 1 : 0; y <= cy + 1 && y < cells_side; y++)
+        {
+            for(uint32_t x = cx ? cx - 1 : 0; x <= cx + 1 && x < cells_side; x++)
+            {
+                uint32_t c = y * cells_side + x;
+                for(uint32_t i = cell_starts[c]; i < cell_starts[c + 1]; i++)
+                {
+                    uint32_t u = by_cell[i];
+                    int64_t dx = cities[u].x - cities[v].x, dy = cities[u].y - cities[v].y;
+                    uint64_t dist2 = (uint64_t)(dx * dx + dy * dy);
+                    if(u <= v || dist2 > radius2)continue;
+                    uint32_t dist = isqrtCeil(dist2);
+                    edgeList_add(&edges, v, u, dist ? dist : 1);
+                    edgeList_add(&edges, u, v, dist ? dist : 1);
+                }
+            }
+        }
+    }
+    #undef cellOf
+
+    Graph* graph = graph_buildOwned(cities, num_nodes, &edges);
+    edgeList_free(&edges);
+    free(cell_starts);
+    free(by_cell);
+    return graph;
+}
+
+/// @brief grows a scale free graph by preferential attachment, each new city
+///        connects both ways to links distinct cities picked with probability
+///        proportional to their degree, which leaves a few very large hubs
+/// @param num_nodes the number of cities
+/// @param links the number of connections each new city makes
+/// @param seed the seed for the attachment and the connection lengths
+/// @return a newly allocated graph, free it with graph_free
+Graph* generateScaleFreeGraph(uint32_t num_nodes, uint32_t links, uint32_t seed)
+{
+    City* cities = (City*)calloc(num_nodes ? num_nodes : 1, sizeof(City));
+    // every connection adds both of its cities here, so a uniform pick from
+    // this list is a pick weighted by degree
+    uint32_t* ends = (uint32_t*)malloc(((size_t)num_nodes * links * 2 + 1) * sizeof(uint32_t));
+    uint32_t* picked = (uint32_t*)malloc((links ? links : 1) * sizeof(uint32_t));
+    if(!cities || !ends || !picked)
+    {
+        perror("unable to allocate scale free graph");
+        exit(0);
+    }
+    EdgeList edges = {0};
+    edgeList_reserve(&edges, num_nodes * links * 2);
+    uint32_t num_ends = 0;
+    #define connectCities(a, b) do{ \
+        uint32_t dist = 10 + xorshift32(&seed) % 90; \
+        edgeList_add(&edges, a, b, dist); \
+        edgeList_add(&edges, b, a, dist); \
+        ends[num_ends++] = a; \
+        ends[num_ends++] = b; \
+    }while(0)
+
+    // the first links + 1 cities start out fully connected
+    uint32_t seeded = num_nodes < links + 1 ? num_nodes : links + 1;
+    for(uint32_t v = 0; v < seeded; v++)
+    {
+        for(uint32_t u = 0; u < v; u++)
+            connectCities(v, u);
+    }
+    for(uint32_t v = seeded; v < num_nodes; v++)
+    {
+        uint32_t count = 0;
+        while(count < links)
+        {
+            uint32_t u = ends[xorshift32(&seed) % num_ends];
+            bool duplicate = false;
+            for(uint32_t i = 0; i < count; i++)
+                duplicate |= picked[i] == u;
+            if(!duplicate)
+                picked[count++] = u;
+        }
+        for(uint32_t i = 0; i < count; i++)
+            connectCities(v, picked[i]);
+    }
+    #undef connectCities
+
+    Graph* graph = graph_buildOwned(cities, num_nodes, &edges);
+    edgeList_free(&edges);
+    free(ends);
+    free(picked);
+    return graph;
+}
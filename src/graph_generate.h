@@ -0,0 +1,12 @@
+#ifndef GRAPH_GENERATE_H
+#define GRAPH_GENERATE_H
+
+#include <stdint.h>
+#include "graph.h"
+
+Graph* generateGridGraph(uint32_t width, uint32_t height, uint32_t seed);
+uint32_t isqrtCeil(uint64_t value);
+Graph* generateGeometricGraph(uint32_t num_nodes, uint32_t degree, uint32_t seed);
+Graph* generateScaleFreeGraph(uint32_t num_nodes, uint32_t links, uint32_t seed);
+
+#endif
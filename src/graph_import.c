@@ -0,0 +1,679 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "graph_import.h"
+#include "graph.h"
+
+// Importers for graphs too large to type into main. Files are read in large
+// chunks and split into lines in place, names are interned in a hash table so
+// each connection finds its cities in O(1) instead of a getCity scan. The
+// connection file is read twice, once to count the connections of each city
+// and once to place them straight into the arrays of the graph, so the import
+// never holds a second copy of the connections
+#define LINE_READER_CHUNK (1u << 20)
+#define NAME_TABLE_EMPTY UINT32_MAX
+
+/// @brief opens a file for reading line by line
+/// @param reader the reader to initialize
+/// @param path the path of the file
+/// @return false if the file could not be opened
+bool lineReader_open(LineReader* reader, const char* path)
+{
+    *reader = (LineReader){0};
+    reader->file = fopen(path, "rb");
+    if(reader->file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    // the reader does its own buffering, a second copy through stdio only costs time
+    setvbuf(reader->file, NULL, _IONBF, 0);
+    reader->path = path;
+    reader->capacity = LINE_READER_CHUNK;
+    reader->buf = (char*)malloc(reader->capacity);
+    if(reader->buf == NULL)
+    {
+        perror("unable to malloc line buffer");
+        exit(0);
+    }
+    return true;
+}
+
+/// @brief the next line of the file without its line ending, the line is
+///        only valid until the next call and may be modified by the caller
+/// @param reader the reader to take the line from
+/// @return the NUL terminated line or NULL at the end of the file
+char* lineReader_next(LineReader* reader)
+{
+    for(;;)
+    {
+        char* line = reader->buf + reader->start;
+        char* newline = (char*)memchr(line, '\n', reader->end - reader->start);
+        if(newline == NULL && reader->eof)
+        {
+            if(reader->start == reader->end)
+                return NULL;
+            newline = reader->buf + reader->end;
+        }
+        if(newline)
+        {
+            *newline = '\0';
+            reader->start = newline - reader->buf + (newline < reader->buf + reader->end);
+            if(newline > line && newline[-1] == '\r')
+                newline[-1] = '\0';
+            reader->line++;
+            return line;
+        }
+
+        // move the unfinished line to the front, growing the buffer only for
+        // a line longer than it, then read the next chunk in behind it
+        size_t partial = reader->end - reader->start;
+        memmove(reader->buf, reader->buf + reader->start, partial);
+        reader->start = 0;
+        reader->end = partial;
+        if(reader->end + 1 == reader->capacity)
+        {
+            char* buf = (char*)realloc(reader->buf, reader->capacity * 2);
+            if(buf == NULL)
+            {
+                perror("unable to realloc line buffer");
+                exit(0);
+            }
+            reader->buf = buf;
+            reader->capacity *= 2;
+        }
+        size_t read = fread(reader->buf + reader->end, 1, reader->capacity - reader->end - 1, reader->file);
+        reader->end += read;
+        if(read == 0)
+        {
+            if(ferror(reader->file))
+                perror(reader->path);
+            reader->eof = true;
+        }
+    }
+}
+
+/// @brief closes the file and releases the buffer of a reader
+void lineReader_close(LineReader* reader)
+{
+    if(reader->file)
+        fclose(reader->file);
+    free(reader->buf);
+    *reader = (LineReader){0};
+}
+
+/// @brief parses an unsigned decimal number after any blanks
+/// @param cursor the text to parse, moved past the number
+/// @param value set to the number
+/// @return false if there is no number or it does not fit in 32 bits
+static bool parseUint32(char** cursor, uint32_t* value)
+{
+    char* c = *cursor;
+    while(*c == ' ' || *c == '\t')c++;
+    if(*c < '0' || *c > '9')
+        return false;
+    uint64_t result = 0;
+    for(; *c >= '0' && *c <= '9'; c++)
+    {
+        result = result * 10 + (uint64_t)(*c - '0');
+        if(result > UINT32_MAX)
+            return false;
+    }
+    *value = (uint32_t)result;
+    *cursor = c;
+    return true;
+}
+
+/// @brief parses a signed decimal number after any blanks
+/// @param cursor the text to parse, moved past the number
+/// @param value set to the number
+/// @return false if there is no number or it does not fit in 32 bits
+static bool parseInt32(char** cursor, int32_t* value)
+{
+    char* c = *cursor;
+    while(*c == ' ' || *c == '\t')c++;
+    bool negative = *c == '-';
+    if(*c == '-' || *c == '+')c++;
+    uint32_t magnitude;
+    if(!parseUint32(&c, &magnitude) || magnitude > (negative ? 2147483648u : 2147483647u))
+        return false;
+    *value = negative ? (int32_t)(0u - magnitude) : (int32_t)magnitude;
+    *cursor = c;
+    return true;
+}
+
+/// @brief true if only blanks are left in the text
+static inline bool atLineEnd(const char* cursor)
+{
+    while(*cursor == ' ' || *cursor == '\t')cursor++;
+    return *cursor == '\0';
+}
+
+/// @brief splits the next comma separated field off a line, trimming the blanks around it
+/// @param cursor the rest of the line, moved past the field and its comma,
+///        set to NULL after the last field
+/// @return the NUL terminated field or NULL when there are no fields left
+static char* csvField(char** cursor)
+{
+    char* field = *cursor;
+    if(field == NULL)
+        return NULL;
+    char* comma = strchr(field, ',');
+    if(comma)
+    {
+        *comma = '\0';
+        *cursor = comma + 1;
+    }
+    else
+        *cursor = NULL;
+    while(*field == ' ' || *field == '\t')field++;
+    char* last = field + strlen(field);
+    while(last > field && (last[-1] == ' ' || last[-1] == '\t'))last--;
+    *last = '\0';
+    return field;
+}
+
+/// @brief the 32 bit FNV-1a hash of a name
+static inline uint32_t nameTable_hash(const char* name)
+{
+    uint32_t hash = 2166136261u;
+    for(; *name; name++)
+        hash = (hash ^ (uint8_t)*name) * 16777619u;
+    return hash;
+}
+
+/// @brief the name interned as id, only valid until the next name is interned
+static inline const char* nameTable_name(const NameTable* table, uint32_t id)
+{
+    return table->pool + table->offsets[id];
+}
+
+/// @brief the slot holding a name or the empty slot it would go in
+static uint32_t nameTable_slot(const NameTable* table, const char* name, uint32_t hash)
+{
+    uint32_t slot = hash & table->mask;
+    while(table->slots[slot] != NAME_TABLE_EMPTY && strcmp(nameTable_name(table, table->slots[slot]), name) != 0)
+        slot = (slot + 1) & table->mask;
+    return slot;
+}
+
+/// @brief doubles the slots of a table and rehashes every name into them
+static void nameTable_grow(NameTable* table)
+{
+    uint32_t num_slots = table->slots ? (table->mask + 1) * 2 : 1024;
+    free(table->slots);
+    table->slots = (uint32_t*)malloc(num_slots * sizeof(uint32_t));
+    if(table->slots == NULL)
+    {
+        perror("unable to malloc name table");
+        exit(0);
+    }
+    memset(table->slots, 0xff, num_slots * sizeof(uint32_t));
+    table->mask = num_slots - 1;
+    for(uint32_t id = 0; id < table->count; id++)
+    {
+        const char* name = nameTable_name(table, id);
+        table->slots[nameTable_slot(table, name, nameTable_hash(name))] = id;
+    }
+}
+
+/// @brief finds the id of a name
+/// @return the id or NAME_TABLE_EMPTY if the name was never interned
+uint32_t nameTable_find(const NameTable* table, const char* name)
+{
+    if(table->slots == NULL)
+        return NAME_TABLE_EMPTY;
+    return table->slots[nameTable_slot(table, name, nameTable_hash(name))];
+}
+
+/// @brief finds the id of a name, adding it with the next free id if it is new
+/// @param table the table to search
+/// @param name the name, copied into the table
+/// @param added set to whether the name was new, may be NULL
+/// @return the id of the name
+uint32_t nameTable_intern(NameTable* table, const char* name, bool* added)
+{
+    // keep the table at most half full so probe runs stay short
+    if(table->slots == NULL || table->count >= (table->mask + 1) / 2)
+        nameTable_grow(table);
+    uint32_t hash = nameTable_hash(name);
+    uint32_t slot = nameTable_slot(table, name, hash);
+    if(added)
+        *added = table->slots[slot] == NAME_TABLE_EMPTY;
+    if(table->slots[slot] != NAME_TABLE_EMPTY)
+        return table->slots[slot];
+
+    size_t len = strlen(name) + 1;
+    if(table->pool_len + len > table->pool_capacity)
+    {
+        size_t capacity = table->pool_capacity ? table->pool_capacity * 2 : 4096;
+        while(capacity < table->pool_len + len)capacity *= 2;
+        char* pool = (char*)realloc(table->pool, capacity);
+        if(pool == NULL || table->pool_len + len > UINT32_MAX)
+        {
+            perror("unable to realloc name pool");
+            exit(0);
+        }
+        table->pool = pool;
+        table->pool_capacity = capacity;
+    }
+    if(table->count == table->offsets_capacity)
+    {
+        uint32_t capacity = table->offsets_capacity ? table->offsets_capacity * 2 : 1024;
+        uint32_t* offsets = (uint32_t*)realloc(table->offsets, capacity * sizeof(uint32_t));
+        if(offsets == NULL)
+        {
+            perror("unable to realloc name offsets");
+            exit(0);
+        }
+        table->offsets = offsets;
+        table->offsets_capacity = capacity;
+    }
+    memcpy(table->pool + table->pool_len, name, len);
+    table->offsets[table->count] = (uint32_t)table->pool_len;
+    table->pool_len += len;
+    table->slots[slot] = table->count;
+    return table->count++;
+}
+
+/// @brief releases the memory held by a name table
+void nameTable_free(NameTable* table)
+{
+    free(table->slots);
+    free(table->offsets);
+    free(table->pool);
+    *table = (NameTable){0};
+}
+
+// the cities and connections of a graph while its files are being read
+typedef struct graph_import{
+    NameTable names; // the cities by name, unused when the file numbers its cities
+    City* cities; // the cities by id, names are filled in once the pool stops moving
+    uint32_t num_cities;
+    uint32_t cities_capacity;
+    uint32_t* offsets; // the connections of each city while counting, then the insert cursors, see graphImport_place
+    uint32_t* ends; // ends[v] is where the range of v ends, from the counts of the first read
+    uint32_t* targets; // the connections of the graph, allocated once they are counted
+    uint32_t* weights;
+    uint32_t num_edges; // the number of connections counted
+    uint32_t num_placed; // the number of connections placed so far
+} GraphImport;
+
+/// @brief makes room for at least capacity cities and their counts
+static void graphImport_reserve(GraphImport* import, uint32_t capacity)
+{
+    if(capacity <= import->cities_capacity)
+        return;
+    City* cities = (City*)realloc(import->cities, capacity * sizeof(City));
+    uint32_t* offsets = (uint32_t*)realloc(import->offsets, ((size_t)capacity + 1) * sizeof(uint32_t));
+    if(cities == NULL || offsets == NULL)
+    {
+        perror("unable to realloc imported cities");
+        exit(0);
+    }
+    size_t kept = import->cities_capacity ? (size_t)import->cities_capacity + 1 : 0;
+    memset(offsets + kept, 0, ((size_t)capacity + 1 - kept) * sizeof(uint32_t));
+    import->cities = cities;
+    import->offsets = offsets;
+    import->cities_capacity = capacity;
+}
+
+/// @brief the id of a named city, adding the city if the name is new
+static uint32_t graphImport_city(GraphImport* import, const char* name, bool* added)
+{
+    bool is_new;
+    uint32_t id = nameTable_intern(&import->names, name, &is_new);
+    if(is_new)
+    {
+        if(import->num_cities == import->cities_capacity)
+            graphImport_reserve(import, import->cities_capacity ? import->cities_capacity * 2 : 1024);
+        import->cities[import->num_cities++] = createCity(NULL, 0);
+    }
+    if(added)
+        *added = is_new;
+    return id;
+}
+
+/// @brief counts a connection leaving a city on the first read of the file
+/// @return false if the graph already has as many connections as it can number
+static bool graphImport_count(GraphImport* import, uint32_t from)
+{
+    if(import->num_edges == UINT32_MAX)
+        return false;
+    import->offsets[from + 1]++;
+    import->num_edges++;
+    return true;
+}
+
+/// @brief allocates the connections once they are counted and turns the
+///        counts into insert cursors, offsets[v + 1] is where the next
+///        connection of v goes and ends up as the end of its range
+static void graphImport_place(GraphImport* import)
+{
+    if(import->offsets == NULL)
+        graphImport_reserve(import, 1);
+    import->targets = (uint32_t*)malloc((import->num_edges ? import->num_edges : 1) * sizeof(uint32_t));
+    import->weights = (uint32_t*)malloc((import->num_edges ? import->num_edges : 1) * sizeof(uint32_t));
+    import->ends = (uint32_t*)malloc((import->num_cities ? import->num_cities : 1) * sizeof(uint32_t));
+    if(!import->targets || !import->weights || !import->ends)
+    {
+        perror("unable to allocate imported connections");
+        exit(0);
+    }
+    uint32_t sum = 0;
+    import->offsets[0] = 0;
+    for(uint32_t v = 0; v < import->num_cities; v++)
+    {
+        uint32_t count = import->offsets[v + 1];
+        import->offsets[v + 1] = sum;
+        sum += count;
+        import->ends[v] = sum;
+    }
+}
+
+/// @brief puts a connection in the range of its city on the second read of the file
+/// @return false if the city already has all the connections the first read
+///        counted for it, the file has changed since then
+static bool graphImport_add(GraphImport* import, uint32_t from, uint32_t to, uint32_t dist)
+{
+    if(import->offsets[from + 1] == import->ends[from])
+        return false;
+    uint32_t slot = import->offsets[from + 1]++;
+    import->targets[slot] = to;
+    import->weights[slot] = dist;
+    import->num_placed++;
+    return true;
+}
+
+/// @brief releases everything an import holds
+static void graphImport_free(GraphImport* import)
+{
+    nameTable_free(&import->names);
+    free(import->cities);
+    free(import->offsets);
+    free(import->ends);
+    free(import->targets);
+    free(import->weights);
+    *import = (GraphImport){0};
+}
+
+/// @brief reports a malformed line and abandons the import
+/// @return NULL for the importer to return
+static Graph* graphImport_fail(GraphImport* import, LineReader* reader, const char* message)
+{
+    printf("%s:%llu: %s\n", reader->path, (unsigned long long)reader->line, message);
+    lineReader_close(reader);
+    graphImport_free(import);
+    return NULL;
+}
+
+/// @brief hands the imported cities and connections to a graph, the graph
+///        takes over the arrays and the name pool
+static Graph* graphImport_finish(GraphImport* import)
+{
+    if(import->names.count)
+    {
+        for(uint32_t v = 0; v < import->num_cities; v++)
+            import->cities[v].name = import->names.pool + import->names.offsets[v];
+    }
+    Graph* graph = graph_buildCsr(import->cities, import->num_cities, import->offsets, import->targets, import->weights);
+    graph->names = import->names.pool;
+    import->names.pool = NULL;
+    import->cities = NULL;
+    import->offsets = import->targets = import->weights = NULL;
+    graphImport_free(import);
+    return graph;
+}
+
+/// @brief parses the arc line of a DIMACS file
+/// @param line the line after its leading a
+/// @param num_nodes the number of nodes of the problem line
+/// @return NULL or what is wrong with the line
+static const char* dimacs_parseArc(char* line, uint32_t num_nodes, uint32_t* from, uint32_t* to, uint32_t* dist)
+{
+    if(!parseUint32(&line, from) || !parseUint32(&line, to) || !parseUint32(&line, dist) || !atLineEnd(line))
+        return "expected a <from> <to> <length>";
+    if(*from == 0 || *from > num_nodes || *to == 0 || *to > num_nodes)
+        return "arc to a node that does not exist";
+    if(*dist == CONNECTION_CLOSED)
+        return "arc length 4294967295 is taken for a closed connection";
+    return NULL;
+}
+
+/// @brief imports a road network in the DIMACS shortest path challenge format,
+///        a .gr file of "p sp <nodes> <arcs>" and "a <from> <to> <length>"
+///        lines and an optional .co file of "v <node> <x> <y>" lines, nodes
+///        are numbered from 1 and become unnamed cities numbered from 0.
+///        The .gr file is read twice so it has to be a regular file
+/// @param graph_path the path of the .gr file
+/// @param coords_path the path of the .co file or NULL
+/// @return a newly allocated graph or NULL if a file can not be read, free it with graph_free
+Graph* graph_importDimacs(const char* graph_path, const char* coords_path)
+{
+    GraphImport import = {0};
+    LineReader reader;
+    if(!lineReader_open(&reader, graph_path))
+        return NULL;
+    bool have_problem = false;
+    char* line;
+    while((line = lineReader_next(&reader)) != NULL)
+    {
+        if(line[0] == 'a')
+        {
+            uint32_t from, to, dist;
+            if(!have_problem)
+                return graphImport_fail(&import, &reader, "arc before the problem line");
+            const char* error = dimacs_parseArc(line + 1, import.num_cities, &from, &to, &dist);
+            if(error)
+                return graphImport_fail(&import, &reader, error);
+            if(!graphImport_count(&import, from - 1))
+                return graphImport_fail(&import, &reader, "too many arcs");
+        }
+        else if(line[0] == 'p')
+        {
+            uint32_t num_nodes, num_arcs;
+            char* cursor = line + 1;
+            while(*cursor == ' ' || *cursor == '\t')cursor++;
+            if(have_problem || strncmp(cursor, "sp", 2) != 0)
+                return graphImport_fail(&import, &reader, "expected a single p sp <nodes> <arcs>");
+            cursor += 2;
+            if(!parseUint32(&cursor, &num_nodes) || !parseUint32(&cursor, &num_arcs) || !atLineEnd(cursor) || num_nodes == UINT32_MAX)
+                return graphImport_fail(&import, &reader, "expected p sp <nodes> <arcs>");
+            // the problem line gives the number of nodes, so nothing is grown by doubling
+            graphImport_reserve(&import, num_nodes ? num_nodes : 1);
+            memset(import.cities, 0, (size_t)import.cities_capacity * sizeof(City));
+            import.num_cities = num_nodes;
+            have_problem = true;
+        }
+        else if(line[0] != 'c' && !atLineEnd(line))
+            return graphImport_fail(&import, &reader, "unknown line type");
+    }
+    lineReader_close(&reader);
+    if(!have_problem)
+    {
+        printf("%s has no problem line\n", graph_path);
+        graphImport_free(&import);
+        return NULL;
+    }
+
+    // every line was checked above, the second read only places the arcs
+    graphImport_place(&import);
+    if(!lineReader_open(&reader, graph_path))
+    {
+        graphImport_free(&import);
+        return NULL;
+    }
+    while((line = lineReader_next(&reader)) != NULL)
+    {
+        uint32_t from, to, dist;
+        if(line[0] != 'a')
+            continue;
+        if(dimacs_parseArc(line + 1, import.num_cities, &from, &to, &dist) || !graphImport_add(&import, from - 1, to - 1, dist))
+            return graphImport_fail(&import, &reader, "file changed while it was read");
+    }
+    lineReader_close(&reader);
+    if(import.num_placed != import.num_edges)
+    {
+        printf("%s changed while it was read\n", graph_path);
+        graphImport_free(&import);
+        return NULL;
+    }
+
+    if(coords_path)
+    {
+        if(!lineReader_open(&reader, coords_path))
+        {
+            graphImport_free(&import);
+            return NULL;
+        }
+        while((line = lineReader_next(&reader)) != NULL)
+        {
+            if(line[0] != 'v')
+            {
+                if(line[0] != 'c' && line[0] != 'p' && !atLineEnd(line))
+                    return graphImport_fail(&import, &reader, "unknown line type");
+                continue;
+            }
+            uint32_t node;
+            int32_t x, y;
+            char* cursor = line + 1;
+            if(!parseUint32(&cursor, &node) || !parseInt32(&cursor, &x) || !parseInt32(&cursor, &y) || !atLineEnd(cursor))
+                return graphImport_fail(&import, &reader, "expected v <node> <x> <y>");
+            if(node == 0 || node > import.num_cities)
+                return graphImport_fail(&import, &reader, "coordinates of a node that does not exist");
+            import.cities[node - 1].x = x;
+            import.cities[node - 1].y = y;
+        }
+        lineReader_close(&reader);
+    }
+    return graphImport_finish(&import);
+}
+
+/// @brief parses a line of a connection file
+/// @param line the line, split in place
+/// @return false if the line is not from,to,distance
+static bool csv_parseConnection(char* line, char** from_name, char** to_name, uint32_t* dist)
+{
+    char* cursor = line;
+    *from_name = csvField(&cursor);
+    *to_name = csvField(&cursor);
+    char* dist_field = csvField(&cursor);
+    return dist_field && parseUint32(&dist_field, dist) && atLineEnd(dist_field)
+        && cursor == NULL && (*from_name)[0] != '\0' && (*to_name)[0] != '\0';
+}
+
+/// @brief imports a graph from simple comma separated files without quoting,
+///        an optional city file of "name,straight_distance[,x,y]" lines and a
+///        connection file of "from,to,distance" lines naming the cities.
+///        Cities only named by connections get a straight distance of 0, a
+///        first line that does not parse is taken as a header and skipped.
+///        The connection file is read twice so it has to be a regular file
+/// @param edges_path the path of the connection file
+/// @param nodes_path the path of the city file or NULL
+/// @param both_ways true to add every connection in both directions
+/// @return a newly allocated graph or NULL if a file can not be read, free it with graph_free
+Graph* graph_importCsv(const char* edges_path, const char* nodes_path, bool both_ways)
+{
+    GraphImport import = {0};
+    LineReader reader;
+    char* line;
+    if(nodes_path)
+    {
+        if(!lineReader_open(&reader, nodes_path))
+            return NULL;
+        while((line = lineReader_next(&reader)) != NULL)
+        {
+            if(line[0] == '#' || atLineEnd(line))
+                continue;
+            char* cursor = line;
+            char* name = csvField(&cursor);
+            char* dist_field = csvField(&cursor);
+            char* x_field = csvField(&cursor);
+            char* y_field = csvField(&cursor);
+            uint32_t dist;
+            int32_t x = 0, y = 0;
+            bool valid = dist_field && parseUint32(&dist_field, &dist) && atLineEnd(dist_field) && dist <= UINT16_MAX
+                && (x_field == NULL || (y_field && parseInt32(&x_field, &x) && atLineEnd(x_field) && parseInt32(&y_field, &y) && atLineEnd(y_field)))
+                && cursor == NULL && name[0] != '\0';
+            if(!valid)
+            {
+                if(reader.line == 1)
+                    continue;
+                return graphImport_fail(&import, &reader, "expected name,straight_distance[,x,y]");
+            }
+            bool added;
+            uint32_t id = graphImport_city(&import, name, &added);
+            if(!added)
+                return graphImport_fail(&import, &reader, "city listed twice");
+            import.cities[id].straight_distance = (uint16_t)dist;
+            import.cities[id].x = x;
+            import.cities[id].y = y;
+        }
+        lineReader_close(&reader);
+    }
+
+    // the first read names the cities and counts their connections
+    if(!lineReader_open(&reader, edges_path))
+    {
+        graphImport_free(&import);
+        return NULL;
+    }
+    while((line = lineReader_next(&reader)) != NULL)
+    {
+        if(line[0] == '#' || atLineEnd(line))
+            continue;
+        char* from_name;
+        char* to_name;
+        uint32_t dist;
+        if(!csv_parseConnection(line, &from_name, &to_name, &dist))
+        {
+            if(reader.line == 1)
+                continue;
+            return graphImport_fail(&import, &reader, "expected from,to,distance");
+        }
+        if(dist == CONNECTION_CLOSED)
+            return graphImport_fail(&import, &reader, "distance 4294967295 is taken for a closed connection");
+        uint32_t from = graphImport_city(&import, from_name, NULL);
+        uint32_t to = graphImport_city(&import, to_name, NULL);
+        if(!graphImport_count(&import, from) || (both_ways && !graphImport_count(&import, to)))
+            return graphImport_fail(&import, &reader, "too many connections");
+    }
+    lineReader_close(&reader);
+
+    // the second places them, every name is known by now
+    graphImport_place(&import);
+    if(!lineReader_open(&reader, edges_path))
+    {
+        graphImport_free(&import);
+        return NULL;
+    }
+    while((line = lineReader_next(&reader)) != NULL)
+    {
+        if(line[0] == '#' || atLineEnd(line))
+            continue;
+        char* from_name;
+        char* to_name;
+        uint32_t dist;
+        if(!csv_parseConnection(line, &from_name, &to_name, &dist))
+        {
+            if(reader.line == 1)
+                continue;
+            return graphImport_fail(&import, &reader, "file changed while it was read");
+        }
+        uint32_t from = nameTable_find(&import.names, from_name);
+        uint32_t to = nameTable_find(&import.names, to_name);
+        if(from == NAME_TABLE_EMPTY || to == NAME_TABLE_EMPTY || !graphImport_add(&import, from, to, dist)
+            || (both_ways && !graphImport_add(&import, to, from, dist)))
+            return graphImport_fail(&import, &reader, "file changed while it was read");
+    }
+    lineReader_close(&reader);
+    if(import.num_placed != import.num_edges)
+    {
+        printf("%s changed while it was read\n", edges_path);
+        graphImport_free(&import);
+        return NULL;
+    }
+    return graphImport_finish(&import);
+}
@@ -0,0 +1,43 @@
+#ifndef GRAPH_IMPORT_H
+#define GRAPH_IMPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "graph.h"
+
+// reads a text file a chunk at a time and hands out its lines in place
+typedef struct line_reader{
+    FILE* file;
+    const char* path; // the path of the file for error messages
+    char* buf; // the current chunk, starting with the unfinished line of the last one
+    size_t capacity; // the size of buf, one byte is kept free for a terminator
+    size_t start; // the first byte of buf not yet handed out
+    size_t end; // one past the last byte read into buf
+    uint64_t line; // the number of the last line handed out, from 1
+    bool eof; // the whole file has been read into buf
+} LineReader;
+
+// interns city names, ids are handed out in the order names are first seen
+typedef struct name_table{
+    uint32_t* slots; // the id of the name hashed to each slot or NAME_TABLE_EMPTY
+    uint32_t mask; // the number of slots minus one, the number of slots is a power of two
+    uint32_t count; // the number of names in the table
+    uint32_t* offsets; // offsets[id] is where the name of id starts in pool
+    uint32_t offsets_capacity;
+    char* pool; // the NUL terminated names back to back
+    size_t pool_len;
+    size_t pool_capacity;
+} NameTable;
+
+bool lineReader_open(LineReader* reader, const char* path);
+char* lineReader_next(LineReader* reader);
+void lineReader_close(LineReader* reader);
+uint32_t nameTable_find(const NameTable* table, const char* name);
+uint32_t nameTable_intern(NameTable* table, const char* name, bool* added);
+void nameTable_free(NameTable* table);
+Graph* graph_importDimacs(const char* graph_path, const char* coords_path);
+Graph* graph_importCsv(const char* edges_path, const char* nodes_path, bool both_ways);
+
+#endif
@@ -0,0 +1,379 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/mman.h>
+#include "graph_order.h"
+#include "graph.h"
+#include "util.h"
+#include "landmarks.h"
+#include "spatial_index.h"
+#include "contraction_hierarchy.h"
+
+/// @brief the number of connections leaving a city
+static inline uint32_t graph_degree(const Graph* graph, uint32_t node)
+{
+    return graph->offsets[node + 1] - graph->offsets[node];
+}
+
+/// @brief a breadth first search over the cities not placed yet, used to
+///        find a start for reverse Cuthill-McKee
+/// @param graph the graph to search
+/// @param root the city to start from
+/// @param placed the new id of every city, UINT32_MAX for cities not placed yet
+/// @param seen stamps of the cities this search reached
+/// @param stamp the stamp of this search
+/// @param queue room for every city, filled with the cities in the order they were reached
+/// @param last_level set to the index in queue where the farthest level starts
+/// @param reached set to the number of cities in queue
+/// @return the number of levels below the root
+static uint32_t graphOrder_levels(const Graph* graph, uint32_t root, const uint32_t* placed, uint32_t* seen, uint32_t stamp,
+    uint32_t* queue, uint32_t* last_level, uint32_t* reached)
+{
+    uint32_t head = 0, tail = 0, depth = 0, level_end = 1;
+    queue[tail++] = root;
+    seen[root] = stamp;
+    *last_level = 0;
+    while(head < tail)
+    {
+        if(head == level_end)
+        {
+            depth++;
+            *last_level = head;
+            level_end = tail;
+        }
+        uint32_t current = queue[head++];
+        for(uint32_t i = graph->offsets[current]; i < graph->offsets[current + 1]; i++)
+        {
+            uint32_t connected = graph->targets[i];
+            if(placed[connected] != UINT32_MAX || seen[connected] == stamp)continue;
+            seen[connected] = stamp;
+            queue[tail++] = connected;
+        }
+    }
+    *reached = tail;
+    return depth;
+}
+
+/// @brief orders cities by degree, smallest first, cities of equal degree keep their order
+static void graphOrder_sortByDegree(const Graph* graph, uint32_t* nodes, uint32_t count)
+{
+    // the new neighbours of a city are usually a handful, hubs go through the radix sort
+    if(count > 32)
+    {
+        uint64_t* keyed = (uint64_t*)malloc(count * sizeof(uint64_t));
+        if(keyed == NULL)
+        {
+            perror("unable to malloc degree keys");
+            exit(0);
+        }
+        for(uint32_t i = 0; i < count; i++)
+            keyed[i] = (uint64_t)graph_degree(graph, nodes[i]) << 32 | nodes[i];
+        radixSortKeys(keyed, count);
+        for(uint32_t i = 0; i < count; i++)
+            nodes[i] = (uint32_t)keyed[i];
+        free(keyed);
+        return;
+    }
+    for(uint32_t i = 1; i < count; i++)
+    {
+        uint32_t node = nodes[i], degree = graph_degree(graph, node), j = i;
+        for(; j > 0 && graph_degree(graph, nodes[j - 1]) > degree; j--)
+            nodes[j] = nodes[j - 1];
+        nodes[j] = node;
+    }
+}
+
+/// @brief the position of a point along a Hilbert curve over a 2^16 by 2^16 square
+static uint32_t graphOrder_hilbert(uint32_t x, uint32_t y)
+{
+    uint32_t d = 0;
+    for(uint32_t s = 1u << 15; s > 0; s >>= 1)
+    {
+        uint32_t rx = (x & s) != 0, ry = (y & s) != 0;
+        d += s * s * ((3 * rx) ^ ry);
+        // turn the quadrant so the curve inside it starts where the last one ended
+        if(ry == 0)
+        {
+            if(rx == 1)
+            {
+                x = 0xffff - x;
+                y = 0xffff - y;
+            }
+            uint32_t swap = x;x = y;y = swap;
+        }
+    }
+    return d;
+}
+
+/// @brief computes a new numbering of the cities of a graph
+/// @param graph the graph to order
+/// @param kind the order to number the cities in
+/// @return a newly malloced array where entry v is the current id of the city
+///        that gets id v, pass it to graph_renumber
+uint32_t* graph_order(const Graph* graph, GraphOrder kind)
+{
+    uint32_t n = graph->num_nodes;
+    uint32_t* order = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    uint32_t* placed = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    if(order == NULL || placed == NULL)
+    {
+        perror("unable to malloc graph order");
+        exit(0);
+    }
+
+    if(kind == GRAPH_ORDER_HILBERT)
+    {
+        // the bounding box of the cities scaled down to 16 bits a side
+        int32_t min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+        for(uint32_t v = 0; v < n; v++)
+        {
+            const City* city = graph->cities + v;
+            if(v == 0 || city->x < min_x)min_x = city->x;
+            if(v == 0 || city->x > max_x)max_x = city->x;
+            if(v == 0 || city->y < min_y)min_y = city->y;
+            if(v == 0 || city->y > max_y)max_y = city->y;
+        }
+        uint64_t span = (uint64_t)((int64_t)max_x - min_x) > (uint64_t)((int64_t)max_y - min_y)
+            ? (uint64_t)((int64_t)max_x - min_x) : (uint64_t)((int64_t)max_y - min_y);
+        uint32_t shift = 0;
+        while(span >> shift > 0xffff)shift++;
+
+        uint64_t* keyed = (uint64_t*)malloc((n ? n : 1) * sizeof(uint64_t));
+        if(keyed == NULL)
+        {
+            perror("unable to malloc hilbert keys");
+            exit(0);
+        }
+        for(uint32_t v = 0; v < n; v++)
+        {
+            uint32_t key = graphOrder_hilbert((uint32_t)(((int64_t)graph->cities[v].x - min_x) >> shift),
+                (uint32_t)(((int64_t)graph->cities[v].y - min_y) >> shift));
+            keyed[v] = (uint64_t)key << 32 | v;
+        }
+        radixSortKeys(keyed, n);
+        for(uint32_t v = 0; v < n; v++)
+            order[v] = (uint32_t)keyed[v];
+        free(keyed);
+        free(placed);
+        return order;
+    }
+
+    // both breadth first orders use the order array as their queue, every
+    // component is searched in turn until every city has been placed
+    for(uint32_t v = 0; v < n; v++)
+        placed[v] = UINT32_MAX;
+    uint32_t* seen = NULL, *levels = NULL, *roots = NULL;
+    if(kind == GRAPH_ORDER_RCM)
+    {
+        seen = (uint32_t*)calloc(n ? n : 1, sizeof(uint32_t));
+        levels = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+        uint64_t* keyed = (uint64_t*)malloc((n ? n : 1) * sizeof(uint64_t));
+        roots = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+        if(!seen || !levels || !keyed || !roots)
+        {
+            perror("unable to allocate reverse Cuthill-McKee state");
+            exit(0);
+        }
+        // components are started from their lowest degree city
+        for(uint32_t v = 0; v < n; v++)
+            keyed[v] = (uint64_t)graph_degree(graph, v) << 32 | v;
+        radixSortKeys(keyed, n);
+        for(uint32_t v = 0; v < n; v++)
+            roots[v] = (uint32_t)keyed[v];
+        free(keyed);
+    }
+
+    uint32_t tail = 0, stamp = 0;
+    for(uint32_t r = 0; r < n; r++)
+    {
+        uint32_t root = roots ? roots[r] : r;
+        if(placed[root] != UINT32_MAX)continue;
+
+        if(kind == GRAPH_ORDER_RCM)
+        {
+            // George and Liu, move to the lowest degree city of the farthest
+            // level while that makes the component deeper
+            uint32_t last_level = 0, reached = 0;
+            uint32_t depth = graphOrder_levels(graph, root, placed, seen, ++stamp, levels, &last_level, &reached);
+            for(uint32_t tries = 0; tries < 8; tries++)
+            {
+                uint32_t candidate = levels[last_level];
+                for(uint32_t i = last_level + 1; i < reached; i++)
+                {
+                    if(graph_degree(graph, levels[i]) < graph_degree(graph, candidate))candidate = levels[i];
+                }
+                uint32_t candidate_depth = graphOrder_levels(graph, candidate, placed, seen, ++stamp, levels, &last_level, &reached);
+                if(candidate_depth <= depth)break;
+                root = candidate;
+                depth = candidate_depth;
+            }
+        }
+
+        uint32_t head = tail;
+        order[tail] = root;
+        placed[root] = tail++;
+        while(head < tail)
+        {
+            uint32_t current = order[head++], first = tail;
+            for(uint32_t i = graph->offsets[current]; i < graph->offsets[current + 1]; i++)
+            {
+                uint32_t connected = graph->targets[i];
+                if(placed[connected] != UINT32_MAX)continue;
+                order[tail] = connected;
+                placed[connected] = tail++;
+            }
+            // Cuthill-McKee queues the new neighbours of a city by degree
+            if(kind == GRAPH_ORDER_RCM)
+            {
+                graphOrder_sortByDegree(graph, order + first, tail - first);
+                for(uint32_t i = first; i < tail; i++)
+                    placed[order[i]] = i;
+            }
+        }
+    }
+
+    if(kind == GRAPH_ORDER_RCM)
+    {
+        for(uint32_t i = 0; i < n / 2; i++)
+        {
+            uint32_t swap = order[i];order[i] = order[n - 1 - i];order[n - 1 - i] = swap;
+        }
+        free(seen);
+        free(levels);
+        free(roots);
+    }
+    free(placed);
+    return order;
+}
+
+/// @brief renumbers the cities of a graph in place, the cities, connections
+///        and weights move to their new ids and every connection keeps its
+///        place among the connections of its city. The contraction hierarchy,
+///        landmarks and spatial index are dropped as they hold the old ids,
+///        rebuild them afterwards, and replanners of the graph must be recreated.
+///        A mapped graph is copied out of its file along with the city names.
+///        A graph other threads are searching, see graph_acquire, is left alone
+/// @param graph the graph to renumber
+/// @param order entry v is the current id of the city that gets id v, as
+///        returned by graph_order
+void graph_renumber(Graph* graph, const uint32_t* order)
+{
+    if(atomic_load_explicit(&graph->searchers, memory_order_acquire))
+    {
+        printf("The graph is being searched, it can not be renumbered now\n");
+        return;
+    }
+    uint32_t n = graph->num_nodes, m = graph->num_edges;
+    uint32_t* new_ids = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    uint32_t* original_ids = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    uint32_t* offsets = (uint32_t*)malloc((n + 1) * sizeof(uint32_t));
+    uint32_t* targets = (uint32_t*)malloc((m ? m : 1) * sizeof(uint32_t));
+    uint32_t* weights = (uint32_t*)malloc((m ? m : 1) * sizeof(uint32_t));
+    uint32_t* base_weights = graph->base_weights ? (uint32_t*)malloc((m ? m : 1) * sizeof(uint32_t)) : NULL;
+    City* cities = (City*)malloc((n ? n : 1) * sizeof(City));
+    if(!new_ids || !original_ids || !offsets || !targets || !weights || !cities || (graph->base_weights && !base_weights))
+    {
+        perror("unable to allocate renumbered graph");
+        exit(0);
+    }
+    for(uint32_t v = 0; v < n; v++)
+        new_ids[order[v]] = v;
+
+    offsets[0] = 0;
+    for(uint32_t v = 0; v < n; v++)
+    {
+        uint32_t old = order[v], slot = offsets[v];
+        for(uint32_t i = graph->offsets[old]; i < graph->offsets[old + 1]; i++, slot++)
+        {
+            targets[slot] = new_ids[graph->targets[i]];
+            weights[slot] = graph->weights[i];
+            if(base_weights)
+                base_weights[slot] = graph->base_weights[i];
+        }
+        offsets[v + 1] = slot;
+        cities[v] = graph->cities[old];
+        // renumbering twice still maps back to the ids the graph was built with
+        original_ids[v] = graph->original_ids ? graph->original_ids[old] : old;
+    }
+    uint32_t* reordered_ids = new_ids;
+    if(graph->reordered_ids)
+    {
+        // the ids from the last renumbering go through new_ids, which the
+        // composition reads all over, so it is written to an array of its own
+        reordered_ids = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+        if(reordered_ids == NULL)
+        {
+            perror("unable to malloc reordered ids");
+            exit(0);
+        }
+        for(uint32_t v = 0; v < n; v++)
+            reordered_ids[v] = new_ids[graph->reordered_ids[v]];
+        free(new_ids);
+    }
+
+    if(graph->mapping)
+    {
+        // the names point into the file, copy them into a pool the graph owns
+        size_t names_len = 0;
+        for(uint32_t v = 0; v < n; v++)
+            names_len += cities[v].name ? strlen(cities[v].name) + 1 : 0;
+        char* names = (char*)malloc(names_len ? names_len : 1), *cursor = names;
+        if(names == NULL)
+        {
+            perror("unable to malloc renumbered names");
+            exit(0);
+        }
+        for(uint32_t v = 0; v < n; v++)
+        {
+            if(cities[v].name == NULL)continue;
+            size_t len = strlen(cities[v].name) + 1;
+            memcpy(cursor, cities[v].name, len);
+            cities[v].name = cursor;
+            cursor += len;
+        }
+        munmap(graph->mapping, graph->mapping_len);
+        graph->mapping = NULL;
+        graph->mapping_len = 0;
+        graph->names = names;
+    }
+    else
+    {
+        free(graph->offsets);
+        free(graph->targets);
+        free(graph->base_weights ? graph->base_weights : graph->weights);
+    }
+    if(graph->base_weights)
+        free(graph->weights);
+    free(graph->cities);
+    free(graph->original_ids);
+    free(graph->reordered_ids);
+
+    graph->offsets = offsets;
+    graph->targets = targets;
+    graph->weights = weights;
+    graph->base_weights = base_weights;
+    graph->cities = cities;
+    graph->original_ids = original_ids;
+    graph->reordered_ids = reordered_ids;
+    if(graph->ch)
+        contractionHierarchy_free(graph->ch);
+    if(graph->landmarks)
+        landmarks_free(graph->landmarks);
+    if(graph->spatial)
+        spatialIndex_free(graph->spatial);
+    graph->ch = NULL;
+    graph->landmarks = NULL;
+    graph->spatial = NULL;
+    graph->version++;
+}
+
+/// @brief renumbers the cities of a graph in one of the orders of graph_order,
+///        see graph_renumber for what moves and what is dropped
+void graph_reorder(Graph* graph, GraphOrder kind)
+{
+    uint32_t* order = graph_order(graph, kind);
+    graph_renumber(graph, order);
+    free(order);
+}
@@ -0,0 +1,35 @@
+#ifndef GRAPH_ORDER_H
+#define GRAPH_ORDER_H
+
+#include <stdint.h>
+#include "graph.h"
+
+// Renumbers the cities so the ones a search visits together sit together in
+// memory. Cities are numbered in the order they were listed or imported,
+// which says nothing about which are connected, so every expansion of a large
+// graph reads cities and connections from all over the arrays. The orders
+// are breadth first, reverse Cuthill-McKee, which narrows the band the
+// connections of each city fall in, and a Hilbert curve over the coordinates
+typedef enum graph_order{
+    GRAPH_ORDER_BFS, // breadth first from the lowest id of each component
+    GRAPH_ORDER_RCM, // reverse Cuthill-McKee from a pseudo peripheral city of each component
+    GRAPH_ORDER_HILBERT // along a Hilbert curve over the bounding box of the coordinates
+} GraphOrder;
+
+uint32_t* graph_order(const Graph* graph, GraphOrder kind);
+void graph_renumber(Graph* graph, const uint32_t* order);
+void graph_reorder(Graph* graph, GraphOrder kind);
+
+/// @brief the id a city had when the graph was built, before any renumbering
+static inline uint32_t graph_originalId(const Graph* graph, uint32_t node)
+{
+    return graph->original_ids ? graph->original_ids[node] : node;
+}
+
+/// @brief the current id of a city from the id it had when the graph was built
+static inline uint32_t graph_reorderedId(const Graph* graph, uint32_t original)
+{
+    return graph->reordered_ids ? graph->reordered_ids[original] : original;
+}
+
+#endif
@@ -0,0 +1,133 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "landmarks.h"
+#include "containers.h"
+#include "graph.h"
+#include "relax_filter.h"
+
+/// @brief a one to all Dijkstra over raw CSR arrays
+/// @param num_nodes the number of nodes
+/// @param offsets the CSR offsets
+/// @param targets the CSR targets
+/// @param weights the CSR weights
+/// @param source the node to search from
+/// @param dist filled with the distance to every node, LANDMARK_UNREACHABLE when there is no path
+/// @param heap scratch heap, left empty
+void landmarks_dijkstra(uint32_t num_nodes, const uint32_t* offsets, const uint32_t* targets, const uint32_t* weights,
+    uint32_t source, uint32_t* dist, IHeap* heap)
+{
+    for(uint32_t v = 0; v < num_nodes; v++)
+        dist[v] = LANDMARK_UNREACHABLE;
+    dist[source] = 0;
+    iheap_push(heap, source, 0);
+
+    uint32_t current = 0;
+    uint64_t cost = 0;
+    while(iheap_pop(heap, &current, &cost))
+    {
+        for(uint32_t block = offsets[current]; block < offsets[current + 1]; block += RELAX_BLOCK)
+        {
+            uint32_t count = offsets[current + 1] - block < RELAX_BLOCK ? offsets[current + 1] - block : RELAX_BLOCK;
+            uint32_t mask = relaxFilter(targets + block, weights + block, count, NULL, 0, dist, cost);
+            for(; mask; mask &= mask - 1)
+            {
+                uint32_t i = block + __builtin_ctz(mask);
+                uint32_t connected = targets[i], new_cost = cost + weights[i];
+                if(weights[i] == CONNECTION_CLOSED || new_cost >= dist[connected])continue;
+                if(iheap_contains(heap, connected))
+                    iheap_decreaseKey(heap, connected, new_cost);
+                else
+                    iheap_push(heap, connected, new_cost);
+                dist[connected] = new_cost;
+            }
+        }
+    }
+}
+
+/// @brief picks landmarks and computes their distance tables, attach the
+///        result to graph->landmarks to make heuristic use it. The tables are
+///        measured over the lengths the graph was built with, which graph_setWeight
+///        never goes below, so they stay lower bounds whatever is changed later
+/// @param graph the graph to preprocess
+/// @param count the number of landmarks, more give tighter bounds but use
+///        2 * count distances per city
+/// @return newly allocated landmarks, freed along with the graph
+Landmarks* landmarks_build(const Graph* graph, uint32_t count)
+{
+    uint32_t n = graph->num_nodes;
+    if(count > n)count = n;
+
+    Landmarks* landmarks = (Landmarks*)calloc(1, sizeof(Landmarks));
+    uint32_t* dist = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    uint32_t* closest = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    if(landmarks == NULL || dist == NULL || closest == NULL)
+    {
+        perror("unable to allocate landmarks");
+        exit(0);
+    }
+    size_t table_len = (size_t)n * count;
+    if(table_len == 0)table_len = 1;
+    landmarks->count = count;
+    landmarks->nodes = (uint32_t*)malloc((count ? count : 1) * sizeof(uint32_t));
+    landmarks->from = (uint32_t*)malloc(table_len * sizeof(uint32_t));
+    landmarks->to = (uint32_t*)malloc(table_len * sizeof(uint32_t));
+    if(!landmarks->nodes || !landmarks->from || !landmarks->to)
+    {
+        perror("unable to allocate landmark tables");
+        exit(0);
+    }
+
+    // a road closed or lengthened now may be reopened or shortened again later,
+    // the distances have to come from the floor of every length instead
+    Graph built = *graph;
+    built.weights = graph->base_weights ? graph->base_weights : graph->weights;
+
+    // distances to a landmark are distances from it in the reversed graph
+    Graph* reversed = graph_transpose(&built);
+    IHeap heap = {0};
+
+    // farthest selection, the first landmark is the city farthest from city 0
+    // and every next one is the city farthest from its closest landmark so far,
+    // an unreachable city counts as infinitely far so every part of a
+    // disconnected graph gets a landmark of its own
+    landmarks_dijkstra(n, built.offsets, built.targets, built.weights, 0, closest, &heap);
+    for(uint32_t i = 0; i < count; i++)
+    {
+        uint32_t pick = 0;
+        for(uint32_t v = 1; v < n; v++)
+        {
+            if(closest[v] > closest[pick])pick = v;
+        }
+        landmarks->nodes[i] = pick;
+
+        landmarks_dijkstra(n, built.offsets, built.targets, built.weights, pick, dist, &heap);
+        for(uint32_t v = 0; v < n; v++)
+        {
+            landmarks->from[(size_t)v * count + i] = dist[v];
+            if(i == 0 || dist[v] < closest[v])closest[v] = dist[v];
+        }
+        closest[pick] = 0;
+
+        landmarks_dijkstra(n, reversed->offsets, reversed->targets, reversed->weights, pick, dist, &heap);
+        for(uint32_t v = 0; v < n; v++)
+            landmarks->to[(size_t)v * count + i] = dist[v];
+    }
+
+    iheap_free(&heap);
+    graph_free(reversed);
+    free(dist);
+    free(closest);
+    return landmarks;
+}
+
+/// @brief releases the memory held by landmarks
+void landmarks_free(Landmarks* landmarks)
+{
+    free(landmarks->nodes);
+    free(landmarks->from);
+    free(landmarks->to);
+    free(landmarks);
+}
@@ -0,0 +1,55 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "containers.h"
+#include "graph.h"
+
+// A handful of landmark cities with the exact distance from every city to
+// each landmark and from each landmark to every city. By the triangle
+// inequality d(v, t) >= d(v, L) - d(t, L) and d(v, t) >= d(L, t) - d(L, v)
+// for every landmark L, the largest of these bounds is a consistent
+// heuristic for any pair of cities, not just for trips to Bucharest
+#define LANDMARK_UNREACHABLE UINT32_MAX
+
+struct landmarks{
+    uint32_t count; // the number of landmarks
+    uint32_t* nodes; // the city each landmark is
+    uint32_t* from; // from[v * count + i] is the distance from landmark i to v
+    uint32_t* to; // to[v * count + i] is the distance from v to landmark i
+};
+
+void landmarks_dijkstra(uint32_t num_nodes, const uint32_t* offsets, const uint32_t* targets, const uint32_t* weights,
+    uint32_t source, uint32_t* dist, IHeap* heap);
+Landmarks* landmarks_build(const Graph* graph, uint32_t count);
+void landmarks_free(Landmarks* landmarks);
+
+/// @brief the landmark lower bound on the cost of travelling between two cities
+/// @param landmarks the landmark tables
+/// @param node the id of the city the estimate is from
+/// @param target the id of the city the estimate is to
+/// @return the largest bound any landmark gives
+static inline uint32_t landmarks_bound(const Landmarks* landmarks, uint32_t node, uint32_t target)
+{
+    const uint32_t* node_to = landmarks->to + (size_t)node * landmarks->count;
+    const uint32_t* target_to = landmarks->to + (size_t)target * landmarks->count;
+    const uint32_t* node_from = landmarks->from + (size_t)node * landmarks->count;
+    const uint32_t* target_from = landmarks->from + (size_t)target * landmarks->count;
+    uint32_t best = 0;
+
+    for(uint32_t i = 0; i < landmarks->count; i++)
+    {
+        // a landmark that cannot reach or be reached from one of the
+        // cities says nothing about the distance between them
+        if(node_to[i] != LANDMARK_UNREACHABLE && target_to[i] != LANDMARK_UNREACHABLE && node_to[i] > target_to[i]
+            && node_to[i] - target_to[i] > best)
+            best = node_to[i] - target_to[i];
+        if(node_from[i] != LANDMARK_UNREACHABLE && target_from[i] != LANDMARK_UNREACHABLE && target_from[i] > node_from[i]
+            && target_from[i] - node_from[i] > best)
+            best = target_from[i] - node_from[i];
+    }
+    return best;
+}
+
+#endif
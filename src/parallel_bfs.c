@@ -0,0 +1,260 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "parallel_bfs.h"
+#include "graph.h"
+#include "search_context.h"
+#include "thread_pool.h"
+
+// A level synchronous breadth first search that builds the whole hop count
+// tree of a graph across the workers of a thread pool, one round per level.
+// Small levels are expanded top down from a list of the frontier cities, the
+// workers follow the connections leaving the frontier and claim each city
+// they reach with a compare and swap on its parent. Once the connections
+// leaving the frontier outnumber those of the unreached cities by
+// PARALLEL_BFS_ALPHA the frontier is turned into a bitmap and the level is run
+// bottom up instead, every unreached city looks through the connections coming
+// into it for a parent in the bitmap and stops at the first, which skips most
+// of the work on the wide middle levels of small world graphs (Beamer's
+// direction optimizing search). Only a growing frontier switches to bottom up
+// and a shrinking one goes back to top down once it is smaller than
+// 1 / PARALLEL_BFS_BETA of the graph, so the tail of a long thin search whose
+// few unexplored connections make the first test pass stays top down
+#define PARALLEL_BFS_ALPHA 14
+#define PARALLEL_BFS_BETA 24
+#define PARALLEL_BFS_CHUNK 256 // frontier cities, or bitmap words of 64 cities, claimed at a time
+#define PARALLEL_BFS_INLINE_EDGES 4096 // levels with fewer connections to follow skip the thread handoff
+
+/// @brief creates a parallel breadth first search with its own worker threads
+/// @param graph the graph to search, it is reversed here for bottom up levels and
+///        again by the first run after its weights change
+/// @param num_workers the number of workers, 0 uses one per online core
+/// @return a new search, free it with parallelBfs_free
+ParallelBfs* parallelBfs_create(const Graph* graph, uint32_t num_workers)
+{
+    ParallelBfs* bfs = (ParallelBfs*)calloc(1, sizeof(ParallelBfs));
+    if(bfs == NULL)
+    {
+        perror("unable to calloc parallel breadth first search");
+        exit(0);
+    }
+    uint32_t len = graph->num_nodes ? graph->num_nodes : 1;
+    bfs->graph = graph;
+    bfs->reverse = graph_transpose(graph);
+    bfs->reverse_version = atomic_load(&graph->version);
+    bfs->pool = threadPool_create(num_workers);
+    bfs->num_words = (len + 63) / 64;
+    bfs->bitmap = (uint64_t*)calloc(bfs->num_words, sizeof(uint64_t));
+    bfs->frontier = (uint32_t*)malloc(len * sizeof(uint32_t));
+    bfs->next = (uint32_t*)malloc(len * sizeof(uint32_t));
+    bfs->parents = (_Atomic uint32_t*)malloc(len * sizeof(uint32_t));
+    bfs->levels = (uint32_t*)malloc(len * sizeof(uint32_t));
+    bfs->counts = (ParallelBfsCounts*)aligned_alloc(64, bfs->pool->num_workers * sizeof(ParallelBfsCounts));
+    if(!bfs->bitmap || !bfs->frontier || !bfs->next || !bfs->parents || !bfs->levels || !bfs->counts)
+    {
+        perror("unable to allocate parallel breadth first search arrays");
+        exit(0);
+    }
+    return bfs;
+}
+
+/// @brief claims the next chunk of the work of the current round
+/// @param bfs the search
+/// @param limit the number of frontier cities or bitmap words in the round
+/// @return false once everything has been claimed
+static bool parallelBfs_claim(ParallelBfs* bfs, uint32_t limit, uint32_t* begin, uint32_t* end)
+{
+    uint32_t claimed = atomic_fetch_add_explicit(&bfs->next_claim, PARALLEL_BFS_CHUNK, memory_order_relaxed);
+    if(claimed >= limit)return false;
+    *begin = claimed;
+    *end = claimed + PARALLEL_BFS_CHUNK < limit ? claimed + PARALLEL_BFS_CHUNK : limit;
+    return true;
+}
+
+/// @brief appends the cities a worker found to the next level
+static void parallelBfs_flush(ParallelBfs* bfs, const uint32_t* found, uint32_t count)
+{
+    if(count == 0)return;
+    uint32_t at = atomic_fetch_add_explicit(&bfs->next_len, count, memory_order_relaxed);
+    memcpy(bfs->next + at, found, count * sizeof(uint32_t));
+}
+
+/// @brief the pool task that forgets the previous search
+static void parallelBfs_clear(void* arg, uint32_t worker)
+{
+    ParallelBfs* bfs = (ParallelBfs*)arg;
+    uint32_t begin = 0, end = 0;
+    (void)worker;
+    while(parallelBfs_claim(bfs, bfs->graph->num_nodes, &begin, &end))
+    {
+        for(uint32_t v = begin; v < end; v++)
+        {
+            atomic_store_explicit(&bfs->parents[v], NO_PARENT, memory_order_relaxed);
+            bfs->levels[v] = PARALLEL_BFS_UNREACHED;
+        }
+    }
+}
+
+/// @brief the pool task that builds the next level from the frontier
+static void parallelBfs_step(void* arg, uint32_t worker)
+{
+    ParallelBfs* bfs = (ParallelBfs*)arg;
+    const Graph* graph = bfs->graph;
+    const Graph* reverse = bfs->reverse;
+    ParallelBfsCounts counts = {0};
+    uint32_t found[PARALLEL_BFS_CHUNK];
+    uint32_t num_found = 0, begin = 0, end = 0;
+
+    // cities found are gathered locally and appended to the next level in
+    // blocks, so the shared length is only touched once per block
+    #define parallelBfs_found(city) do{ \
+            if(num_found == PARALLEL_BFS_CHUNK) \
+            { \
+                parallelBfs_flush(bfs, found, num_found); \
+                num_found = 0; \
+            } \
+            found[num_found++] = city; \
+            counts.cities++; \
+            counts.edges += graph->offsets[(city) + 1] - graph->offsets[city]; \
+        }while(0)
+
+    if(bfs->bottom_up)
+    {
+        // every unreached city belongs to exactly one worker, so no swaps are needed
+        while(parallelBfs_claim(bfs, bfs->num_words, &begin, &end))
+        {
+            uint32_t last = end * 64 < graph->num_nodes ? end * 64 : graph->num_nodes;
+            for(uint32_t v = begin * 64; v < last; v++)
+            {
+                if(bfs->levels[v] != PARALLEL_BFS_UNREACHED)continue;
+                for(uint32_t i = reverse->offsets[v]; i < reverse->offsets[v + 1]; i++)
+                {
+                    uint32_t from = reverse->targets[i];
+                    if(reverse->weights[i] == CONNECTION_CLOSED)continue;
+                    if(!(bfs->bitmap[from / 64] >> (from % 64) & 1))continue;
+                    atomic_store_explicit(&bfs->parents[v], from, memory_order_relaxed);
+                    bfs->levels[v] = bfs->level;
+                    parallelBfs_found(v);
+                    break;
+                }
+            }
+        }
+    }
+    else
+    {
+        // several workers can reach the same city, it goes to whichever one
+        // swaps its parent first
+        while(parallelBfs_claim(bfs, bfs->frontier_len, &begin, &end))
+        {
+            for(uint32_t f = begin; f < end; f++)
+            {
+                uint32_t v = bfs->frontier[f];
+                for(uint32_t i = graph->offsets[v]; i < graph->offsets[v + 1]; i++)
+                {
+                    uint32_t connected = graph->targets[i], expected = NO_PARENT;
+                    if(graph->weights[i] == CONNECTION_CLOSED)continue;
+                    if(atomic_load_explicit(&bfs->parents[connected], memory_order_relaxed) != NO_PARENT)continue;
+                    if(!atomic_compare_exchange_strong_explicit(&bfs->parents[connected], &expected, v, memory_order_relaxed, memory_order_relaxed))continue;
+                    bfs->levels[connected] = bfs->level;
+                    parallelBfs_found(connected);
+                }
+            }
+        }
+    }
+    #undef parallelBfs_found
+
+    parallelBfs_flush(bfs, found, num_found);
+    bfs->counts[worker] = counts;
+}
+
+/// @brief builds the breadth first tree of every city reachable from a source,
+///        afterwards bfs->parents and bfs->levels hold the tree and hop counts
+/// @param bfs the search to run
+/// @param source the city at the root of the tree
+/// @param direction_optimizing false to run every level top down
+/// @return the number of cities reached, including the source
+uint32_t parallelBfs_run(ParallelBfs* bfs, uint32_t source, bool direction_optimizing)
+{
+    const Graph* graph = bfs->graph;
+    uint32_t num_workers = bfs->pool->num_workers;
+
+    // the reversed connections carry the weights they had when reversed, a
+    // road closed or reopened since then has to be seen by the bottom up levels
+    uint64_t version = atomic_load(&graph->version);
+    if(version != bfs->reverse_version)
+    {
+        graph_free(bfs->reverse);
+        bfs->reverse = graph_transpose(graph);
+        bfs->reverse_version = version;
+    }
+    atomic_store(&bfs->next_claim, 0);
+    threadPool_run(bfs->pool, parallelBfs_clear, bfs);
+
+    // the source is its own parent while running so no worker can claim it
+    bfs->levels[source] = 0;
+    atomic_store(&bfs->parents[source], source);
+    bfs->frontier[0] = source;
+    bfs->frontier_len = 1;
+    uint64_t frontier_edges = graph->offsets[source + 1] - graph->offsets[source];
+    uint64_t unexplored_edges = graph->num_edges - frontier_edges, reached = 1;
+    uint32_t previous_len = 0;
+    bfs->bottom_up = false;
+
+    for(bfs->level = 1; bfs->frontier_len > 0; bfs->level++)
+    {
+        bool growing = bfs->frontier_len > previous_len;
+        if(direction_optimizing && !bfs->bottom_up && growing && frontier_edges > unexplored_edges / PARALLEL_BFS_ALPHA)
+            bfs->bottom_up = true;
+        else if(bfs->bottom_up && !growing && bfs->frontier_len < graph->num_nodes / PARALLEL_BFS_BETA)
+            bfs->bottom_up = false;
+        if(bfs->bottom_up)
+        {
+            memset(bfs->bitmap, 0, bfs->num_words * sizeof(uint64_t));
+            for(uint32_t f = 0; f < bfs->frontier_len; f++)
+                bfs->bitmap[bfs->frontier[f] / 64] |= 1ull << (bfs->frontier[f] % 64);
+        }
+
+        // a thin level of a long chain of them costs less than waking the pool
+        atomic_store(&bfs->next_claim, 0);
+        atomic_store(&bfs->next_len, 0);
+        if(!bfs->bottom_up && frontier_edges < PARALLEL_BFS_INLINE_EDGES)
+        {
+            memset(bfs->counts, 0, num_workers * sizeof(ParallelBfsCounts));
+            parallelBfs_step(bfs, 0);
+        }
+        else
+            threadPool_run(bfs->pool, parallelBfs_step, bfs);
+
+        frontier_edges = 0;
+        for(uint32_t i = 0; i < num_workers; i++)
+            frontier_edges += bfs->counts[i].edges;
+        unexplored_edges -= frontier_edges < unexplored_edges ? frontier_edges : unexplored_edges;
+
+        // the level just built is expanded next
+        uint32_t* swap = bfs->frontier;
+        bfs->frontier = bfs->next;
+        bfs->next = swap;
+        previous_len = bfs->frontier_len;
+        bfs->frontier_len = atomic_load(&bfs->next_len);
+        reached += bfs->frontier_len;
+    }
+    atomic_store(&bfs->parents[source], NO_PARENT);
+    return (uint32_t)reached;
+}
+
+/// @brief stops the workers and releases the search, the graph is not freed
+void parallelBfs_free(ParallelBfs* bfs)
+{
+    threadPool_free(bfs->pool);
+    graph_free(bfs->reverse);
+    free(bfs->bitmap);
+    free(bfs->frontier);
+    free(bfs->next);
+    free((void*)bfs->parents);
+    free(bfs->levels);
+    free(bfs->counts);
+    free(bfs);
+}
@@ -0,0 +1,42 @@
+#ifndef PARALLEL_BFS_H
+#define PARALLEL_BFS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "graph.h"
+#include "thread_pool.h"
+
+#define PARALLEL_BFS_UNREACHED UINT32_MAX
+
+// what one worker added to the next level, padded so workers do not share a cache line
+typedef struct parallel_bfs_counts{
+    uint64_t cities; // the number of cities added
+    uint64_t edges; // the number of connections leaving them
+    char padding[48];
+} ParallelBfsCounts;
+
+typedef struct parallel_bfs{
+    const Graph* graph; // the graph being searched
+    Graph* reverse; // the graph with every connection reversed, for bottom up levels
+    uint64_t reverse_version; // the graph version reverse was built from
+    ThreadPool* pool; // the workers
+    uint32_t num_words; // the length of the frontier bitmap in 64 bit words
+    uint64_t* bitmap; // bit v is set when v is in the frontier, only built for bottom up levels
+    uint32_t* frontier; // the cities of the level being expanded
+    uint32_t frontier_len;
+    uint32_t* next; // the cities of the level being built
+    _Atomic uint32_t next_len;
+    _Atomic uint32_t* parents; // the city each city was reached from, NO_PARENT for the source
+    uint32_t* levels; // the number of hops to each city or PARALLEL_BFS_UNREACHED
+    ParallelBfsCounts* counts; // one per worker, for the current round
+    _Atomic uint32_t next_claim; // the first frontier city or bitmap word not yet claimed this round
+    uint32_t level; // the level being built
+    bool bottom_up; // the direction of the current round
+} ParallelBfs;
+
+ParallelBfs* parallelBfs_create(const Graph* graph, uint32_t num_workers);
+uint32_t parallelBfs_run(ParallelBfs* bfs, uint32_t source, bool direction_optimizing);
+void parallelBfs_free(ParallelBfs* bfs);
+
+#endif
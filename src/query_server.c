@@ -0,0 +1,467 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+#include "query_server.h"
+#include "graph.h"
+#include "spatial_index.h"
+#include "search.h"
+#include "anytime_search.h"
+#include "contraction_hierarchy.h"
+#include "batch_engine.h"
+
+#ifdef __linux__
+// A long running server that keeps one graph loaded and answers route
+// requests from local clients over a Unix domain socket. Requests and
+// responses are lines of text:
+//
+//     <search> <start> <end>\n
+//     ok <cost> <elapsed_ns> <length> <id> <id> ...\n
+//     none <elapsed_ns>\n
+//     error <reason>\n
+//
+// where search is one of the names in server_searches and start/end are city
+// ids or "x,y" points that are snapped to their nearest city when the graph
+// has a spatial index. A build with -DSEARCH_STATS puts the number of cities
+// the search expanded after elapsed_ns on ok and none lines. Clients may pipeline any number of requests without
+// waiting and get the responses back in the order they sent them. One thread
+// runs an epoll loop, every wakeup it reads the requests that arrived on all
+// connections, answers them together on a batch engine and queues the
+// responses to be written as the sockets accept them
+#define SERVER_MAX_LINE 256 // a longer request is an error and closes the connection
+#define SERVER_OUTPUT_LIMIT (1u << 20) // stop reading a connection whose client is this far behind
+#define SERVER_MAX_EVENTS 64
+#define SERVER_MAX_ROUND 4096 // requests answered together before any more are read
+
+// a search a request can ask for by name
+typedef struct server_search{
+    const char* name;
+    Algo* algo;
+} ServerSearch;
+
+static const ServerSearch server_searches[] = {
+    {"bfs", breadthFirst},
+    {"dfs", depthFirst},
+    {"astar", AStar},
+    {"bibfs", bidirectionalBreadthFirst},
+    {"biastar", bidirectionalAStar},
+    {"ch", contractionHierarchySearch},
+    {"wastar", weightedAStar},
+    {"arastar", anytimeAStar},
+};
+
+/// @brief changes the events a descriptor is registered for with epoll
+static void queryServer_watch(QueryServer* server, ServerConnection* conn, uint32_t events)
+{
+    if(conn->events == events)return;
+    struct epoll_event event = {0};
+    event.events = events;
+    event.data.ptr = conn;
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+    conn->events = events;
+}
+
+/// @brief opens the socket and starts the workers of a query server
+/// @param graph the graph to answer requests on, it must outlive the server
+/// @param socket_path the path of the Unix socket, an old socket there is replaced
+/// @param num_workers the number of search workers, 0 uses one per online core
+/// @return a new server or NULL if the socket can not be opened, free it with queryServer_free
+QueryServer* queryServer_create(const Graph* graph, const char* socket_path, uint32_t num_workers)
+{
+    struct sockaddr_un address = {0};
+    address.sun_family = AF_UNIX;
+    if(strlen(socket_path) >= sizeof(address.sun_path))
+    {
+        printf("socket path %s is too long\n", socket_path);
+        return NULL;
+    }
+    strcpy(address.sun_path, socket_path);
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(listen_fd < 0)
+    {
+        perror("unable to open server socket");
+        return NULL;
+    }
+    unlink(socket_path);
+    if(bind(listen_fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listen_fd, 128) != 0)
+    {
+        perror(socket_path);
+        close(listen_fd);
+        return NULL;
+    }
+
+    QueryServer* server = (QueryServer*)calloc(1, sizeof(QueryServer));
+    if(server == NULL || (server->socket_path = strdup(socket_path)) == NULL)
+    {
+        perror("unable to allocate query server");
+        exit(0);
+    }
+    server->graph = graph;
+    server->listen_fd = listen_fd;
+    server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    server->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(server->epoll_fd < 0 || server->wake_fd < 0)
+    {
+        perror("unable to create server events");
+        exit(0);
+    }
+    // the listening socket and the eventfd are told apart from connections by their pointers
+    struct epoll_event event = {0};
+    event.events = EPOLLIN;
+    event.data.ptr = &server->listen_fd;
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, listen_fd, &event);
+    event.data.ptr = &server->wake_fd;
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->wake_fd, &event);
+    server->engine = batchEngine_create(graph, num_workers);
+    return server;
+}
+
+/// @brief asks a running server to return from queryServer_run, safe to call
+///        from any thread and from a signal handler
+void queryServer_stop(QueryServer* server)
+{
+    uint64_t one = 1;
+    atomic_store(&server->stopping, true);
+    if(write(server->wake_fd, &one, sizeof(one)) < 0){}
+}
+
+/// @brief closes a connection and releases its buffers
+static void queryServer_close(QueryServer* server, ServerConnection* conn)
+{
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    if(conn->prev)conn->prev->next = conn->next;
+    else server->connections = conn->next;
+    if(conn->next)conn->next->prev = conn->prev;
+    free(conn->in);
+    free(conn->out);
+    free(conn);
+}
+
+/// @brief accepts every waiting connection
+static void queryServer_accept(QueryServer* server)
+{
+    int fd = 0;
+    while((fd = accept(server->listen_fd, NULL, NULL)) >= 0)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        ServerConnection* conn = (ServerConnection*)calloc(1, sizeof(ServerConnection));
+        if(conn == NULL || (conn->in = (char*)malloc(SERVER_MAX_LINE)) == NULL)
+        {
+            perror("unable to allocate server connection");
+            exit(0);
+        }
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+        conn->next = server->connections;
+        if(conn->next)conn->next->prev = conn;
+        server->connections = conn;
+        struct epoll_event event = {0};
+        event.events = EPOLLIN;
+        event.data.ptr = conn;
+        epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+/// @brief appends text to the responses of a connection
+static void serverConnection_write(ServerConnection* conn, const char* text, size_t len)
+{
+    if(conn->out_len + len > conn->out_cap)
+    {
+        size_t cap = conn->out_cap ? conn->out_cap * 2 : 4096;
+        while(cap < conn->out_len + len)cap *= 2;
+        char* grown = (char*)realloc(conn->out, cap);
+        if(grown == NULL)
+        {
+            perror("unable to realloc server output");
+            exit(0);
+        }
+        conn->out = grown;
+        conn->out_cap = cap;
+    }
+    memcpy(conn->out + conn->out_len, text, len);
+    conn->out_len += len;
+}
+
+/// @brief reads a city from a request, an id or an "x,y" point to snap
+/// @return false if the text is neither
+static bool queryServer_parseCity(const QueryServer* server, const char* text, uint32_t* node)
+{
+    char* end = NULL;
+    if(strchr(text, ',') != NULL)
+    {
+        long x = strtol(text, &end, 10);
+        if(*end != ',' || server->graph->spatial == NULL)return false;
+        long y = strtol(end + 1, &end, 10);
+        if(*end != '\0')return false;
+        *node = spatialIndex_nearest(server->graph->spatial, (int32_t)x, (int32_t)y);
+        return *node != SPATIAL_NONE;
+    }
+    unsigned long id = strtoul(text, &end, 10);
+    if(end == text || *end != '\0' || id >= server->graph->num_nodes)return false;
+    *node = (uint32_t)id;
+    return true;
+}
+
+/// @brief parses one request line into the current round
+static void queryServer_parse(QueryServer* server, ServerConnection* conn, char* line)
+{
+    if(server->num_requests == server->capacity)
+    {
+        uint32_t capacity = server->capacity ? server->capacity * 2 : 256;
+        ServerRequest* requests = (ServerRequest*)realloc(server->requests, capacity * sizeof(ServerRequest));
+        RouteJob* jobs = (RouteJob*)realloc(server->jobs, capacity * sizeof(RouteJob));
+        RouteResult* results = (RouteResult*)realloc(server->results, capacity * sizeof(RouteResult));
+        if(!requests || !jobs || !results)
+        {
+            perror("unable to realloc server requests");
+            exit(0);
+        }
+        server->requests = requests;
+        server->jobs = jobs;
+        server->results = results;
+        server->capacity = capacity;
+    }
+    ServerRequest* request = &server->requests[server->num_requests++];
+    *request = (ServerRequest){conn, server->num_jobs, NULL};
+
+    char* save = NULL;
+    char* name = strtok_r(line, " \t\r", &save);
+    char* start = name ? strtok_r(NULL, " \t\r", &save) : NULL;
+    char* end = start ? strtok_r(NULL, " \t\r", &save) : NULL;
+    if(end == NULL || strtok_r(NULL, " \t\r", &save) != NULL)
+    {
+        request->error = "expected <search> <start> <end>";
+        return;
+    }
+    RouteJob job = {0};
+    for(uint32_t i = 0; i < sizeof(server_searches) / sizeof(server_searches[0]); i++)
+    {
+        if(strcmp(name, server_searches[i].name) == 0)job.algo = server_searches[i].algo;
+    }
+    if(job.algo == NULL)
+        request->error = "unknown search";
+    else if(!queryServer_parseCity(server, start, &job.start) || !queryServer_parseCity(server, end, &job.end))
+        request->error = "unknown city";
+    else
+        server->jobs[server->num_jobs++] = job;
+}
+
+/// @brief reads what a connection has received and parses its whole lines
+/// @return false if the connection broke a rule of the protocol and was closed
+static bool queryServer_read(QueryServer* server, ServerConnection* conn)
+{
+    while(true)
+    {
+        ssize_t got = recv(conn->fd, conn->in + conn->in_len, SERVER_MAX_LINE - conn->in_len, 0);
+        if(got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            conn->closing = true;
+            break;
+        }
+        if(got < 0)
+        {
+            if(errno == EINTR)continue;
+            break;
+        }
+        conn->in_len += (uint32_t)got;
+
+        // every whole line is a request, the rest waits for more bytes
+        uint32_t consumed = 0;
+        for(uint32_t i = 0; i < conn->in_len; i++)
+        {
+            if(conn->in[i] != '\n')continue;
+            conn->in[i] = '\0';
+            if(i > consumed)
+                queryServer_parse(server, conn, conn->in + consumed);
+            consumed = i + 1;
+        }
+        memmove(conn->in, conn->in + consumed, conn->in_len - consumed);
+        conn->in_len -= consumed;
+        if(conn->in_len == SERVER_MAX_LINE)
+        {
+            const char* error = "error request too long\n";
+            if(send(conn->fd, error, strlen(error), MSG_NOSIGNAL)){}
+            return false;
+        }
+        // the rest waits in the socket for the next round so responses start flowing
+        if(server->num_requests >= SERVER_MAX_ROUND)break;
+    }
+    return true;
+}
+
+/// @brief writes as much of the queued responses of a connection as the socket takes
+/// @return false if the connection is done and was closed
+static bool queryServer_flush(QueryServer* server, ServerConnection* conn)
+{
+    while(conn->out_sent < conn->out_len)
+    {
+        ssize_t sent = send(conn->fd, conn->out + conn->out_sent, conn->out_len - conn->out_sent, MSG_NOSIGNAL);
+        if(sent < 0 && errno == EINTR)continue;
+        if(sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))break;
+        if(sent < 0)
+        {
+            queryServer_close(server, conn);
+            return false;
+        }
+        conn->out_sent += (size_t)sent;
+    }
+    if(conn->out_sent == conn->out_len)
+        conn->out_sent = conn->out_len = 0;
+    if(conn->closing && conn->out_len == 0)
+    {
+        queryServer_close(server, conn);
+        return false;
+    }
+
+    // wait for room when the socket is full and stop reading while the client lags
+    uint32_t events = 0;
+    if(!conn->closing && conn->out_len - conn->out_sent <= SERVER_OUTPUT_LIMIT)events |= EPOLLIN;
+    if(conn->out_len > conn->out_sent)events |= EPOLLOUT;
+    queryServer_watch(server, conn, events);
+    return true;
+}
+
+/// @brief drops what a closing connection already asked for this round, the
+///        jobs of the other requests move down with them so no search runs
+///        for a request that will not be answered
+static void queryServer_drop(QueryServer* server, ServerConnection* conn)
+{
+    uint32_t kept = 0, kept_jobs = 0;
+    for(uint32_t r = 0; r < server->num_requests; r++)
+    {
+        ServerRequest request = server->requests[r];
+        if(request.conn == conn)continue;
+        // only requests that parsed have a job
+        if(request.error == NULL)
+        {
+            server->jobs[kept_jobs] = server->jobs[request.job];
+            request.job = kept_jobs++;
+        }
+        server->requests[kept++] = request;
+    }
+    server->num_requests = kept;
+    server->num_jobs = kept_jobs;
+}
+
+/// @brief answers every request of the round and queues the responses in order
+static void queryServer_answer(QueryServer* server)
+{
+    batchEngine_run(server->engine, server->jobs, server->results, server->num_jobs);
+
+    char text[64];
+    for(uint32_t r = 0; r < server->num_requests; r++)
+    {
+        const ServerRequest* request = &server->requests[r];
+        ServerConnection* conn = request->conn;
+        if(request->error)
+        {
+            int len = snprintf(text, sizeof(text), "error %s\n", request->error);
+            serverConnection_write(conn, text, (size_t)len);
+            continue;
+        }
+        RouteResult* result = &server->results[request->job];
+        if(result->path == NULL)
+        {
+#ifdef SEARCH_STATS
+            int len = snprintf(text, sizeof(text), "none %llu %llu\n", (unsigned long long)result->elapsed_ns,
+                (unsigned long long)result->expanded);
+#else
+            int len = snprintf(text, sizeof(text), "none %llu\n", (unsigned long long)result->elapsed_ns);
+#endif
+            serverConnection_write(conn, text, (size_t)len);
+            continue;
+        }
+#ifdef SEARCH_STATS
+        int len = snprintf(text, sizeof(text), "ok %u %llu %llu %u", result->cost, (unsigned long long)result->elapsed_ns,
+            (unsigned long long)result->expanded, result->length);
+#else
+        int len = snprintf(text, sizeof(text), "ok %u %llu %u", result->cost, (unsigned long long)result->elapsed_ns, result->length);
+#endif
+        serverConnection_write(conn, text, (size_t)len);
+        for(uint32_t i = 0; i < result->length; i++)
+        {
+            len = snprintf(text, sizeof(text), " %u", graph_cityId(server->graph, result->path[i]));
+            serverConnection_write(conn, text, (size_t)len);
+        }
+        serverConnection_write(conn, "\n", 1);
+        free(result->path);
+    }
+}
+
+/// @brief serves requests until queryServer_stop is called
+void queryServer_run(QueryServer* server)
+{
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    while(!atomic_load(&server->stopping))
+    {
+        int ready = epoll_wait(server->epoll_fd, events, SERVER_MAX_EVENTS, -1);
+        if(ready < 0)
+        {
+            if(errno == EINTR)continue;
+            perror("epoll_wait");
+            break;
+        }
+
+        // gather the requests of every readable connection into one round
+        server->num_requests = server->num_jobs = 0;
+        for(int i = 0; i < ready; i++)
+        {
+            void* source = events[i].data.ptr;
+            if(source == &server->listen_fd)
+                queryServer_accept(server);
+            else if(source != &server->wake_fd && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+            {
+                ServerConnection* conn = (ServerConnection*)source;
+                if(server->num_requests >= SERVER_MAX_ROUND)continue;
+                if(!queryServer_read(server, conn))
+                {
+                    queryServer_drop(server, conn);
+                    queryServer_close(server, conn);
+                    events[i].data.ptr = NULL;
+                }
+            }
+        }
+        if(server->num_requests)
+            queryServer_answer(server);
+
+        // write the responses, and finish connections that only had output pending
+        for(int i = 0; i < ready; i++)
+        {
+            void* source = events[i].data.ptr;
+            if(source == NULL || source == &server->listen_fd || source == &server->wake_fd)continue;
+            queryServer_flush(server, (ServerConnection*)source);
+        }
+    }
+}
+
+/// @brief closes every connection and the socket and releases the server, the graph is not freed
+void queryServer_free(QueryServer* server)
+{
+    while(server->connections)
+        queryServer_close(server, server->connections);
+    batchEngine_free(server->engine);
+    close(server->listen_fd);
+    close(server->epoll_fd);
+    close(server->wake_fd);
+    unlink(server->socket_path);
+    free(server->socket_path);
+    free(server->requests);
+    free(server->jobs);
+    free(server->results);
+    free(server);
+}
+#endif
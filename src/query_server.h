@@ -0,0 +1,52 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "graph.h"
+#include "batch_engine.h"
+
+#ifdef __linux__
+// a client connection and the bytes waiting to be read and written
+typedef struct server_connection{
+    int fd;
+    char* in; // received bytes that do not make up a whole request yet
+    uint32_t in_len;
+    char* out; // responses not written yet
+    size_t out_len, out_sent, out_cap;
+    uint32_t events; // the epoll events the connection is registered for
+    bool closing; // the client closed its end, close once the responses are written
+    struct server_connection* prev, *next; // the other open connections
+} ServerConnection;
+
+// a parsed request of the current round, in arrival order
+typedef struct server_request{
+    ServerConnection* conn; // the connection the response goes to
+    uint32_t job; // the index of its job in the round
+    const char* error; // why the request could not be run, else NULL
+} ServerRequest;
+
+typedef struct query_server{
+    const Graph* graph;
+    BatchEngine* engine; // runs the searches, set engine->cache to cache routes
+    int listen_fd; // the listening socket
+    int epoll_fd;
+    int wake_fd; // an eventfd that queryServer_stop writes to
+    char* socket_path; // removed again when the server is freed
+    _Atomic bool stopping;
+    ServerConnection* connections; // every open connection, closed when the server is freed
+    ServerRequest* requests; // the requests of the current round
+    RouteJob* jobs; // the searches of the current round
+    RouteResult* results;
+    uint32_t num_requests, num_jobs, capacity;
+} QueryServer;
+
+QueryServer* queryServer_create(const Graph* graph, const char* socket_path, uint32_t num_workers);
+void queryServer_stop(QueryServer* server);
+void queryServer_run(QueryServer* server);
+void queryServer_free(QueryServer* server);
+#endif
+
+#endif
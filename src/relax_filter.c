@@ -0,0 +1,100 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+#include "relax_filter.h"
+#include "graph.h"
+
+RelaxFilter* _Atomic relax_filter = NULL;
+
+/// @brief the filter that lets every connection through, the scan the searches did before
+uint32_t relaxFilter_none(const uint32_t* targets, const uint32_t* weights, uint32_t count,
+    const uint32_t* stamps, uint32_t generation, const uint32_t* costs, uint32_t cost)
+{
+    (void)targets, (void)weights, (void)stamps, (void)generation, (void)costs, (void)cost;
+    return (1u << count) - 1;
+}
+
+/// @brief the filter one connection at a time, for processors without vector gathers
+uint32_t relaxFilter_scalar(const uint32_t* targets, const uint32_t* weights, uint32_t count,
+    const uint32_t* stamps, uint32_t generation, const uint32_t* costs, uint32_t cost)
+{
+    uint32_t mask = 0;
+    for(uint32_t j = 0; j < count; j++)
+    {
+        uint32_t target = targets[j];
+        bool unreached = stamps && stamps[target] != generation;
+        if(weights[j] != CONNECTION_CLOSED && (unreached || costs[target] > cost + weights[j]))
+            mask |= 1u << j;
+    }
+    return mask;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+/// @brief the filter eight connections at a time with AVX2 gathers
+__attribute__((target("avx2")))
+uint32_t relaxFilter_avx2(const uint32_t* targets, const uint32_t* weights, uint32_t count,
+    const uint32_t* stamps, uint32_t generation, const uint32_t* costs, uint32_t cost)
+{
+    // AVX2 only compares signed integers, flipping the sign bit of both sides
+    // turns that into the unsigned comparison
+    const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+    const __m256i ones = _mm256_set1_epi32(-1);
+    const __m256i base = _mm256_set1_epi32((int32_t)cost);
+    const __m256i stamp = _mm256_set1_epi32((int32_t)generation);
+    uint32_t mask = 0, j = 0;
+    for(; j + 8 <= count; j += 8)
+    {
+        __m256i target = _mm256_loadu_si256((const __m256i*)(targets + j));
+        __m256i weight = _mm256_loadu_si256((const __m256i*)(weights + j));
+        __m256i candidate = _mm256_xor_si256(_mm256_add_epi32(base, weight), sign);
+
+        // the costs of cities the search has not reached are never loaded
+        __m256i reached = ones;
+        if(stamps)
+            reached = _mm256_cmpeq_epi32(_mm256_i32gather_epi32((const int*)stamps, target, 4), stamp);
+        __m256i current = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int*)costs, target, reached, 4);
+        __m256i keep = _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_xor_si256(current, sign), candidate), reached);
+        keep = _mm256_or_si256(keep, _mm256_xor_si256(reached, ones));
+        keep = _mm256_andnot_si256(_mm256_cmpeq_epi32(weight, ones), keep);
+        mask |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(keep)) << j;
+    }
+    if(j < count)
+        mask |= relaxFilter_scalar(targets + j, weights + j, count - j, stamps, generation, costs, cost) << j;
+    return mask;
+}
+
+/// @brief the filter for a whole block at once with AVX-512 masked gathers
+__attribute__((target("avx512f")))
+uint32_t relaxFilter_avx512(const uint32_t* targets, const uint32_t* weights, uint32_t count,
+    const uint32_t* stamps, uint32_t generation, const uint32_t* costs, uint32_t cost)
+{
+    // lanes past the end of the block are neither loaded nor gathered
+    __mmask16 lanes = (__mmask16)(count >= 16 ? 0xffff : (1u << count) - 1);
+    __m512i target = _mm512_maskz_loadu_epi32(lanes, targets);
+    __m512i weight = _mm512_maskz_loadu_epi32(lanes, weights);
+    __m512i candidate = _mm512_add_epi32(_mm512_set1_epi32((int32_t)cost), weight);
+
+    // the costs of cities the search has not reached are never loaded
+    __mmask16 reached = lanes;
+    if(stamps)
+    {
+        __m512i stamp = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), lanes, target, stamps, 4);
+        reached = _mm512_mask_cmpeq_epi32_mask(lanes, stamp, _mm512_set1_epi32((int32_t)generation));
+    }
+    __m512i current = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), reached, target, costs, 4);
+    __mmask16 keep = _mm512_mask_cmpgt_epu32_mask(reached, current, candidate) | (lanes & ~reached);
+    return keep & _mm512_mask_cmpneq_epi32_mask(lanes, weight, _mm512_set1_epi32(-1));
+}
+#endif
+
+/// @brief the filter the searches use when none was set, always the scalar
+///        loop, see the top of relax_filter.h
+RelaxFilter* relaxFilter_best()
+{
+    return relaxFilter_scalar;
+}
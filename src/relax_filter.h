@@ -0,0 +1,72 @@
+#ifndef RELAX_FILTER_H
+#define RELAX_FILTER_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// The weighted searches scan the connections of a city in blocks of up to
+// RELAX_BLOCK and first ask a filter which of them are worth relaxing: those
+// whose target is new to the search or would get cheaper through this city.
+// The rest cost a gathered load instead of a heuristic and a heap lookup, which
+// is most of the connections of a hub once its neighbourhood has been reached.
+// Only this test is vectorized. The estimate, the heap update and the write
+// of the new cost stay one connection at a time in the searches: the estimate
+// takes the largest of the straight line, landmark and coordinate bounds,
+// each another gather per connection, and every connection that passes the
+// filter moves an entry of the indexed heap, which has to happen in order, so
+// a masked store of the costs would only save the part that is already cheap.
+// The vector filters are for bench-relax and callers who measured them, the
+// searches use the scalar loop unless relax_filter is set before they run.
+// AVX-512 checks a whole block at once with masked gathers and AVX2 eight
+// connections, but on the graphs of bench-relax neither beat the scalar loop,
+// the gathers miss the cache just as the scalar loads do.
+// Cities with fewer than RELAX_FILTER_MIN connections skip the filter since
+// the call costs more than it saves
+#define RELAX_BLOCK 16
+#define RELAX_FILTER_MIN 8
+
+/// @brief picks out the connections of a block worth relaxing
+/// @param targets the targets of the connections of the block
+/// @param weights the lengths of the connections of the block
+/// @param count the number of connections in the block, at most RELAX_BLOCK
+/// @param stamps marks the cities the search has reached, NULL when costs is
+///        valid for every city and unreached ones cost UINT32_MAX
+/// @param generation the stamp of the current search
+/// @param costs the cost each city has been reached with
+/// @param cost the cost of the city the connections leave
+/// @return bit j is set when connection j is open and its target is unreached
+///         or costs more than cost plus the length of the connection
+typedef uint32_t RelaxFilter(const uint32_t* targets, const uint32_t* weights, uint32_t count,
+    const uint32_t* stamps, uint32_t generation, const uint32_t* costs, uint32_t cost);
+
+// the filter the searches use, relaxFilter_best on first use when NULL
+extern RelaxFilter* _Atomic relax_filter;
+
+uint32_t relaxFilter_none(const uint32_t* targets, const uint32_t* weights, uint32_t count,
+    const uint32_t* stamps, uint32_t generation, const uint32_t* costs, uint32_t cost);
+uint32_t relaxFilter_scalar(const uint32_t* targets, const uint32_t* weights, uint32_t count,
+    const uint32_t* stamps, uint32_t generation, const uint32_t* costs, uint32_t cost);
+RelaxFilter* relaxFilter_best();
+#if defined(__x86_64__) && defined(__GNUC__)
+uint32_t relaxFilter_avx2(const uint32_t* targets, const uint32_t* weights, uint32_t count,
+    const uint32_t* stamps, uint32_t generation, const uint32_t* costs, uint32_t cost);
+uint32_t relaxFilter_avx512(const uint32_t* targets, const uint32_t* weights, uint32_t count,
+    const uint32_t* stamps, uint32_t generation, const uint32_t* costs, uint32_t cost);
+#endif
+
+/// @brief the connections of a block worth relaxing, see RelaxFilter
+static inline uint32_t relaxFilter(const uint32_t* targets, const uint32_t* weights, uint32_t count,
+    const uint32_t* stamps, uint32_t generation, const uint32_t* costs, uint32_t cost)
+{
+    if(count < RELAX_FILTER_MIN)
+        return (1u << count) - 1;
+    RelaxFilter* filter = atomic_load_explicit(&relax_filter, memory_order_relaxed);
+    if(filter == NULL)
+    {
+        filter = relaxFilter_best();
+        atomic_store_explicit(&relax_filter, filter, memory_order_relaxed);
+    }
+    return filter(targets, weights, count, stamps, generation, costs, cost);
+}
+
+#endif
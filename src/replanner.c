@@ -0,0 +1,269 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "replanner.h"
+#include "containers.h"
+#include "graph.h"
+#include "search.h"
+
+/// @brief adds a connection length to a cost without wrapping past unreachable
+static inline uint32_t replanner_add(uint32_t cost, uint32_t weight)
+{
+    if(cost == REPLAN_INFINITY || weight == CONNECTION_CLOSED)return REPLAN_INFINITY;
+    uint64_t sum = (uint64_t)cost + weight;
+    return sum < REPLAN_INFINITY ? (uint32_t)sum : REPLAN_INFINITY;
+}
+
+/// @brief the heap key of a city, ordered by estimate and then by cost
+static inline uint64_t replanner_key(Replanner* rp, uint32_t node)
+{
+    uint32_t cost = rp->g[node] < rp->rhs[node] ? rp->g[node] : rp->rhs[node];
+    if(cost == REPLAN_INFINITY)return UINT64_MAX;
+    // keys are recomputed every time a city reaches the top of the heap, the
+    // landmark bound is worth remembering
+    if(rp->estimates[node] == REPLAN_INFINITY)
+        rp->estimates[node] = heuristic(rp->graph, node, rp->end);
+    uint64_t estimate = (uint64_t)cost + rp->estimates[node];
+    if(estimate > UINT32_MAX)estimate = UINT32_MAX;
+    return estimate << 32 | cost;
+}
+
+/// @brief queues a city whose g and rhs disagree, with its current key
+static void replanner_push(Replanner* rp, uint32_t node)
+{
+    if(rp->g[node] == rp->rhs[node])return;
+    if(rp->heap_len == rp->heap_capacity)
+    {
+        uint32_t new_capacity = rp->heap_capacity ? rp->heap_capacity * 2 : 256;
+        ReplanEntry* heap = (ReplanEntry*)realloc(rp->heap, new_capacity * sizeof(ReplanEntry));
+        if(heap == NULL)
+        {
+            perror("unable to realloc replanner heap");
+            exit(0);
+        }
+        rp->heap = heap;
+        rp->heap_capacity = new_capacity;
+    }
+
+    ReplanEntry entry = {replanner_key(rp, node), node};
+    uint32_t i = rp->heap_len++;
+    while(i > 0 && rp->heap[(i - 1) / 2].key > entry.key)
+    {
+        rp->heap[i] = rp->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    rp->heap[i] = entry;
+}
+
+/// @brief removes the top entry of the heap
+static void replanner_pop(Replanner* rp)
+{
+    ReplanEntry last = rp->heap[--rp->heap_len];
+    uint32_t i = 0;
+    while(true)
+    {
+        uint32_t child = 2 * i + 1;
+        if(child >= rp->heap_len)break;
+        if(child + 1 < rp->heap_len && rp->heap[child + 1].key < rp->heap[child].key)child++;
+        if(rp->heap[child].key >= last.key)break;
+        rp->heap[i] = rp->heap[child];
+        i = child;
+    }
+    if(rp->heap_len > 0)
+        rp->heap[i] = last;
+}
+
+/// @brief drops stale entries from the top of the heap
+/// @return the key of the first city that still has to be expanded, UINT64_MAX if none
+static uint64_t replanner_top(Replanner* rp)
+{
+    while(rp->heap_len > 0)
+    {
+        ReplanEntry top = rp->heap[0];
+        if(rp->g[top.id] != rp->rhs[top.id] && top.key == replanner_key(rp, top.id))
+            return top.key;
+        replanner_pop(rp);
+    }
+    return UINT64_MAX;
+}
+
+/// @brief recomputes what the incoming connections of a city offer and queues
+///        the city if that no longer matches its cost
+static void replanner_update(Replanner* rp, uint32_t node)
+{
+    if(node != rp->start)
+    {
+        uint32_t best = REPLAN_INFINITY;
+        for(uint32_t i = rp->in_offsets[node]; i < rp->in_offsets[node + 1]; i++)
+        {
+            uint32_t cost = replanner_add(rp->g[rp->in_sources[i]], rp->graph->weights[rp->in_edges[i]]);
+            if(cost < best)best = cost;
+        }
+        rp->rhs[node] = best;
+    }
+    replanner_push(rp, node);
+}
+
+/// @brief creates a replanner for routes between two cities, nothing is
+///        searched until the first replanner_plan
+/// @param graph the graph to search, it has to outlive the replanner
+/// @param start the id of the city routes start at
+/// @param end the id of the city routes go to
+/// @return a new replanner, free it with replanner_free
+Replanner* replanner_create(const Graph* graph, uint32_t start, uint32_t end)
+{
+    Replanner* rp = (Replanner*)calloc(1, sizeof(Replanner));
+    if(rp == NULL)
+    {
+        perror("unable to calloc replanner");
+        exit(0);
+    }
+    uint32_t n = graph->num_nodes, m = graph->num_edges;
+    rp->graph = graph;
+    rp->start = start;
+    rp->end = end;
+    rp->g = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    rp->rhs = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    rp->estimates = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    rp->in_offsets = (uint32_t*)calloc(n + 2, sizeof(uint32_t));
+    rp->in_edges = (uint32_t*)malloc((m ? m : 1) * sizeof(uint32_t));
+    rp->in_sources = (uint32_t*)malloc((m ? m : 1) * sizeof(uint32_t));
+    if(!rp->g || !rp->rhs || !rp->estimates || !rp->in_offsets || !rp->in_edges || !rp->in_sources)
+    {
+        perror("unable to allocate replanner arrays");
+        exit(0);
+    }
+
+    // the incoming connections refer back to the weights of the graph so
+    // they follow every later change to them
+    for(uint32_t i = 0; i < m; i++)
+        rp->in_offsets[graph->targets[i] + 2]++;
+    for(uint32_t v = 2; v <= n + 1; v++)
+        rp->in_offsets[v] += rp->in_offsets[v - 1];
+    for(uint32_t v = 0; v < n; v++)
+    {
+        for(uint32_t i = graph->offsets[v]; i < graph->offsets[v + 1]; i++)
+        {
+            uint32_t slot = rp->in_offsets[graph->targets[i] + 1]++;
+            rp->in_edges[slot] = i;
+            rp->in_sources[slot] = v;
+        }
+    }
+
+    for(uint32_t v = 0; v < n; v++)
+        rp->g[v] = rp->rhs[v] = rp->estimates[v] = REPLAN_INFINITY;
+    rp->rhs[start] = 0;
+    replanner_push(rp, start);
+    return rp;
+}
+
+/// @brief tells the replanner a connection changed length, call it after
+///        graph_setWeight and before the next replanner_plan
+/// @param rp the replanner
+/// @param from the id of the city the connection starts at
+/// @param to the id of the city the connection goes to
+void replanner_connectionChanged(Replanner* rp, uint32_t from, uint32_t to)
+{
+    (void)from;
+    replanner_update(rp, to);
+}
+
+/// @brief brings the route up to date with every change reported since the
+///        last plan, the first plan is an ordinary A* search
+/// @param rp the replanner
+/// @return a list of cities in the order of the shortest path, NULL if the
+///         end cannot be reached
+City** replanner_plan(Replanner* rp)
+{
+    const Graph* graph = rp->graph;
+    rp->expanded = 0;
+    while(replanner_top(rp) < replanner_key(rp, rp->end) || rp->g[rp->end] != rp->rhs[rp->end])
+    {
+        if(rp->heap_len == 0)break;
+        uint32_t current = rp->heap[0].id;
+        replanner_pop(rp);
+        rp->expanded++;
+
+        if(rp->g[current] > rp->rhs[current])
+        {
+            // the city got cheaper, which can only lower what it offers onwards
+            rp->g[current] = rp->rhs[current];
+            for(uint32_t i = graph->offsets[current]; i < graph->offsets[current + 1]; i++)
+            {
+                uint32_t connected = graph->targets[i];
+                uint32_t cost = replanner_add(rp->g[current], graph->weights[i]);
+                if(connected == rp->start || cost >= rp->rhs[connected])continue;
+                rp->rhs[connected] = cost;
+                replanner_push(rp, connected);
+            }
+        }
+        else
+        {
+            // the city got dearer, so it and every city whose best offer came
+            // through it have to look at their incoming connections again
+            uint32_t old_cost = rp->g[current];
+            rp->g[current] = REPLAN_INFINITY;
+            replanner_update(rp, current);
+            for(uint32_t i = graph->offsets[current]; i < graph->offsets[current + 1]; i++)
+            {
+                uint32_t connected = graph->targets[i];
+                if(rp->rhs[connected] == replanner_add(old_cost, graph->weights[i]))
+                    replanner_update(rp, connected);
+            }
+        }
+    }
+    if(rp->g[rp->end] == REPLAN_INFINITY)return NULL;
+
+    // walk back from the end along the incoming connections that give each
+    // city its cost, every step lowers the cost so the walk reaches the start
+    // unless zero length connections form a loop, which the step limit catches
+    IdStack stack = {0};
+    uint32_t current = rp->end;
+    idStack_push(&stack, current);
+    while(current != rp->start && stack.len <= graph->num_nodes)
+    {
+        uint32_t best = current, best_cost = REPLAN_INFINITY;
+        for(uint32_t i = rp->in_offsets[current]; i < rp->in_offsets[current + 1]; i++)
+        {
+            uint32_t cost = replanner_add(rp->g[rp->in_sources[i]], graph->weights[rp->in_edges[i]]);
+            if(cost < best_cost || (cost == best_cost && rp->g[rp->in_sources[i]] < rp->g[best]))
+            {
+                best = rp->in_sources[i];
+                best_cost = cost;
+            }
+        }
+        current = best;
+        idStack_push(&stack, current);
+    }
+
+    City** path = NULL;
+    if(current == rp->start)
+    {
+        path = (City**)calloc(stack.len + 1, sizeof(City*));
+        if(!path)
+        {
+            perror("unable to calloc replanned path");
+            exit(0);
+        }
+        uint32_t id = 0;
+        for(int i = 0; idStack_pop(&stack, &id); i++)
+            path[i] = (City*)&graph->cities[id];
+    }
+    idStack_free(&stack);
+    return path;
+}
+
+/// @brief releases a replanner, the graph is not freed
+void replanner_free(Replanner* rp)
+{
+    free(rp->g);
+    free(rp->rhs);
+    free(rp->estimates);
+    free(rp->in_offsets);
+    free(rp->in_edges);
+    free(rp->in_sources);
+    free(rp->heap);
+    free(rp);
+}
@@ -0,0 +1,50 @@
+#ifndef REPLANNER_H
+#define REPLANNER_H
+
+#include <stdint.h>
+#include "graph.h"
+
+// Lifelong Planning A* (LPA*) keeps the search between queries for one pair of
+// cities so the route can be repaired after graph_setWeight instead of being
+// searched for again. Every city has its cost g from the last search and rhs,
+// the cost its incoming connections offer now. The two agree everywhere after
+// a search, a changed connection only touches the rhs of the city it goes to
+// and the search then expands just the cities whose costs actually change, in
+// A* order, until the end city agrees again. Cities are ordered by the pair
+// (min(g, rhs) + heuristic, min(g, rhs)) packed into one 64 bit key, the heap
+// is lazy and skips entries whose key went stale rather than removing them
+#define REPLAN_INFINITY UINT32_MAX
+
+typedef struct replan_entry{
+    uint64_t key;
+    uint32_t id;
+} ReplanEntry;
+
+typedef struct replanner{
+    const Graph* graph; // the graph being searched, its weights may change between plans
+    uint32_t start; // the city routes start at
+    uint32_t end; // the city routes go to
+    uint32_t* g; // the cost of each city when it was last expanded
+    uint32_t* rhs; // the cheapest cost the incoming connections of each city offer
+    uint32_t* estimates; // the heuristic from each city to the end, REPLAN_INFINITY until needed
+    uint32_t* in_offsets; // num_nodes + 1 offsets into in_edges/in_sources
+    uint32_t* in_edges; // the index in graph->weights of each connection coming into a city
+    uint32_t* in_sources; // the city each incoming connection starts at
+    ReplanEntry* heap; // the min heap of cities to expand, may hold stale entries
+    uint32_t heap_len;
+    uint32_t heap_capacity;
+    uint32_t expanded; // the number of cities the last plan expanded
+} Replanner;
+
+Replanner* replanner_create(const Graph* graph, uint32_t start, uint32_t end);
+void replanner_connectionChanged(Replanner* rp, uint32_t from, uint32_t to);
+City** replanner_plan(Replanner* rp);
+void replanner_free(Replanner* rp);
+
+/// @brief the cost of the route found by the last plan, REPLAN_INFINITY if there is none
+static inline uint32_t replanner_cost(const Replanner* rp)
+{
+    return rp->g[rp->end];
+}
+
+#endif
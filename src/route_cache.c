@@ -0,0 +1,267 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "route_cache.h"
+#include "graph.h"
+#include "search_context.h"
+#include "util.h"
+#include "search.h"
+#include "contraction_hierarchy.h"
+
+#define ROUTE_CACHE_NONE UINT32_MAX
+
+/// @brief mixes the bits of a key so nearby keys land in different buckets
+static inline uint32_t routeCache_hash(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return (uint32_t)key;
+}
+
+/// @brief the hash of the cities a route ends at and the search that found it
+static inline uint32_t routeCache_endHash(Algo* algo, uint32_t end)
+{
+    return routeCache_hash((uint64_t)(uintptr_t)algo * 0x9e3779b97f4a7c15ull ^ end);
+}
+
+/// @brief the hash of a whole query
+static inline uint32_t routeCache_routeHash(Algo* algo, uint32_t start, uint32_t end)
+{
+    return routeCache_hash(((uint64_t)start << 32 | end) ^ (uint64_t)(uintptr_t)algo * 0x9e3779b97f4a7c15ull);
+}
+
+/// @brief whether the search always finds a shortest path, only then are the
+///        ends of its routes the answers to other queries
+static inline bool routeCache_findsShortest(Algo* algo)
+{
+    return algo == AStar || algo == bidirectionalAStar || algo == contractionHierarchySearch;
+}
+
+/// @brief creates a cache for the routes on one graph
+/// @param graph the graph the routes are on, changes to its weights invalidate them
+/// @param capacity the number of routes to keep
+/// @return a new cache, free it with routeCache_free
+RouteCache* routeCache_create(const Graph* graph, uint32_t capacity)
+{
+    RouteCache* cache = (RouteCache*)calloc(1, sizeof(RouteCache));
+    if(cache == NULL)
+    {
+        perror("unable to calloc route cache");
+        exit(0);
+    }
+    cache->graph = graph;
+
+    uint32_t per_shard = (capacity + ROUTE_CACHE_SHARDS - 1) / ROUTE_CACHE_SHARDS;
+    if(per_shard == 0)per_shard = 1;
+    uint32_t num_buckets = 1;
+    while(num_buckets < per_shard * 2)num_buckets *= 2;
+    for(uint32_t s = 0; s < ROUTE_CACHE_SHARDS; s++)
+    {
+        RouteCacheShard* shard = &cache->shards[s];
+        pthread_mutex_init(&shard->lock, NULL);
+        shard->entries = (RouteCacheEntry*)calloc(per_shard, sizeof(RouteCacheEntry));
+        shard->routes = (uint32_t*)malloc(num_buckets * sizeof(uint32_t));
+        shard->ends = (uint32_t*)malloc(num_buckets * sizeof(uint32_t));
+        if(!shard->entries || !shard->routes || !shard->ends)
+        {
+            perror("unable to allocate route cache shard");
+            exit(0);
+        }
+        memset(shard->routes, 0xff, num_buckets * sizeof(uint32_t));
+        memset(shard->ends, 0xff, num_buckets * sizeof(uint32_t));
+        shard->num_entries = per_shard;
+        shard->mask = num_buckets - 1;
+    }
+    return cache;
+}
+
+/// @brief takes an entry out of both of its bucket chains and frees its route
+static void routeCache_remove(RouteCacheShard* shard, uint32_t slot)
+{
+    RouteCacheEntry* entry = &shard->entries[slot];
+    uint32_t* link = &shard->routes[routeCache_routeHash(entry->algo, entry->start, entry->end) & shard->mask];
+    while(*link != slot)
+        link = &shard->entries[*link].next;
+    *link = entry->next;
+    link = &shard->ends[routeCache_endHash(entry->algo, entry->end) & shard->mask];
+    while(*link != slot)
+        link = &shard->entries[*link].next_end;
+    *link = entry->next_end;
+
+    free(entry->nodes);
+    *entry = (RouteCacheEntry){0};
+}
+
+/// @brief copies part of a cached route out as a list of cities
+static City** routeCache_path(const Graph* graph, const RouteCacheEntry* entry, uint32_t from)
+{
+    City** path = (City**)calloc(entry->len - from + 1, sizeof(City*));
+    if(!path)
+    {
+        perror("unable to calloc cached path");
+        exit(0);
+    }
+    for(uint32_t i = from; i < entry->len; i++)
+        path[i - from] = (City*)&graph->cities[entry->nodes[i]];
+    return path;
+}
+
+/// @brief looks a query up in its shard, the shard has to be locked
+/// @return true on a hit, with path and cost filled in
+static bool routeCache_find(RouteCache* cache, RouteCacheShard* shard, Algo* algo, uint32_t start, uint32_t end, City*** path, uint32_t* cost)
+{
+    uint64_t version = atomic_load_explicit(&cache->graph->version, memory_order_acquire);
+    uint32_t slot = shard->routes[routeCache_routeHash(algo, start, end) & shard->mask];
+    for(; slot != ROUTE_CACHE_NONE; slot = shard->entries[slot].next)
+    {
+        RouteCacheEntry* entry = &shard->entries[slot];
+        if(entry->algo != algo || entry->start != start || entry->end != end)continue;
+        if(entry->version != version)
+        {
+            routeCache_remove(shard, slot);
+            atomic_fetch_add_explicit(&cache->stale, 1, memory_order_relaxed);
+            break;
+        }
+        entry->referenced = true;
+        *path = entry->len ? routeCache_path(cache->graph, entry, 0) : NULL;
+        *cost = entry->len ? entry->nodes[2 * entry->len - 1] : 0;
+        atomic_fetch_add_explicit(&cache->hits, 1, memory_order_relaxed);
+        return true;
+    }
+    if(!routeCache_findsShortest(algo))return false;
+
+    // a longer route to the same end that passes through the start
+    slot = shard->ends[routeCache_endHash(algo, end) & shard->mask];
+    for(; slot != ROUTE_CACHE_NONE; slot = shard->entries[slot].next_end)
+    {
+        RouteCacheEntry* entry = &shard->entries[slot];
+        if(entry->algo != algo || entry->end != end || entry->version != version)continue;
+        for(uint32_t i = 0; i < entry->len; i++)
+        {
+            if(entry->nodes[i] != start)continue;
+            entry->referenced = true;
+            *path = routeCache_path(cache->graph, entry, i);
+            *cost = entry->nodes[2 * entry->len - 1] - entry->nodes[entry->len + i];
+            atomic_fetch_add_explicit(&cache->suffix_hits, 1, memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief stores the route of a query in its shard, the shard has to be locked
+static void routeCache_insert(RouteCache* cache, RouteCacheShard* shard, Algo* algo, uint32_t start, uint32_t end,
+    uint32_t* nodes, uint32_t len, uint64_t version)
+{
+    // another worker may have stored the same query while this one searched
+    uint32_t route_bucket = routeCache_routeHash(algo, start, end) & shard->mask;
+    for(uint32_t slot = shard->routes[route_bucket]; slot != ROUTE_CACHE_NONE; slot = shard->entries[slot].next)
+    {
+        RouteCacheEntry* entry = &shard->entries[slot];
+        if(entry->algo == algo && entry->start == start && entry->end == end)
+        {
+            routeCache_remove(shard, slot);
+            break;
+        }
+    }
+
+    // the clock hand passes over entries hit since its last visit once
+    uint32_t slot = shard->hand;
+    while(shard->entries[slot].algo && shard->entries[slot].referenced)
+    {
+        shard->entries[slot].referenced = false;
+        slot = (slot + 1) % shard->num_entries;
+    }
+    shard->hand = (slot + 1) % shard->num_entries;
+    if(shard->entries[slot].algo)
+    {
+        routeCache_remove(shard, slot);
+        atomic_fetch_add_explicit(&cache->evictions, 1, memory_order_relaxed);
+    }
+
+    uint32_t end_bucket = routeCache_endHash(algo, end) & shard->mask;
+    shard->entries[slot] = (RouteCacheEntry){algo, start, end, version, nodes, len, shard->routes[route_bucket], shard->ends[end_bucket], false};
+    shard->routes[route_bucket] = slot;
+    shard->ends[end_bucket] = slot;
+}
+
+/// @brief answers a query from the cache or runs the search and caches its
+///        route, safe to call from several threads with their own contexts
+/// @param cache the cache to use
+/// @param ctx the search context to run the search in on a miss
+/// @param algo the search to run
+/// @param start the id of the city to start at
+/// @param end the id of the city to end at
+/// @param cost filled with the total cost of the path, may be NULL
+/// @return a list of cities in the order of the path found, owned by the caller
+City** routeCache_search(RouteCache* cache, SearchContext* ctx, Algo* algo, uint32_t start, uint32_t end, uint32_t* cost)
+{
+    const Graph* graph = cache->graph;
+    // the shard comes from the top bits of the hash and the bucket from the bottom ones
+    RouteCacheShard* shard = &cache->shards[routeCache_endHash(algo, end) >> (32 - ROUTE_CACHE_SHARD_BITS)];
+    City** path = NULL;
+    uint32_t path_cost = 0;
+
+    pthread_mutex_lock(&shard->lock);
+    bool hit = routeCache_find(cache, shard, algo, start, end, &path, &path_cost);
+    pthread_mutex_unlock(&shard->lock);
+    if(hit)
+    {
+        if(cost)*cost = path_cost;
+        return path;
+    }
+    atomic_fetch_add_explicit(&cache->misses, 1, memory_order_relaxed);
+
+    // the search runs outside the lock, the version is read first so a
+    // change to the weights during the search leaves the entry stale
+    uint64_t version = atomic_load_explicit(&graph->version, memory_order_acquire);
+    path = algo(graph, ctx, start, end);
+    uint32_t len = path ? nullTermArrLen((void**)path) : 0;
+    uint32_t* nodes = (uint32_t*)malloc((2 * len + 1) * sizeof(uint32_t));
+    if(nodes == NULL)
+    {
+        perror("unable to malloc cached route");
+        exit(0);
+    }
+    // the costs the search reached each city with, rather than adding up
+    // connections that may have a cheaper twin running alongside them
+    if(len)
+    {
+        Path route = path_init(nodes, nodes + len, len);
+        path_read(ctx, start, end, &route);
+    }
+    if(cost)*cost = len ? nodes[2 * len - 1] : 0;
+
+    pthread_mutex_lock(&shard->lock);
+    routeCache_insert(cache, shard, algo, start, end, nodes, len, version);
+    pthread_mutex_unlock(&shard->lock);
+    return path;
+}
+
+/// @brief reads the counters of the cache
+RouteCacheStats routeCache_stats(RouteCache* cache)
+{
+    return (RouteCacheStats){atomic_load(&cache->hits), atomic_load(&cache->suffix_hits), atomic_load(&cache->misses),
+        atomic_load(&cache->stale), atomic_load(&cache->evictions)};
+}
+
+/// @brief releases the cache, the graph is not freed
+void routeCache_free(RouteCache* cache)
+{
+    for(uint32_t s = 0; s < ROUTE_CACHE_SHARDS; s++)
+    {
+        RouteCacheShard* shard = &cache->shards[s];
+        for(uint32_t i = 0; i < shard->num_entries; i++)
+            free(shard->entries[i].nodes);
+        free(shard->entries);
+        free(shard->routes);
+        free(shard->ends);
+        pthread_mutex_destroy(&shard->lock);
+    }
+    free(cache);
+}
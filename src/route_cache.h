@@ -0,0 +1,73 @@
+#ifndef ROUTE_CACHE_H
+#define ROUTE_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "graph.h"
+#include "search_context.h"
+#include "search.h"
+
+// Remembers the routes of recent queries so a repeated (start, end, search)
+// query is answered without searching. Entries are spread over shards by their
+// end city, each with its own lock, and a shard evicts with the CLOCK policy:
+// a hit marks the entry and the hand looking for a slot to reuse passes over
+// marked entries once, clearing the mark. Every part of a shortest path is a
+// shortest path, so for searches that find shortest paths a query that misses
+// can still be answered by a cached route to the same end that passes through
+// its start, which is why a shard also chains its entries by end city. Each
+// entry records the graph version it was found on and is dropped when it is
+// looked up after the weights have changed
+#define ROUTE_CACHE_SHARD_BITS 4
+#define ROUTE_CACHE_SHARDS (1u << ROUTE_CACHE_SHARD_BITS)
+
+typedef struct route_cache_entry{
+    Algo* algo; // the search that found the route, NULL for a free slot
+    uint32_t start;
+    uint32_t end;
+    uint64_t version; // the graph version the route was found on
+    uint32_t* nodes; // the cities of the route followed by the cost of reaching each one
+    uint32_t len; // the number of cities in the route, 0 when there is no route
+    uint32_t next; // the next entry in the same route bucket
+    uint32_t next_end; // the next entry in the same end bucket
+    bool referenced; // hit since the clock hand last passed
+} RouteCacheEntry;
+
+// one shard of the cache, padded so the locks of shards do not share a cache line
+typedef struct route_cache_shard{
+    pthread_mutex_t lock;
+    RouteCacheEntry* entries;
+    uint32_t* routes; // bucket heads by (start, end, search)
+    uint32_t* ends; // bucket heads by (end, search)
+    uint32_t num_entries;
+    uint32_t mask; // the number of buckets minus one
+    uint32_t hand; // the clock hand
+    char padding[64];
+} RouteCacheShard;
+
+// how the cache has been doing since it was created
+typedef struct route_cache_stats{
+    uint64_t hits; // queries answered by a cached route between the same cities
+    uint64_t suffix_hits; // queries answered by the end of a longer cached route
+    uint64_t misses; // queries that had to search
+    uint64_t stale; // entries dropped because the weights changed after they were found
+    uint64_t evictions; // entries pushed out to make room
+} RouteCacheStats;
+
+typedef struct route_cache{
+    const Graph* graph; // the graph the routes are on
+    RouteCacheShard shards[ROUTE_CACHE_SHARDS];
+    _Atomic uint64_t hits;
+    _Atomic uint64_t suffix_hits;
+    _Atomic uint64_t misses;
+    _Atomic uint64_t stale;
+    _Atomic uint64_t evictions;
+} RouteCache;
+
+RouteCache* routeCache_create(const Graph* graph, uint32_t capacity);
+City** routeCache_search(RouteCache* cache, SearchContext* ctx, Algo* algo, uint32_t start, uint32_t end, uint32_t* cost);
+RouteCacheStats routeCache_stats(RouteCache* cache);
+void routeCache_free(RouteCache* cache);
+
+#endif
@@ -0,0 +1,579 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "search.h"
+#include "containers.h"
+#include "graph.h"
+#include "search_context.h"
+#include "relax_filter.h"
+
+/// @brief walks nodes by their parent in the search context to create
+///        a list of cities representing a path from start to finish
+/// @param graph the graph that was searched
+/// @param ctx the search context the path was found in
+/// @param start the id of the first city in the path
+/// @param end the id of the last city in the path
+/// @return an array of City* in order of pathing from start to finish
+City** walkBack(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    // the search is over so its stack can be reused for the path
+    IdStack* stack = &ctx->stack;
+    idStack_clear(stack);
+    idStack_push(stack, end);
+
+    // loop until you traced your steps back to the start of the path
+    while(end != start)
+    {
+        // walk backwards along the path to trace it
+        end = ctx->parents[end];
+
+        // push each visited city onto a stack in reverse order they were visited
+        idStack_push(stack, end);
+    }
+    
+    // allocate memory for a list of cities
+    City** path = (City**)calloc(stack->len + 1, sizeof(City*));
+    if(!path)
+    {
+        perror("unable to calloc in walkback");
+        exit(0);
+    }
+
+    // pop cities off the stack to get them in the correct order
+    // and add them to the list as they get popped
+    uint32_t id = 0;
+    for(int i = 0; idStack_pop(stack, &id); i++)
+    {
+        path[i] = (City*)&graph->cities[id];
+    }
+    
+    return path;
+}
+
+/// @brief makes room for at least capacity cities, the cities already in the
+///        path are kept and the buffers of the caller are never freed
+static void path_reserve(Path* path, uint32_t capacity)
+{
+    if(capacity <= path->capacity)return;
+    uint32_t new_capacity = path->capacity > 8 ? path->capacity * 2 : 16;
+    if(new_capacity < capacity)new_capacity = capacity;
+
+    uint32_t* block = (uint32_t*)malloc(2 * (size_t)new_capacity * sizeof(uint32_t));
+    if(block == NULL)
+    {
+        perror("unable to malloc path");
+        exit(0);
+    }
+    memcpy(block, path->nodes, path->len * sizeof(uint32_t));
+    memcpy(block + new_capacity, path->costs, path->len * sizeof(uint32_t));
+    if(path->owned)
+        free(path->nodes);
+    path->nodes = block;
+    path->costs = block + new_capacity;
+    path->capacity = new_capacity;
+    path->owned = true;
+}
+
+/// @brief reads the path the last search found out of its context, in a single
+///        walk over the parents from the end that writes the path reversed and
+///        then turns it around in place, every search records the cost it
+///        reached each city with so the costs are not looked up again
+/// @param ctx the context the search ran in
+/// @param start the id of the city the search started at
+/// @param end the id of the city the search ended at
+/// @param path filled with the path, its buffers are reused
+/// @return the number of cities in the path
+uint32_t path_read(const SearchContext* ctx, uint32_t start, uint32_t end, Path* path)
+{
+    path->len = 0;
+    for(uint32_t current = end; true; current = ctx->parents[current])
+    {
+        if(path->len == path->capacity)
+            path_reserve(path, path->len + 1);
+        path->nodes[path->len] = current;
+        path->costs[path->len] = ctx->g_scores[current];
+        path->len++;
+        if(current == start)break;
+    }
+    for(uint32_t i = 0, j = path->len - 1; i < j; i++, j--)
+    {
+        uint32_t node = path->nodes[i], cost = path->costs[i];
+        path->nodes[i] = path->nodes[j];
+        path->costs[i] = path->costs[j];
+        path->nodes[j] = node;
+        path->costs[j] = cost;
+    }
+    path->cost = path->costs[path->len - 1];
+    return path->len;
+}
+
+/// @brief runs a search and reads its path
+/// @param path filled with the path, len is 0 when there is none
+/// @return false if there is no path
+bool path_find(Path* path, const Graph* graph, SearchContext* ctx, Search* search, uint32_t start, uint32_t end)
+{
+    if(!search(graph, ctx, start, end))
+    {
+        path->len = 0;
+        path->cost = 0;
+        return false;
+    }
+    path_read(ctx, start, end, path);
+    return true;
+}
+
+/// @brief frees the allocation a path made, the buffers of the caller are left alone
+void path_free(Path* path)
+{
+    if(path->owned)
+        free(path->nodes);
+    *path = (Path){0};
+}
+
+/// @brief Breadth first search of a graph
+/// @param graph the graph to search
+/// @param ctx the search context to keep the query state in
+/// @param start the id of the city you wish to start at
+/// @param end the id of the city you wish to end at
+/// @return true if a path was found, it is left in the context for path_read
+bool breadthFirst_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    // the ring buffer queue lives in the search context so it is reused between queries
+    IdQueue* queue = &ctx->queue;
+    uint32_t current = 0;
+
+    // enque the start city
+    searchContext_begin(ctx);
+    searchContext_visit(ctx, start, NO_PARENT, 0);
+    idQueue_push(queue, start);
+
+    // loop until there are no more cities in the queue
+    // (which will only happen if the target cant be found)
+    while(idQueue_pop(queue, &current))
+    {
+        SEARCH_STAT(ctx, popped, 1);
+
+        // if we have dequeued the target city from the queue
+        // we have reached our destination and should walk back
+        // through the queueing process to trace our path to the
+        // destination
+        if(current == end) 
+            return true;
+        SEARCH_TRACE(ctx, SEARCH_TRACE_EXPAND, current, ctx->g_scores[current]);
+
+        // loop over the current cities range of the connection
+        // arrays and queue each connected city
+        for(uint32_t i = graph->offsets[current]; i < graph->offsets[current + 1]; i++)
+        {
+            uint32_t connected = graph->targets[i];
+            SEARCH_STAT(ctx, relaxed, 1);
+            
+            // if the city to be added is the starting city, has already
+            // been visited or the road to it is closed skip it
+            if(searchContext_visited(ctx, connected) || graph->weights[i] == CONNECTION_CLOSED)continue;
+
+            // set the city as "visited" by storing the city that added it
+            searchContext_visit(ctx, connected, current, ctx->g_scores[current] + graph->weights[i]);
+
+            // queue the connected city
+            idQueue_push(queue, connected);
+            SEARCH_STAT(ctx, pushed, 1);
+            SEARCH_STAT_FRONTIER(ctx, queue->len);
+        }
+    }
+
+    return false;
+}
+
+/// @brief breadthFirst_run followed by walkBack, for callers that want a list of cities
+/// @return a list of cities in the order of the path found, NULL if there is none
+City** breadthFirst(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    return breadthFirst_run(graph, ctx, start, end) ? walkBack(graph, ctx, start, end) : NULL;
+}
+
+/// @brief Depth first search of a graph
+/// @param graph the graph to search
+/// @param ctx the search context to keep the query state in
+/// @param start the id of the city you wish to start at
+/// @param end the id of the city you wish to end at
+/// @return true if a path was found, it is left in the context for path_read
+bool depthFirst_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    // the array stack lives in the search context so it is reused between queries
+    IdStack* stack = &ctx->stack;
+    uint32_t current = 0;
+
+    searchContext_begin(ctx);
+    searchContext_visit(ctx, start, NO_PARENT, 0);
+    idStack_push(stack, start);
+
+    // loop until there are no more cities in the stack
+    // (which will only happen if the target cant be found)
+    while(idStack_pop(stack, &current))
+    {
+        SEARCH_STAT(ctx, popped, 1);
+
+        // if we have dequeued the target city from the queue
+        // we have reached our destination and should walk back
+        // through the queueing process to trace our path to the
+        // destination
+        if(current == end) 
+            return true;
+        SEARCH_TRACE(ctx, SEARCH_TRACE_EXPAND, current, ctx->g_scores[current]);
+
+        // loop over the current cities range of the connection
+        // arrays and push each connected city
+        for(uint32_t i = graph->offsets[current]; i < graph->offsets[current + 1]; i++)
+        {
+            uint32_t connected = graph->targets[i];
+            SEARCH_STAT(ctx, relaxed, 1);
+            
+            // if the city to be added is the starting city, has already
+            // been visited or the road to it is closed skip it
+            if(searchContext_visited(ctx, connected) || graph->weights[i] == CONNECTION_CLOSED)continue;
+
+            // set the city as "visited" by storing the city that added it
+            searchContext_visit(ctx, connected, current, ctx->g_scores[current] + graph->weights[i]);
+
+            // queue the connected city
+            idStack_push(stack, connected);
+            SEARCH_STAT(ctx, pushed, 1);
+            SEARCH_STAT_FRONTIER(ctx, stack->len);
+        }
+    }
+
+    return false;
+}
+
+/// @brief depthFirst_run followed by walkBack, for callers that want a list of cities
+/// @return a list of cities in the order of the path found, NULL if there is none
+City** depthFirst(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    return depthFirst_run(graph, ctx, start, end) ? walkBack(graph, ctx, start, end) : NULL;
+}
+
+/// @brief A* search of a graph
+/// @param graph the graph to search
+/// @param ctx the search context to keep the query state in
+/// @param start the id of the city you wish to start at
+/// @param end the id of the city you wish to end at
+/// @return true if a path was found, it is left in the context for path_read
+bool AStar_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    // the indexed heap lives in the search context so it is reused between queries
+    IHeap* heap = &ctx->heap;
+    uint32_t current = 0;
+
+    // enque the start city
+    searchContext_begin(ctx);
+    searchContext_visit(ctx, start, NO_PARENT, 0);
+    iheap_push(heap, start, heuristic(graph, start, end));
+
+    // loop until there are no more cities in the heap
+    // (which will only happen if the target cant be found)
+    while(iheap_pop(heap, &current, NULL))
+    {
+        SEARCH_STAT(ctx, popped, 1);
+
+        // if we have popped the target city from the heap
+        // we have reached our destination and should walk back
+        // through the queueing process to trace our path to the
+        // destination
+        if(current == end)
+            return true;
+
+        // the actual cost of the path to the current city
+        uint32_t currentCost = ctx->g_scores[current];
+        SEARCH_TRACE(ctx, SEARCH_TRACE_EXPAND, current, currentCost);
+
+        // loop over the current cities range of the connection arrays a
+        // block at a time and queue the connected cities the filter lets
+        // through, the others cannot get cheaper through the current city
+        uint32_t last = graph->offsets[current + 1];
+        for(uint32_t block = graph->offsets[current]; block < last; block += RELAX_BLOCK)
+        {
+            uint32_t count = last - block < RELAX_BLOCK ? last - block : RELAX_BLOCK;
+            uint32_t mask = relaxFilter(graph->targets + block, graph->weights + block, count,
+                ctx->stamps, ctx->generation, ctx->g_scores, currentCost);
+            SEARCH_STAT(ctx, relaxed, count);
+            for(; mask; mask &= mask - 1)
+            {
+                uint32_t i = block + __builtin_ctz(mask);
+                // alias to access the connected city easier
+                uint32_t connected = graph->targets[i];
+                uint32_t new_cost = currentCost + graph->weights[i];
+                // a cost past UINT32_MAX does not fit in g_scores, and no
+                // path through it can be cheaper than one that does fit
+                if(graph->weights[i] == CONNECTION_CLOSED || new_cost < currentCost)continue;
+            
+                // calcuate (possibly new) score for the connected city, the
+                // heap keys are 64 bit so a long road plus its estimate never wraps
+                uint64_t new_score = (uint64_t)new_cost + heuristic(graph, connected, end);
+
+                // Check if the target city is already in the heap, this is
+                // a slot table lookup rather than a walk over the queue
+                if(iheap_contains(heap, connected))
+                {
+                    // if the target city is in the heap already we should lower
+                    // its score rather than add a new entry to the heap
+                    if(iheap_score(heap, connected) > new_score)
+                    {
+                        iheap_decreaseKey(heap, connected, new_score);
+                        searchContext_visit(ctx, connected, current, new_cost);
+                        SEARCH_STAT(ctx, decrease_keys, 1);
+                    }
+                }
+                // if the target city isnt in the heap already we should add it
+                else
+                {
+                    if(searchContext_visited(ctx, connected))continue;
+                    searchContext_visit(ctx, connected, current, new_cost);
+                    // queue the connected city
+                    iheap_push(heap, connected, new_score);
+                    SEARCH_STAT(ctx, pushed, 1);
+                    SEARCH_STAT_FRONTIER(ctx, heap->size);
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+/// @brief AStar_run followed by walkBack, for callers that want a list of cities
+/// @return a list of cities in the order of the path found, NULL if there is none
+City** AStar(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    return AStar_run(graph, ctx, start, end) ? walkBack(graph, ctx, start, end) : NULL;
+}
+
+/// @brief the forward or backward half of the bidirectional state in a context
+SearchSide searchSide_get(SearchContext* ctx, bool backward, uint32_t start, uint32_t end)
+{
+    if(backward)
+        return (SearchSide){ctx->back_stamps, ctx->back_parents, ctx->back_g_scores, &ctx->back_heap, &ctx->back_queue, end, start};
+    return (SearchSide){ctx->stamps, ctx->parents, ctx->g_scores, &ctx->heap, &ctx->queue, start, end};
+}
+
+/// @brief Bidirectional breadth first search of a graph, grows one frontier
+///        from each end a whole level at a time (always the smaller one) and
+///        stops as soon as they touch. The backward half follows connections
+///        as they are stored, which only walks them backwards when every
+///        connection has a twin as long going the other way, on any other
+///        graph (graph->asymmetric is not 0) this runs breadthFirst_run instead
+/// @param graph the graph to search
+/// @param ctx the search context to keep the query state in
+/// @param start the id of the city you wish to start at
+/// @param end the id of the city you wish to end at
+/// @return true if a path was found, it is left in the context for path_read
+bool bidirectionalBreadthFirst_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    if(graph->asymmetric)
+        return breadthFirst_run(graph, ctx, start, end);
+
+    searchContext_enableBackward(ctx);
+    searchContext_begin(ctx);
+    searchContext_visit(ctx, start, NO_PARENT, 0);
+    if(start == end)
+        return true;
+    searchContext_visitBack(ctx, end, NO_PARENT, 0);
+
+    SearchSide forward = searchSide_get(ctx, false, start, end);
+    SearchSide backward = searchSide_get(ctx, true, start, end);
+    idQueue_push(forward.queue, start);
+    idQueue_push(backward.queue, end);
+
+    // loop until one side runs out of cities
+    // (which will only happen if the target cant be found)
+    while(forward.queue->len > 0 && backward.queue->len > 0)
+    {
+        bool expand_backward = backward.queue->len < forward.queue->len;
+        SearchSide* side = expand_backward ? &backward : &forward;
+        SearchSide* other = expand_backward ? &forward : &backward;
+
+        // expand exactly one level, the first city both halves have reached is
+        // on a shortest path in hops because everything the other half reached
+        // before its current level has already been expanded
+        uint32_t level_len = side->queue->len, current = 0;
+        for(uint32_t n = 0; n < level_len; n++)
+        {
+            idQueue_pop(side->queue, &current);
+            SEARCH_STAT(ctx, popped, 1);
+            SEARCH_TRACE(ctx, expand_backward ? SEARCH_TRACE_EXPAND_BACKWARD : SEARCH_TRACE_EXPAND, current, side->g_scores[current]);
+            for(uint32_t i = graph->offsets[current]; i < graph->offsets[current + 1]; i++)
+            {
+                uint32_t connected = graph->targets[i];
+                SEARCH_STAT(ctx, relaxed, 1);
+                if(side->stamps[connected] == ctx->generation || graph->weights[i] == CONNECTION_CLOSED)continue;
+
+                side->stamps[connected] = ctx->generation;
+                side->parents[connected] = current;
+                side->g_scores[connected] = side->g_scores[current] + graph->weights[i];
+
+                if(other->stamps[connected] == ctx->generation)
+                {
+                    searchContext_joinBackward(ctx, connected, end);
+                    return true;
+                }
+                idQueue_push(side->queue, connected);
+                SEARCH_STAT(ctx, pushed, 1);
+                SEARCH_STAT_FRONTIER(ctx, forward.queue->len + backward.queue->len);
+            }
+        }
+    }
+
+    return false;
+}
+
+/// @brief bidirectionalBreadthFirst_run followed by walkBack, for callers that want a list of cities
+/// @return a list of cities in the order of the path found, NULL if there is none
+City** bidirectionalBreadthFirst(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    return bidirectionalBreadthFirst_run(graph, ctx, start, end) ? walkBack(graph, ctx, start, end) : NULL;
+}
+
+// the bidirectional A* keys can be negative, this keeps them in range of the heap
+#define BIDIRECTIONAL_KEY_BIAS (1ull << 32)
+
+/// @brief the heap key of a city in bidirectional A*, twice the cost so far
+///        plus the average potential (estimate to the target minus estimate
+///        back to the origin), which is the same potential for both halves with
+///        opposite sign so the two searches agree on every reduced cost
+static inline uint64_t bidirectionalAStar_key(const Graph* graph, const SearchSide* side, uint32_t node, uint32_t g_score)
+{
+    // twice a 32 bit cost plus an estimate needs 34 bits, and the bias keeps
+    // the smallest difference of estimates above 0
+    int64_t key = 2 * (int64_t)g_score + heuristic(graph, node, side->target) - (int64_t)heuristic(graph, node, side->origin);
+    return (uint64_t)(key + (int64_t)BIDIRECTIONAL_KEY_BIAS);
+}
+
+/// @brief Bidirectional A* search of a graph, runs an A* from each end with
+///        average potentials and always expands the half with the lower key.
+///        The backward half follows connections as they are stored, on a graph
+///        where that is not the same as following them backwards
+///        (graph->asymmetric is not 0) this runs AStar_run instead
+/// @param graph the graph to search
+/// @param ctx the search context to keep the query state in
+/// @param start the id of the city you wish to start at
+/// @param end the id of the city you wish to end at
+/// @return true if a path was found, it is left in the context for path_read
+bool bidirectionalAStar_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    if(graph->asymmetric)
+        return AStar_run(graph, ctx, start, end);
+
+    searchContext_enableBackward(ctx);
+    searchContext_begin(ctx);
+    searchContext_visit(ctx, start, NO_PARENT, 0);
+    if(start == end)
+        return true;
+    searchContext_visitBack(ctx, end, NO_PARENT, 0);
+
+    SearchSide forward = searchSide_get(ctx, false, start, end);
+    SearchSide backward = searchSide_get(ctx, true, start, end);
+    iheap_push(forward.heap, start, bidirectionalAStar_key(graph, &forward, start, 0));
+    iheap_push(backward.heap, end, bidirectionalAStar_key(graph, &backward, end, 0));
+
+    // the cheapest complete path seen so far and where its halves meet
+    uint64_t best_cost = UINT64_MAX;
+    uint32_t meet = NO_PARENT;
+
+    while(forward.heap->size > 0 && backward.heap->size > 0)
+    {
+        uint64_t top_forward = forward.heap->entries[0].score;
+        uint64_t top_backward = backward.heap->entries[0].score;
+
+        // the two keys add up to twice the cost of the best path that could
+        // still be found through the frontiers, once that is no better than
+        // the best path already found neither half can improve on it
+        if(best_cost != UINT64_MAX && top_forward + top_backward >= 2 * (best_cost + BIDIRECTIONAL_KEY_BIAS))
+            break;
+
+        bool expand_backward = top_backward < top_forward;
+        SearchSide* side = expand_backward ? &backward : &forward;
+        SearchSide* other = expand_backward ? &forward : &backward;
+
+        uint32_t current = 0;
+        iheap_pop(side->heap, &current, NULL);
+        uint32_t currentCost = side->g_scores[current];
+        SEARCH_STAT(ctx, popped, 1);
+        SEARCH_TRACE(ctx, expand_backward ? SEARCH_TRACE_EXPAND_BACKWARD : SEARCH_TRACE_EXPAND, current, currentCost);
+
+        uint32_t last = graph->offsets[current + 1];
+        for(uint32_t block = graph->offsets[current]; block < last; block += RELAX_BLOCK)
+        {
+            uint32_t count = last - block < RELAX_BLOCK ? last - block : RELAX_BLOCK;
+            uint32_t mask = relaxFilter(graph->targets + block, graph->weights + block, count,
+                side->stamps, ctx->generation, side->g_scores, currentCost);
+            SEARCH_STAT(ctx, relaxed, count);
+            for(; mask; mask &= mask - 1)
+            {
+                uint32_t i = block + __builtin_ctz(mask);
+                uint32_t connected = graph->targets[i];
+                uint32_t new_cost = currentCost + graph->weights[i];
+                // a cost past UINT32_MAX does not fit in g_scores and is never the cheapest
+                if(graph->weights[i] == CONNECTION_CLOSED || new_cost < currentCost)continue;
+
+                if(side->stamps[connected] == ctx->generation)
+                {
+                    // cities that already left the heap are settled, the potentials
+                    // are consistent so a later path to them is never cheaper
+                    if(!iheap_contains(side->heap, connected) || side->g_scores[connected] <= new_cost)continue;
+                    side->parents[connected] = current;
+                    side->g_scores[connected] = new_cost;
+                    iheap_decreaseKey(side->heap, connected, bidirectionalAStar_key(graph, side, connected, new_cost));
+                    SEARCH_STAT(ctx, decrease_keys, 1);
+                }
+                else
+                {
+                    side->stamps[connected] = ctx->generation;
+                    side->parents[connected] = current;
+                    side->g_scores[connected] = new_cost;
+                    iheap_push(side->heap, connected, bidirectionalAStar_key(graph, side, connected, new_cost));
+                    SEARCH_STAT(ctx, pushed, 1);
+                    SEARCH_STAT_FRONTIER(ctx, forward.heap->size + backward.heap->size);
+                }
+
+                // a city both halves have reached completes a path
+                if(other->stamps[connected] == ctx->generation)
+                {
+                    uint64_t cost = (uint64_t)new_cost + other->g_scores[connected];
+                    if(cost < best_cost)
+                    {
+                        best_cost = cost;
+                        meet = connected;
+                    }
+                }
+            }
+        }
+    }
+
+    if(meet == NO_PARENT)
+        return false;
+    searchContext_joinBackward(ctx, meet, end);
+    return true;
+}
+
+/// @brief bidirectionalAStar_run followed by walkBack, for callers that want a list of cities
+/// @return a list of cities in the order of the path found, NULL if there is none
+City** bidirectionalAStar(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end)
+{
+    return bidirectionalAStar_run(graph, ctx, start, end) ? walkBack(graph, ctx, start, end) : NULL;
+}
+
+/// @brief finds the length of the connection between two cities
+/// @param graph the graph the cities belong to
+/// @param a the id of the city the connection starts at
+/// @param b the id of the city the connection goes to
+/// @return the distance of the connection
+int costCalc(const Graph* graph, uint32_t a, uint32_t b)
+{
+    for(uint32_t i = graph->offsets[a]; i < graph->offsets[a + 1]; i++)
+    {
+        if(graph->targets[i] == b)return graph->weights[i];
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "containers.h"
+#include "graph.h"
+#include "search_context.h"
+#include "landmarks.h"
+#include "spatial_index.h"
+
+// a path read out of a search context without a City* per city, the ids and
+// costs go into buffers the caller passes in or into one allocation when those
+// are missing or too small
+typedef struct path{
+    uint32_t* nodes; // the ids of the cities from start to end
+    uint32_t* costs; // costs[i] is the cost of the path up to nodes[i]
+    uint32_t len; // the number of cities in the path, 0 when no path was found
+    uint32_t capacity; // the number of cities nodes and costs have room for
+    uint32_t cost; // the total cost of the path
+    bool owned; // nodes and costs are one allocation to free with path_free
+} Path;
+
+/// @brief a search that leaves the path it found in the context, see path_read
+typedef bool Search(const Graph*, SearchContext*, uint32_t, uint32_t);
+
+/// @brief one half of a bidirectional search, lets the forward and the
+///        backward half share the same expansion code
+typedef struct search_side{
+    uint32_t* stamps;
+    uint32_t* parents;
+    uint32_t* g_scores;
+    IHeap* heap;
+    IdQueue* queue;
+    uint32_t origin; // the city this half started from
+    uint32_t target; // the city this half is heading towards
+} SearchSide;
+
+/// @brief a search that returns the list of cities of the path it found, NULL when there is none
+typedef City** Algo(const Graph*, SearchContext*, uint32_t, uint32_t);
+
+City** walkBack(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+uint32_t path_read(const SearchContext* ctx, uint32_t start, uint32_t end, Path* path);
+bool path_find(Path* path, const Graph* graph, SearchContext* ctx, Search* search, uint32_t start, uint32_t end);
+void path_free(Path* path);
+bool breadthFirst_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+City** breadthFirst(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+bool depthFirst_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+City** depthFirst(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+bool AStar_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+City** AStar(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+SearchSide searchSide_get(SearchContext* ctx, bool backward, uint32_t start, uint32_t end);
+bool bidirectionalBreadthFirst_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+City** bidirectionalBreadthFirst(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+bool bidirectionalAStar_run(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+City** bidirectionalAStar(const Graph* graph, SearchContext* ctx, uint32_t start, uint32_t end);
+int costCalc(const Graph* graph, uint32_t a, uint32_t b);
+
+/// @brief a lower bound on the cost of travelling between two cities
+/// @param graph the graph the cities belong to
+/// @param node the id of the city the estimate is from
+/// @param target the id of the city the estimate is to
+/// @return the estimated cost, never more than the real cost
+static inline uint32_t heuristic(const Graph* graph, uint32_t node, uint32_t target)
+{
+    // straight_distance is the straight line distance to Bucharest, by the
+    // triangle inequality the straight line between any two cities is at
+    // least the difference of their distances to Bucharest, which makes this
+    // a consistent estimate for any target and the exact value for Bucharest
+    int32_t diff = (int32_t)graph->cities[node].straight_distance - (int32_t)graph->cities[target].straight_distance;
+    uint32_t estimate = (uint32_t)(diff < 0 ? -diff : diff);
+
+    // the larger of two consistent lower bounds is still a consistent lower bound
+    if(graph->landmarks)
+    {
+        uint32_t bound = landmarks_bound(graph->landmarks, node, target);
+        if(bound > estimate)estimate = bound;
+    }
+    if(graph->spatial && graph->spatial->scale > 0)
+    {
+        uint32_t bound = spatialIndex_bound(graph->spatial, graph, node, target);
+        if(bound > estimate)estimate = bound;
+    }
+    return estimate;
+}
+
+/// @brief a path that fills the given buffers while the path fits in them
+/// @param nodes room for capacity city ids, may be NULL
+/// @param costs room for capacity costs, may be NULL
+/// @param capacity the number of cities the buffers have room for
+static inline Path path_init(uint32_t* nodes, uint32_t* costs, uint32_t capacity)
+{
+    return (Path){nodes, costs, 0, nodes && costs ? capacity : 0, 0, false};
+}
+
+#endif
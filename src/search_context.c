@@ -0,0 +1,111 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "search_context.h"
+#include "containers.h"
+#include "graph.h"
+
+/// @brief allocates the scratch space needed to search a graph
+/// @param graph the graph the context will be used with
+/// @return a new search context, free it with searchContext_free
+SearchContext* searchContext_create(const Graph* graph)
+{
+    SearchContext* ctx = (SearchContext*)calloc(1, sizeof(SearchContext));
+    if(ctx == NULL)
+    {
+        perror("unable to calloc search context");
+        exit(0);
+    }
+    uint32_t len = graph->num_nodes ? graph->num_nodes : 1;
+    ctx->num_nodes = graph->num_nodes;
+    ctx->stamps = (uint32_t*)calloc(len, sizeof(uint32_t));
+    ctx->parents = (uint32_t*)malloc(len * sizeof(uint32_t));
+    ctx->g_scores = (uint32_t*)malloc(len * sizeof(uint32_t));
+    if(!ctx->stamps || !ctx->parents || !ctx->g_scores)
+    {
+        perror("unable to allocate search context arrays");
+        exit(0);
+    }
+    iheap_reserveId(&ctx->heap, len - 1);
+    return ctx;
+}
+
+/// @brief releases the memory held by a search context
+void searchContext_free(SearchContext* ctx)
+{
+    free(ctx->stamps);
+    free(ctx->parents);
+    free(ctx->g_scores);
+    free(ctx->back_stamps);
+    free(ctx->back_parents);
+    free(ctx->back_g_scores);
+    iheap_free(&ctx->heap);
+    iheap_free(&ctx->back_heap);
+    idQueue_free(&ctx->back_queue);
+    idQueue_free(&ctx->queue);
+    idStack_free(&ctx->stack);
+    free(ctx);
+}
+
+/// @brief starts a new query, forgetting everything from the previous one
+/// @param ctx the context to reuse
+void searchContext_begin(SearchContext* ctx)
+{
+    // when the generation wraps around old stamps could match again
+    // so this is the one time the stamps actually have to be cleared
+    if(++ctx->generation == 0)
+    {
+        memset(ctx->stamps, 0, ctx->num_nodes * sizeof(uint32_t));
+        if(ctx->back_stamps)
+            memset(ctx->back_stamps, 0, ctx->num_nodes * sizeof(uint32_t));
+        ctx->generation = 1;
+    }
+    iheap_clear(&ctx->heap);
+    idQueue_clear(&ctx->queue);
+    idStack_clear(&ctx->stack);
+    iheap_clear(&ctx->back_heap);
+    idQueue_clear(&ctx->back_queue);
+#ifdef SEARCH_STATS
+    ctx->stats = (SearchStats){0};
+#endif
+    SEARCH_TRACE(ctx, SEARCH_TRACE_BEGIN, NO_PARENT, 0);
+}
+
+/// @brief allocates the backward state used by bidirectional searches,
+///        does nothing if it already exists
+/// @param ctx the context that will run a bidirectional search
+void searchContext_enableBackward(SearchContext* ctx)
+{
+    if(ctx->back_stamps)return;
+
+    uint32_t len = ctx->num_nodes ? ctx->num_nodes : 1;
+    ctx->back_stamps = (uint32_t*)calloc(len, sizeof(uint32_t));
+    ctx->back_parents = (uint32_t*)malloc(len * sizeof(uint32_t));
+    ctx->back_g_scores = (uint32_t*)malloc(len * sizeof(uint32_t));
+    if(!ctx->back_stamps || !ctx->back_parents || !ctx->back_g_scores)
+    {
+        perror("unable to allocate backward search arrays");
+        exit(0);
+    }
+    iheap_reserveId(&ctx->back_heap, len - 1);
+}
+
+/// @brief once the two halves of a bidirectional search meet this copies the
+///        backward path from the meeting node to the end into the forward state,
+///        after which the forward parents and g-scores describe the whole path
+/// @param ctx the context of the query
+/// @param meet a node reached by both halves
+/// @param end the end of the query
+void searchContext_joinBackward(SearchContext* ctx, uint32_t meet, uint32_t end)
+{
+    uint32_t meet_cost = ctx->g_scores[meet], meet_back_cost = ctx->back_g_scores[meet];
+    uint32_t current = meet;
+    while(current != end)
+    {
+        uint32_t next = ctx->back_parents[current];
+        searchContext_visit(ctx, next, current, meet_cost + meet_back_cost - ctx->back_g_scores[next]);
+        current = next;
+    }
+}
@@ -0,0 +1,146 @@
+#ifndef SEARCH_CONTEXT_H
+#define SEARCH_CONTEXT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "containers.h"
+#include "graph.h"
+
+// Counters and trace hooks for finding out why a query was slow. Building with
+// -DSEARCH_STATS gives every search context a SearchStats that the search
+// loops fill in and an optional hook that sees every city as it is expanded,
+// without it the macros below expand to nothing and the loops are unchanged
+typedef struct search_stats{
+    uint64_t popped; // cities taken off the frontier
+    uint64_t stalled; // popped cities a contraction hierarchy search did not expand
+    uint64_t relaxed; // connections looked at from expanded cities
+    uint64_t pushed; // cities added to the frontier
+    uint64_t decrease_keys; // frontier entries lowered to a cheaper path
+    uint32_t peak_frontier; // the most cities the frontier held at once
+} SearchStats;
+
+// what a trace hook is being told about
+typedef enum search_trace_event{
+    SEARCH_TRACE_BEGIN, // a new query started, node is NO_PARENT
+    SEARCH_TRACE_EXPAND, // node is about to be expanded, g_score is its cost from the start
+    SEARCH_TRACE_EXPAND_BACKWARD, // as above for the backward half, g_score is its cost to the end
+} SearchTraceEvent;
+
+typedef void SearchTraceHook(void* arg, SearchTraceEvent event, uint32_t node, uint32_t g_score);
+
+#ifdef SEARCH_STATS
+#define SEARCH_STAT(ctx, field, n) ((ctx)->stats.field += (n))
+#define SEARCH_STAT_FRONTIER(ctx, size) do{ \
+        if((size) > (ctx)->stats.peak_frontier)(ctx)->stats.peak_frontier = (size); \
+    }while(0)
+#define SEARCH_TRACE(ctx, event, node, g_score) do{ \
+        if((ctx)->trace)(ctx)->trace((ctx)->trace_arg, event, node, g_score); \
+    }while(0)
+#else
+#define SEARCH_STAT(ctx, field, n) ((void)0)
+#define SEARCH_STAT_FRONTIER(ctx, size) ((void)0)
+#define SEARCH_TRACE(ctx, event, node, g_score) ((void)0)
+#endif
+
+// The search functions keep everything they learn about a query in a search
+// context rather than in the graph, so one graph can be shared by any number
+// of concurrent searches. Visited marks are generation stamps, a node only
+// counts as visited when its stamp matches the current generation, so
+// starting a new query is a single increment instead of an O(V) reset
+#define NO_PARENT UINT32_MAX
+
+// the memory ceiling of the memory bounded searches and what their last query used
+typedef struct bounded_search{
+    size_t memory_limit; // the most bytes a query may hold beyond the context, 0 for BOUNDED_DEFAULT_LIMIT
+    size_t peak_bytes; // the most the last query held at once
+    uint64_t expanded; // the cities the last query expanded, counting every re-expansion
+    uint32_t best; // the reached city that looked closest to the end, NO_PARENT before any query
+    bool limit_hit; // the last query ran into the ceiling, when it failed the path to best is in the context
+} BoundedSearch;
+
+// the inflation and latency budget of the weighted and anytime searches and
+// the bound on the path their last query returned
+typedef struct anytime_search{
+    double weight; // the inflation of the estimate in weightedAStar, 0 for ANYTIME_DEFAULT_WEIGHT
+    double initial_weight; // the inflation anytimeAStar starts from, 0 for ANYTIME_DEFAULT_INITIAL
+    double weight_step; // how much anytimeAStar lowers the inflation after each path, 0 for ANYTIME_DEFAULT_STEP
+    uint64_t budget_ns; // how long a query may take, 0 for no deadline
+    double bound; // the path of the last query costs at most bound times the cheapest path
+    uint32_t lower_bound; // no path of the last query costs less than this
+    uint32_t solutions; // the paths the last query found, each cheaper than the one before
+    uint64_t first_ns; // how long the last query took to find its first path
+    uint64_t expanded; // the cities the last query expanded, counting every re-expansion
+    bool deadline_hit; // the last query ran out of budget, when it succeeded the path is the best found in time
+} AnytimeSearch;
+
+typedef struct search_context{
+    uint32_t num_nodes; // the number of nodes the context can track
+    uint32_t generation; // the stamp of the current query
+    uint32_t* stamps; // stamps[v] == generation when v has been reached this query
+    uint32_t* parents; // the node v was reached from, valid only when v is stamped
+    uint32_t* g_scores; // the cost of the path v was reached by, valid only when v is stamped
+    IHeap heap; // the priority queue for weighted searches, kept between queries
+    IdQueue queue; // the frontier for breadth first searches, kept between queries
+    IdStack stack; // the frontier for depth first searches, kept between queries
+
+    // the same state for the backward half of bidirectional searches, these
+    // share the generation of the forward state and are allocated on first use
+    uint32_t* back_stamps;
+    uint32_t* back_parents;
+    uint32_t* back_g_scores;
+    IHeap back_heap;
+    IdQueue back_queue;
+    BoundedSearch bounded; // the ceiling of idaStar and memoryBoundedAStar, set memory_limit before searching
+    AnytimeSearch anytime; // the inflation and budget of weightedAStar and anytimeAStar
+
+#ifdef SEARCH_STATS
+    SearchStats stats; // what the current query has done so far, reset by searchContext_begin
+    SearchTraceHook* trace; // told about every expansion when set
+    void* trace_arg; // handed to trace
+#endif
+} SearchContext;
+
+SearchContext* searchContext_create(const Graph* graph);
+void searchContext_free(SearchContext* ctx);
+void searchContext_begin(SearchContext* ctx);
+void searchContext_enableBackward(SearchContext* ctx);
+void searchContext_joinBackward(SearchContext* ctx, uint32_t meet, uint32_t end);
+
+/// @brief a function to check if a node has been reached in the current query
+static inline bool searchContext_visited(const SearchContext* ctx, uint32_t node)
+{
+    return ctx->stamps[node] == ctx->generation;
+}
+
+/// @brief marks a node as reached in the current query
+/// @param ctx the context of the query
+/// @param node the node that was reached
+/// @param parent the node it was reached from (NO_PARENT for the start)
+/// @param g_score the cost of the path it was reached by
+static inline void searchContext_visit(SearchContext* ctx, uint32_t node, uint32_t parent, uint32_t g_score)
+{
+    ctx->stamps[node] = ctx->generation;
+    ctx->parents[node] = parent;
+    ctx->g_scores[node] = g_score;
+}
+
+/// @brief a function to check if a node has been reached by the backward half of the current query
+static inline bool searchContext_visitedBack(const SearchContext* ctx, uint32_t node)
+{
+    return ctx->back_stamps[node] == ctx->generation;
+}
+
+/// @brief marks a node as reached by the backward half of the current query
+/// @param ctx the context of the query
+/// @param node the node that was reached
+/// @param parent the node it was reached from, one step closer to the end (NO_PARENT for the end)
+/// @param g_score the cost of the path from the node to the end
+static inline void searchContext_visitBack(SearchContext* ctx, uint32_t node, uint32_t parent, uint32_t g_score)
+{
+    ctx->back_stamps[node] = ctx->generation;
+    ctx->back_parents[node] = parent;
+    ctx->back_g_scores[node] = g_score;
+}
+
+#endif
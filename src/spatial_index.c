@@ -0,0 +1,256 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "spatial_index.h"
+#include "graph.h"
+#include "util.h"
+
+// A k-d tree over the city coordinates, stored implicitly in one array: the
+// middle entry of every range is its median along the range's axis, the
+// entries before it are on the low side and the ones after on the high side.
+// It snaps a point to the nearest city in logarithmic time, where getCity
+// needs a name and a scan of every city. It also carries a coordinate lower
+// bound, every connection is at least scale times its straight line length
+// so by the triangle inequality so is every path, for any pair of cities.
+// Coordinates are expected within +-2^30 so squared distances fit 64 bits
+#define SPATIAL_LEAF 8 // ranges this small are scanned instead of split
+
+/// @brief swaps two entries of the tree arrays
+static inline void spatialIndex_swap(SpatialIndex* index, uint32_t a, uint32_t b)
+{
+    uint32_t node = index->nodes[a];index->nodes[a] = index->nodes[b];index->nodes[b] = node;
+    int32_t x = index->xs[a];index->xs[a] = index->xs[b];index->xs[b] = x;
+    int32_t y = index->ys[a];index->ys[a] = index->ys[b];index->ys[b] = y;
+}
+
+/// @brief quickselect, moves the entry that belongs at position k of the
+///        range sorted along an axis there, with nothing greater before it
+///        and nothing smaller after it
+static void spatialIndex_select(SpatialIndex* index, uint32_t lo, uint32_t hi, uint32_t k, bool vertical)
+{
+    int32_t* keys = vertical ? index->ys : index->xs;
+    while(hi - lo > 1)
+    {
+        // median of three pivot moved to the end of the range
+        uint32_t mid = lo + (hi - lo) / 2, last = hi - 1;
+        if(keys[mid] < keys[lo])spatialIndex_swap(index, mid, lo);
+        if(keys[last] < keys[lo])spatialIndex_swap(index, last, lo);
+        if(keys[mid] < keys[last])spatialIndex_swap(index, mid, last);
+        int32_t pivot = keys[last];
+
+        // entries equal to the pivot alternate sides so duplicates still split evenly
+        uint32_t store = lo;
+        bool equal_left = false;
+        for(uint32_t i = lo; i < last; i++)
+        {
+            if(keys[i] < pivot || (keys[i] == pivot && (equal_left = !equal_left)))
+                spatialIndex_swap(index, i, store++);
+        }
+        spatialIndex_swap(index, store, last);
+
+        if(k == store)return;
+        if(k < store)hi = store;
+        else lo = store + 1;
+    }
+}
+
+/// @brief splits a range at its median and recurses into both halves
+static void spatialIndex_split(SpatialIndex* index, uint32_t lo, uint32_t hi, bool vertical)
+{
+    while(hi - lo > SPATIAL_LEAF)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        spatialIndex_select(index, lo, hi, mid, vertical);
+        spatialIndex_split(index, lo, mid, !vertical);
+        lo = mid + 1;
+        vertical = !vertical;
+    }
+}
+
+/// @brief builds the k-d tree over the coordinates of every city and measures
+///        the coordinate scale, attach the result to graph->spatial to make
+///        heuristic use the coordinate bound
+/// @param graph the graph to index, cities without coordinates sit at 0, 0
+///        which only weakens the bound
+/// @return a newly allocated index, freed along with the graph
+SpatialIndex* spatialIndex_build(const Graph* graph)
+{
+    uint32_t n = graph->num_nodes;
+    SpatialIndex* index = (SpatialIndex*)calloc(1, sizeof(SpatialIndex));
+    if(index == NULL)
+    {
+        perror("unable to calloc spatial index");
+        exit(0);
+    }
+    index->count = n;
+    index->nodes = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    index->xs = (int32_t*)malloc((n ? n : 1) * sizeof(int32_t));
+    index->ys = (int32_t*)malloc((n ? n : 1) * sizeof(int32_t));
+    if(!index->nodes || !index->xs || !index->ys)
+    {
+        perror("unable to allocate spatial index arrays");
+        exit(0);
+    }
+    for(uint32_t v = 0; v < n; v++)
+    {
+        index->nodes[v] = v;
+        index->xs[v] = graph->cities[v].x;
+        index->ys[v] = graph->cities[v].y;
+    }
+    spatialIndex_split(index, 0, n, false);
+
+    // weights can only be raised from the ones the graph was built with, so a
+    // scale that holds for those holds for every later change of graph_setWeight
+    const uint32_t* weights = graph->base_weights ? graph->base_weights : graph->weights;
+    double scale = -1;
+    for(uint32_t v = 0; v < n; v++)
+    {
+        for(uint32_t i = graph->offsets[v]; i < graph->offsets[v + 1]; i++)
+        {
+            const City* to = graph->cities + graph->targets[i];
+            uint64_t dist2 = spatial_dist2(graph->cities[v].x, graph->cities[v].y, to->x, to->y);
+            if(dist2 == 0)continue;
+            double ratio = weights[i] / spatial_sqrt((double)dist2);
+            if(scale < 0 || ratio < scale)scale = ratio;
+        }
+    }
+    // shrunk a little so rounding in the square roots never lifts a bound past the real cost
+    index->scale = scale > 0 ? scale * (1 - 1e-9) : 0;
+    return index;
+}
+
+/// @brief releases the memory held by a spatial index
+void spatialIndex_free(SpatialIndex* index)
+{
+    free(index->nodes);
+    free(index->xs);
+    free(index->ys);
+    free(index);
+}
+
+/// @brief descends the tree towards a point, visiting the far side of a
+///        split only when it could hold something closer than the best so far
+static void spatialIndex_search(const SpatialIndex* index, uint32_t lo, uint32_t hi, bool vertical,
+    int32_t x, int32_t y, uint32_t* best, uint64_t* best_dist2)
+{
+    while(hi - lo > SPATIAL_LEAF)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint64_t dist2 = spatial_dist2(x, y, index->xs[mid], index->ys[mid]);
+        if(dist2 < *best_dist2)
+        {
+            *best_dist2 = dist2;
+            *best = mid;
+        }
+
+        int64_t diff = vertical ? (int64_t)y - index->ys[mid] : (int64_t)x - index->xs[mid];
+        if(diff < 0)
+        {
+            spatialIndex_search(index, lo, mid, !vertical, x, y, best, best_dist2);
+            if((uint64_t)(diff * diff) >= *best_dist2)return;
+            lo = mid + 1;
+        }
+        else
+        {
+            spatialIndex_search(index, mid + 1, hi, !vertical, x, y, best, best_dist2);
+            if((uint64_t)(diff * diff) >= *best_dist2)return;
+            hi = mid;
+        }
+        vertical = !vertical;
+    }
+    for(uint32_t i = lo; i < hi; i++)
+    {
+        uint64_t dist2 = spatial_dist2(x, y, index->xs[i], index->ys[i]);
+        if(dist2 < *best_dist2)
+        {
+            *best_dist2 = dist2;
+            *best = i;
+        }
+    }
+}
+
+/// @brief finds the city closest to a point
+/// @param index the spatial index to search
+/// @param x the x coordinate of the point
+/// @param y the y coordinate of the point
+/// @return the id of the nearest city, SPATIAL_NONE when the index is empty
+uint32_t spatialIndex_nearest(const SpatialIndex* index, int32_t x, int32_t y)
+{
+    if(index->count == 0)return SPATIAL_NONE;
+    uint32_t best = 0;
+    uint64_t best_dist2 = UINT64_MAX;
+    spatialIndex_search(index, 0, index->count, false, x, y, &best, &best_dist2);
+    return index->nodes[best];
+}
+
+/// @brief interleaves the bits of two 16 bit numbers, the position of a
+///        point along a Z order curve where nearby points mostly get nearby positions
+static inline uint32_t spatial_zOrder(uint32_t x, uint32_t y)
+{
+    uint32_t spread[2] = {x & 0xffff, y & 0xffff};
+    for(uint32_t i = 0; i < 2; i++)
+    {
+        uint32_t v = spread[i];
+        v = (v | v << 8) & 0x00ff00ffu;
+        v = (v | v << 4) & 0x0f0f0f0fu;
+        v = (v | v << 2) & 0x33333333u;
+        v = (v | v << 1) & 0x55555555u;
+        spread[i] = v;
+    }
+    return spread[0] | spread[1] << 1;
+}
+
+/// @brief finds the city closest to each of many points. The points are
+///        visited along a Z order curve over their bounding box so
+///        consecutive searches walk mostly the same part of the tree
+/// @param index the spatial index to search
+/// @param xs the x coordinates of the points
+/// @param ys the y coordinates of the points
+/// @param count the number of points
+/// @param nodes filled with the id of the nearest city to each point
+void spatialIndex_nearestMany(const SpatialIndex* index, const int32_t* xs, const int32_t* ys, uint32_t count, uint32_t* nodes)
+{
+    if(index->count == 0 || count == 0)
+    {
+        for(uint32_t i = 0; i < count; i++)
+            nodes[i] = SPATIAL_NONE;
+        return;
+    }
+
+    // the bounding box of the points scaled down to 16 bits a side
+    int32_t min_x = xs[0], min_y = ys[0], max_x = xs[0], max_y = ys[0];
+    for(uint32_t i = 1; i < count; i++)
+    {
+        if(xs[i] < min_x)min_x = xs[i];
+        if(xs[i] > max_x)max_x = xs[i];
+        if(ys[i] < min_y)min_y = ys[i];
+        if(ys[i] > max_y)max_y = ys[i];
+    }
+    uint64_t span = (uint64_t)((int64_t)max_x - min_x) > (uint64_t)((int64_t)max_y - min_y)
+        ? (uint64_t)((int64_t)max_x - min_x) : (uint64_t)((int64_t)max_y - min_y);
+    uint32_t shift = 0;
+    while(span >> shift > 0xffff)shift++;
+
+    // the points in Z order, each key is packed with the index of its point
+    uint64_t* sorted = (uint64_t*)malloc(count * sizeof(uint64_t));
+    if(sorted == NULL)
+    {
+        perror("unable to malloc snapping order");
+        exit(0);
+    }
+    for(uint32_t i = 0; i < count; i++)
+    {
+        uint32_t key = spatial_zOrder((uint32_t)(((int64_t)xs[i] - min_x) >> shift), (uint32_t)(((int64_t)ys[i] - min_y) >> shift));
+        sorted[i] = (uint64_t)key << 32 | i;
+    }
+    radixSortKeys(sorted, count);
+
+    for(uint32_t k = 0; k < count; k++)
+    {
+        uint32_t i = (uint32_t)sorted[k];
+        nodes[i] = spatialIndex_nearest(index, xs[i], ys[i]);
+    }
+    free(sorted);
+}
@@ -0,0 +1,58 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <stdint.h>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+#include "graph.h"
+
+#define SPATIAL_NONE UINT32_MAX // the nearest city of an empty index
+
+struct spatial_index{
+    uint32_t count; // the number of cities in the tree
+    uint32_t* nodes; // the city ids in tree order
+    int32_t* xs; // the x coordinate of nodes[i], kept beside it so queries do not touch the cities
+    int32_t* ys; // the y coordinate of nodes[i]
+    double scale; // the cost of a connection divided by its straight line length is never below this, 0 when unknown
+};
+
+SpatialIndex* spatialIndex_build(const Graph* graph);
+void spatialIndex_free(SpatialIndex* index);
+uint32_t spatialIndex_nearest(const SpatialIndex* index, int32_t x, int32_t y);
+void spatialIndex_nearestMany(const SpatialIndex* index, const int32_t* xs, const int32_t* ys, uint32_t count, uint32_t* nodes);
+
+/// @brief the square root of a number, without the C maths library
+static inline double spatial_sqrt(double value)
+{
+#if defined(__x86_64__) && defined(__GNUC__)
+    return _mm_cvtsd_f64(_mm_sqrt_sd(_mm_setzero_pd(), _mm_set_sd(value)));
+#else
+    // Newton's method converges from above for any start above the root
+    double root = value > 1 ? value : 1, next = 0;
+    while((next = 0.5 * (root + value / root)) < root)root = next;
+    return root;
+#endif
+}
+
+/// @brief the squared straight line distance between two points
+static inline uint64_t spatial_dist2(int32_t ax, int32_t ay, int32_t bx, int32_t by)
+{
+    int64_t dx = (int64_t)ax - bx, dy = (int64_t)ay - by;
+    return (uint64_t)(dx * dx) + (uint64_t)(dy * dy);
+}
+
+/// @brief the coordinate lower bound on the cost of travelling between two cities
+/// @param index the spatial index of the graph
+/// @param graph the graph the cities belong to
+/// @param node the id of the city the estimate is from
+/// @param target the id of the city the estimate is to
+/// @return scale times the straight line distance rounded down
+static inline uint32_t spatialIndex_bound(const SpatialIndex* index, const Graph* graph, uint32_t node, uint32_t target)
+{
+    const City* a = graph->cities + node, *b = graph->cities + target;
+    double bound = index->scale * spatial_sqrt((double)spatial_dist2(a->x, a->y, b->x, b->y));
+    return bound < (double)UINT32_MAX ? (uint32_t)bound : UINT32_MAX - 1;
+}
+
+#endif
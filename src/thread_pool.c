@@ -0,0 +1,118 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+typedef struct thread_pool_worker{
+    ThreadPool* pool;
+    uint32_t index;
+} ThreadPoolWorker;
+
+/// @brief the loop every pool thread runs, waits for a round and runs its task
+static void* threadPool_worker(void* param)
+{
+    ThreadPoolWorker* self = (ThreadPoolWorker*)param;
+    ThreadPool* pool = self->pool;
+    uint64_t seen_round = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while(true)
+    {
+        while(!pool->stopping && pool->round == seen_round)
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        if(pool->stopping)break;
+
+        seen_round = pool->round;
+        PoolTask* task = pool->task;
+        void* arg = pool->arg;
+        pthread_mutex_unlock(&pool->lock);
+
+        task(arg, self->index);
+
+        pthread_mutex_lock(&pool->lock);
+        if(--pool->busy == 0)
+            pthread_cond_signal(&pool->work_done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    free(self);
+    return NULL;
+}
+
+/// @brief starts a pool of worker threads
+/// @param num_workers the number of workers, 0 uses one per online core
+/// @return a new thread pool, free it with threadPool_free
+ThreadPool* threadPool_create(uint32_t num_workers)
+{
+    if(num_workers == 0)
+    {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_workers = cores > 0 ? (uint32_t)cores : 1;
+    }
+
+    ThreadPool* pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if(pool == NULL || (pool->threads = (pthread_t*)calloc(num_workers, sizeof(pthread_t))) == NULL)
+    {
+        perror("unable to calloc thread pool");
+        exit(0);
+    }
+    pool->num_workers = num_workers;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    for(uint32_t i = 0; i < num_workers; i++)
+    {
+        ThreadPoolWorker* worker = (ThreadPoolWorker*)malloc(sizeof(ThreadPoolWorker));
+        if(worker == NULL)
+        {
+            perror("unable to malloc thread pool worker");
+            exit(0);
+        }
+        *worker = (ThreadPoolWorker){pool, i};
+        if(pthread_create(&pool->threads[i], NULL, threadPool_worker, worker) != 0)
+        {
+            perror("unable to start thread pool worker");
+            exit(0);
+        }
+    }
+    return pool;
+}
+
+/// @brief runs a task once on every worker of the pool and waits for all of them
+/// @param pool the pool to run on
+/// @param task the task, it is given the argument and the worker index
+/// @param arg the argument passed to every call of the task
+void threadPool_run(ThreadPool* pool, PoolTask* task, void* arg)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->arg = arg;
+    pool->busy = pool->num_workers;
+    pool->round++;
+    pthread_cond_broadcast(&pool->work_ready);
+    while(pool->busy > 0)
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/// @brief stops the workers and releases the pool
+void threadPool_free(ThreadPool* pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(uint32_t i = 0; i < pool->num_workers; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_cond_destroy(&pool->work_done);
+    free(pool->threads);
+    free(pool);
+}
@@ -0,0 +1,30 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// A fixed set of worker threads that all run the same task each round, the
+// caller blocks until every worker has finished, tasks split the work between
+// themselves using the worker index they are handed
+typedef void PoolTask(void* arg, uint32_t worker);
+
+typedef struct thread_pool{
+    uint32_t num_workers; // the number of worker threads
+    pthread_t* threads;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready; // signalled when a new round starts
+    pthread_cond_t work_done; // signalled when the last worker of a round finishes
+    PoolTask* task; // the task of the current round
+    void* arg; // the argument of the current round
+    uint64_t round; // incremented every time a round starts
+    uint32_t busy; // the number of workers still running the current round
+    bool stopping; // set when the pool is being torn down
+} ThreadPool;
+
+ThreadPool* threadPool_create(uint32_t num_workers);
+void threadPool_run(ThreadPool* pool, PoolTask* task, void* arg);
+void threadPool_free(ThreadPool* pool);
+
+#endif
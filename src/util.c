@@ -0,0 +1,71 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "util.h"
+
+/// @brief iterates through an array of pointers and finds the index of the first null pointer
+/// @param arr the array you want to find the length of
+/// @return the length of the array
+uint32_t nullTermArrLen(void *arr[])
+{
+    for(uint32_t i = 0; true; i++)
+    {
+        if((void*)arr[i] == NULL)return i;
+    }
+}
+
+/// @brief a small xorshift generator so benchmark runs are repeatable
+/// @param state the generator state, must not be zero
+/// @return the next pseudo random number
+uint32_t xorshift32(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+#define RADIX_BITS 11 // three passes sort a 32 bit key
+
+/// @brief sorts values by the key in their upper 32 bits with a least
+///        significant digit radix sort, values with equal keys keep their order
+/// @param values the values to sort, usually a key packed with an index below it
+/// @param count the number of values
+void radixSortKeys(uint64_t* values, uint32_t count)
+{
+    uint64_t* scratch = (uint64_t*)malloc((count ? count : 1) * sizeof(uint64_t));
+    uint32_t buckets[(1u << RADIX_BITS) + 1];
+    if(scratch == NULL)
+    {
+        perror("unable to malloc radix sort scratch");
+        exit(0);
+    }
+    uint64_t* from = values, *to = scratch;
+    for(uint32_t shift = 32; shift < 64; shift += RADIX_BITS)
+    {
+        uint32_t mask = (1u << RADIX_BITS) - 1;
+        memset(buckets, 0, sizeof(buckets));
+        for(uint32_t i = 0; i < count; i++)
+            buckets[(from[i] >> shift & mask) + 1]++;
+        for(uint32_t d = 0; d < mask; d++)
+            buckets[d + 1] += buckets[d];
+        for(uint32_t i = 0; i < count; i++)
+            to[buckets[from[i] >> shift & mask]++] = from[i];
+        uint64_t* swap = from;from = to;to = swap;
+    }
+    if(from != values)
+        memcpy(values, from, count * sizeof(uint64_t));
+    free(scratch);
+}
+
+/// @brief the current value of the monotonic clock in nanoseconds
+uint64_t nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
@@ -0,0 +1,11 @@
+#ifndef UTIL_H
+#define UTIL_H
+
+#include <stdint.h>
+
+uint32_t nullTermArrLen(void *arr[]);
+uint32_t xorshift32(uint32_t* state);
+void radixSortKeys(uint64_t* values, uint32_t count);
+uint64_t nowNs();
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "graph.h"
+#include "search.h"
+
+// A few checks and slow but obviously right references for the regression
+// tests, every test is a program that returns the number of failed checks
+static uint32_t test_failures = 0;
+
+#define CHECK(cond) do{ \
+    if(!(cond)){ \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        test_failures++; \
+    } \
+} while(0)
+
+#define CHECK_EQ(a, b) do{ \
+    uint64_t check_a = (uint64_t)(a), check_b = (uint64_t)(b); \
+    if(check_a != check_b){ \
+        fprintf(stderr, "%s:%d: check failed: %s == %s (%llu != %llu)\n", __FILE__, __LINE__, #a, #b, \
+            (unsigned long long)check_a, (unsigned long long)check_b); \
+        test_failures++; \
+    } \
+} while(0)
+
+#define TEST_UNREACHABLE UINT32_MAX
+
+/// @brief the distance from a source to every city by the quadratic Dijkstra,
+///        kept apart from the heaps and filters the searches use
+/// @param hops true to count every open connection as 1
+/// @return a newly allocated array of num_nodes distances, TEST_UNREACHABLE where there is no path
+static inline uint32_t* test_distances(const Graph* graph, uint32_t source, bool hops)
+{
+    uint32_t n = graph->num_nodes;
+    uint32_t* dist = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    bool* done = (bool*)calloc(n ? n : 1, sizeof(bool));
+    if(dist == NULL || done == NULL)
+    {
+        perror("unable to allocate test distances");
+        exit(1);
+    }
+    for(uint32_t v = 0; v < n; v++)
+        dist[v] = TEST_UNREACHABLE;
+    dist[source] = 0;
+    while(true)
+    {
+        uint32_t current = TEST_UNREACHABLE;
+        for(uint32_t v = 0; v < n; v++)
+        {
+            if(!done[v] && dist[v] != TEST_UNREACHABLE && (current == TEST_UNREACHABLE || dist[v] < dist[current]))
+                current = v;
+        }
+        if(current == TEST_UNREACHABLE)break;
+        done[current] = true;
+        for(uint32_t i = graph->offsets[current]; i < graph->offsets[current + 1]; i++)
+        {
+            if(graph->weights[i] == CONNECTION_CLOSED)continue;
+            uint64_t cost = (uint64_t)dist[current] + (hops ? 1 : graph->weights[i]);
+            if(cost < dist[graph->targets[i]])dist[graph->targets[i]] = (uint32_t)cost;
+        }
+    }
+    free(done);
+    return dist;
+}
+
+/// @brief the cheapest open connection between two cities
+/// @return its length or CONNECTION_CLOSED if there is none
+static inline uint32_t test_weight(const Graph* graph, uint32_t from, uint32_t to)
+{
+    uint32_t best = CONNECTION_CLOSED;
+    for(uint32_t i = graph->offsets[from]; i < graph->offsets[from + 1]; i++)
+    {
+        if(graph->targets[i] == to && graph->weights[i] < best)best = graph->weights[i];
+    }
+    return best;
+}
+
+/// @brief checks that a path runs from start to end along open connections
+/// @return the cost of the path taking the cheapest connection of every step
+static inline uint64_t test_checkPath(const Graph* graph, const Path* path, uint32_t start, uint32_t end)
+{
+    CHECK(path->len > 0);
+    if(path->len == 0)return 0;
+    CHECK_EQ(path->nodes[0], start);
+    CHECK_EQ(path->nodes[path->len - 1], end);
+    uint64_t cost = 0;
+    for(uint32_t i = 1; i < path->len; i++)
+    {
+        uint32_t weight = test_weight(graph, path->nodes[i - 1], path->nodes[i]);
+        CHECK(weight != CONNECTION_CLOSED);
+        if(weight == CONNECTION_CLOSED)return UINT64_MAX;
+        cost += weight;
+    }
+    return cost;
+}
+
+#endif
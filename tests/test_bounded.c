@@ -0,0 +1,57 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "test.h"
+#include "graph.h"
+#include "graph_generate.h"
+#include "search.h"
+#include "search_context.h"
+#include "bounded_search.h"
+#include "util.h"
+
+// memoryBoundedAStar under ceilings from roomy down to a few hundred bytes,
+// a path it finds is still the cheapest and a query it gives up on says so
+#define TEST_QUERIES 40
+
+static void checkLimit(const Graph* graph, size_t limit, uint32_t seed, uint32_t* found_count)
+{
+    SearchContext* ctx = searchContext_create(graph);
+    ctx->bounded.memory_limit = limit;
+    for(uint32_t q = 0; q < TEST_QUERIES; q++)
+    {
+        uint32_t start = xorshift32(&seed) % graph->num_nodes, end = xorshift32(&seed) % graph->num_nodes;
+        uint32_t* reference = test_distances(graph, start, false);
+        Path path = path_init(NULL, NULL, 0);
+        bool found = path_find(&path, graph, ctx, memoryBoundedAStar_run, start, end);
+        CHECK(ctx->bounded.peak_bytes <= limit);
+        if(found)
+        {
+            CHECK_EQ(test_checkPath(graph, &path, start, end), reference[end]);
+            CHECK_EQ(path.cost, reference[end]);
+            (*found_count)++;
+        }
+        else
+        {
+            CHECK(ctx->bounded.limit_hit);
+        }
+        path_free(&path);
+        free(reference);
+    }
+    searchContext_free(ctx);
+}
+
+int main(void)
+{
+    Graph* graph = generateGridGraph(16, 16, 7);
+    uint32_t roomy = 0, tight = 0;
+    checkLimit(graph, 1 << 20, 1, &roomy);
+    CHECK_EQ(roomy, TEST_QUERIES);
+    checkLimit(graph, 4096, 2, &tight);
+    checkLimit(graph, 512, 3, &tight);
+    graph_free(graph);
+
+    if(test_failures)
+        fprintf(stderr, "%u checks failed\n", test_failures);
+    return test_failures != 0;
+}
@@ -0,0 +1,257 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include "test.h"
+#include "graph.h"
+#include "graph_file.h"
+#include "graph_import.h"
+#include "graph_generate.h"
+
+// The importers on small files written here, and graph_save/graph_load round
+// trips of imported and generated graphs. The files go in the working
+// directory, which ctest points at the build directory
+
+/// @brief writes text to a file
+static void writeFile(const char* path, const char* text)
+{
+    FILE* file = fopen(path, "wb");
+    if(file == NULL)
+    {
+        perror(path);
+        exit(1);
+    }
+    fputs(text, file);
+    fclose(file);
+}
+
+/// @brief checks that two graphs have the same cities and connections
+static void checkSameGraph(const Graph* a, const Graph* b)
+{
+    CHECK_EQ(a->num_nodes, b->num_nodes);
+    CHECK_EQ(a->num_edges, b->num_edges);
+    CHECK_EQ(a->asymmetric, b->asymmetric);
+    if(a->num_nodes != b->num_nodes || a->num_edges != b->num_edges)return;
+    for(uint32_t v = 0; v <= a->num_nodes; v++)
+        CHECK_EQ(a->offsets[v], b->offsets[v]);
+    for(uint32_t i = 0; i < a->num_edges; i++)
+    {
+        CHECK_EQ(a->targets[i], b->targets[i]);
+        CHECK_EQ(a->weights[i], b->weights[i]);
+    }
+    for(uint32_t v = 0; v < a->num_nodes; v++)
+    {
+        const City* x = &a->cities[v];
+        const City* y = &b->cities[v];
+        CHECK((x->name == NULL) == (y->name == NULL));
+        if(x->name && y->name)CHECK(strcmp(x->name, y->name) == 0);
+        CHECK_EQ(x->straight_distance, y->straight_distance);
+        CHECK_EQ(x->x, y->x);
+        CHECK_EQ(x->y, y->y);
+    }
+}
+
+/// @brief saves a graph, loads it back and compares the two
+static void checkRoundTrip(const Graph* graph, const char* path)
+{
+    CHECK(graph_save(graph, path));
+    Graph* loaded = graph_load(path);
+    CHECK(loaded != NULL);
+    if(loaded == NULL)return;
+    checkSameGraph(graph, loaded);
+    graph_free(loaded);
+    remove(path);
+}
+
+// the two versions of a file that changes between the reads of an importer
+typedef struct changing_file{
+    const char* path;
+    const char* first;
+    const char* second;
+} ChangingFile;
+
+/// @brief writes one version of a file into the fifo at its path, opening
+///        the fifo waits for the importer to open it for reading
+static void writeFifo(const char* path, const char* text)
+{
+    int fd = open(path, O_WRONLY);
+    if(fd < 0)
+    {
+        perror(path);
+        exit(1);
+    }
+    for(size_t done = 0, len = strlen(text); done < len;)
+    {
+        ssize_t written = write(fd, text + done, len - done);
+        if(written <= 0)
+        {
+            perror(path);
+            exit(1);
+        }
+        done += (size_t)written;
+    }
+    close(fd);
+}
+
+/// @brief feeds the first version to the first read of a fifo and the second
+///        to the next, waiting for the importer to close the first in between
+static void* changingFile_run(void* arg)
+{
+    const ChangingFile* file = (const ChangingFile*)arg;
+    int watch = inotify_init();
+    if(watch < 0 || inotify_add_watch(watch, file->path, IN_CLOSE_NOWRITE) < 0)
+    {
+        perror("inotify");
+        exit(1);
+    }
+    writeFifo(file->path, file->first);
+    struct inotify_event event;
+    if(read(watch, &event, sizeof(event)) <= 0)
+    {
+        perror("inotify");
+        exit(1);
+    }
+    close(watch);
+    writeFifo(file->path, file->second);
+    return NULL;
+}
+
+/// @brief a file whose arcs move from one city to another between the two
+///        reads of the importer, with the same number of arcs both times
+static void checkChangedFile(void)
+{
+    ChangingFile file = {"test_graph_file.fifo",
+        "p sp 3 4\na 1 2 1\na 1 3 1\na 2 3 1\na 3 1 1\n",
+        "p sp 3 4\na 1 2 1\na 1 3 1\na 1 2 5\na 3 1 1\n"};
+    remove(file.path);
+    if(mkfifo(file.path, 0600) != 0)
+    {
+        perror(file.path);
+        exit(1);
+    }
+    pthread_t writer;
+    pthread_create(&writer, NULL, changingFile_run, &file);
+    Graph* graph = graph_importDimacs(file.path, NULL);
+    CHECK(graph == NULL);
+    if(graph)graph_free(graph);
+    pthread_join(writer, NULL);
+    remove(file.path);
+}
+
+static void checkDimacs(void)
+{
+    writeFile("test_graph_file.gr",
+        "c a small road network\n"
+        "p sp 4 5\n"
+        "a 1 2 7\n"
+        "a 2 3 5\n"
+        "a 3 4 2\n"
+        "a 1 3 20\n"
+        "a 4 1 9\n");
+    writeFile("test_graph_file.co",
+        "p aux sp co 4\n"
+        "v 1 0 0\n"
+        "v 2 10 -3\n"
+        "v 3 -20 40\n"
+        "v 4 5 5\n");
+    Graph* graph = graph_importDimacs("test_graph_file.gr", "test_graph_file.co");
+    CHECK(graph != NULL);
+    if(graph)
+    {
+        CHECK_EQ(graph->num_nodes, 4);
+        CHECK_EQ(graph->num_edges, 5);
+        CHECK_EQ(test_weight(graph, 0, 1), 7);
+        CHECK_EQ(test_weight(graph, 1, 2), 5);
+        CHECK_EQ(test_weight(graph, 2, 3), 2);
+        CHECK_EQ(test_weight(graph, 0, 2), 20);
+        CHECK_EQ(test_weight(graph, 3, 0), 9);
+        CHECK_EQ(test_weight(graph, 1, 0), CONNECTION_CLOSED);
+        // every connection is one way
+        CHECK_EQ(graph->asymmetric, 10);
+        CHECK_EQ(graph->cities[1].x, 10);
+        CHECK_EQ(graph->cities[1].y, -3);
+        CHECK_EQ(graph->cities[2].x, -20);
+        checkRoundTrip(graph, "test_graph_file.bin");
+        graph_free(graph);
+    }
+
+    writeFile("test_graph_file.gr", "p sp 2 1\na 1 2 x\n");
+    graph = graph_importDimacs("test_graph_file.gr", NULL);
+    CHECK(graph == NULL);
+    if(graph)graph_free(graph);
+
+    // the length of a closed connection can not be imported as an open one
+    writeFile("test_graph_file.gr", "p sp 2 2\na 1 2 3\na 2 1 4294967295\n");
+    graph = graph_importDimacs("test_graph_file.gr", NULL);
+    CHECK(graph == NULL);
+    if(graph)graph_free(graph);
+
+    remove("test_graph_file.gr");
+    remove("test_graph_file.co");
+}
+
+static void checkCsv(void)
+{
+    writeFile("test_graph_file_nodes.csv",
+        "name,straight_distance,x,y\n"
+        "Arad,366,1,2\n"
+        "Sibiu,253,3,4\n"
+        "Fagaras,176,5,6\n");
+    writeFile("test_graph_file_edges.csv",
+        "from,to,distance\n"
+        "Arad,Sibiu,140\n"
+        "Sibiu,Fagaras,99\n"
+        "Fagaras,Bucharest,211\n");
+    Graph* graph = graph_importCsv("test_graph_file_edges.csv", "test_graph_file_nodes.csv", true);
+    CHECK(graph != NULL);
+    if(graph)
+    {
+        CHECK_EQ(graph->num_nodes, 4);
+        CHECK_EQ(graph->num_edges, 6);
+        uint32_t arad = getCity("Arad", graph->cities, graph->num_nodes);
+        uint32_t sibiu = getCity("Sibiu", graph->cities, graph->num_nodes);
+        uint32_t fagaras = getCity("Fagaras", graph->cities, graph->num_nodes);
+        uint32_t bucharest = getCity("Bucharest", graph->cities, graph->num_nodes);
+        CHECK_EQ(test_weight(graph, arad, sibiu), 140);
+        CHECK_EQ(test_weight(graph, sibiu, arad), 140);
+        CHECK_EQ(test_weight(graph, fagaras, bucharest), 211);
+        CHECK_EQ(graph->cities[arad].straight_distance, 366);
+        CHECK_EQ(graph->cities[bucharest].straight_distance, 0);
+        CHECK_EQ(graph->cities[sibiu].x, 3);
+        CHECK_EQ(graph->asymmetric, 0);
+        checkRoundTrip(graph, "test_graph_file.bin");
+        graph_free(graph);
+    }
+
+    writeFile("test_graph_file_edges.csv",
+        "from,to,distance\n"
+        "Arad,Sibiu,140\n"
+        "Sibiu,Fagaras,4294967295\n");
+    graph = graph_importCsv("test_graph_file_edges.csv", NULL, false);
+    CHECK(graph == NULL);
+    if(graph)graph_free(graph);
+
+    remove("test_graph_file_nodes.csv");
+    remove("test_graph_file_edges.csv");
+}
+
+int main(void)
+{
+    checkDimacs();
+    checkChangedFile();
+    checkCsv();
+
+    Graph* generated = generateGeometricGraph(500, 6, 5);
+    checkRoundTrip(generated, "test_graph_file.bin");
+    graph_free(generated);
+
+    if(test_failures)
+        fprintf(stderr, "%u checks failed\n", test_failures);
+    return test_failures != 0;
+}
@@ -0,0 +1,61 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "test.h"
+#include "graph.h"
+#include "graph_generate.h"
+#include "graph_order.h"
+
+// Renumbering keeps every city and connection and the maps between the ids
+// the graph was built with and the current ids, however often it runs
+
+/// @brief checks a renumbered graph against a copy of the graph it was built as
+static void checkMapping(const Graph* graph, const Graph* built)
+{
+    CHECK_EQ(graph->num_nodes, built->num_nodes);
+    CHECK_EQ(graph->num_edges, built->num_edges);
+    for(uint32_t b = 0; b < built->num_nodes; b++)
+    {
+        uint32_t v = graph_reorderedId(graph, b);
+        CHECK(v < graph->num_nodes);
+        if(v >= graph->num_nodes)continue;
+        CHECK_EQ(graph_originalId(graph, v), b);
+        CHECK_EQ(graph->cities[v].x, built->cities[b].x);
+        CHECK_EQ(graph->cities[v].y, built->cities[b].y);
+        CHECK_EQ(graph->offsets[v + 1] - graph->offsets[v], built->offsets[b + 1] - built->offsets[b]);
+        for(uint32_t i = built->offsets[b]; i < built->offsets[b + 1]; i++)
+        {
+            uint32_t slot = graph->offsets[v] + (i - built->offsets[b]);
+            CHECK_EQ(graph->targets[slot], graph_reorderedId(graph, built->targets[i]));
+            CHECK_EQ(graph->weights[slot], built->weights[i]);
+        }
+    }
+}
+
+int main(void)
+{
+    Graph* graph = generateGeometricGraph(400, 6, 9);
+    Graph* built = generateGeometricGraph(400, 6, 9);
+
+    // a graph never renumbered maps every id to itself
+    for(uint32_t v = 0; v < graph->num_nodes; v++)
+    {
+        CHECK_EQ(graph_originalId(graph, v), v);
+        CHECK_EQ(graph_reorderedId(graph, v), v);
+    }
+
+    graph_reorder(graph, GRAPH_ORDER_HILBERT);
+    checkMapping(graph, built);
+    graph_reorder(graph, GRAPH_ORDER_RCM);
+    checkMapping(graph, built);
+    graph_reorder(graph, GRAPH_ORDER_BFS);
+    checkMapping(graph, built);
+
+    graph_free(built);
+    graph_free(graph);
+
+    if(test_failures)
+        fprintf(stderr, "%u checks failed\n", test_failures);
+    return test_failures != 0;
+}
@@ -0,0 +1,208 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "graph.h"
+#include "graph_generate.h"
+#include "query_server.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+// A server on a socket in the working directory answers pipelined valid and
+// invalid requests in the order they were sent, says none for a city no road
+// reaches and closes a connection whose request is longer than a line may be
+#define TEST_SOCKET "test_query_server.sock"
+#define TEST_ISOLATED 35 // the city of the 6 by 6 grid whose roads are closed
+
+/// @brief runs the server until it is stopped
+static void* serverThread(void* arg)
+{
+    queryServer_run((QueryServer*)arg);
+    return NULL;
+}
+
+/// @brief connects to the server, giving up on reads after a few seconds
+static int connectClient(void)
+{
+    struct sockaddr_un address = {0};
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, TEST_SOCKET);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+    {
+        perror(TEST_SOCKET);
+        exit(1);
+    }
+    struct timeval timeout = {10, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+/// @brief sends requests, closes the sending side and reads every response
+/// @return the responses, NUL terminated, free them when done
+static char* exchange(const char* requests)
+{
+    int fd = connectClient();
+    for(size_t sent = 0, len = strlen(requests); sent < len;)
+    {
+        ssize_t n = send(fd, requests + sent, len - sent, MSG_NOSIGNAL);
+        if(n <= 0)break;
+        sent += (size_t)n;
+    }
+    shutdown(fd, SHUT_WR);
+    size_t len = 0, capacity = 4096;
+    char* text = (char*)malloc(capacity);
+    ssize_t got;
+    while(text && (got = recv(fd, text + len, capacity - len - 1, 0)) > 0)
+    {
+        len += (size_t)got;
+        if(capacity - len == 1)
+            text = (char*)realloc(text, capacity *= 2);
+    }
+    if(text == NULL)
+    {
+        perror("unable to allocate responses");
+        exit(1);
+    }
+    text[len] = '\0';
+    close(fd);
+    return text;
+}
+
+/// @brief checks an ok line against the cheapest path between two cities
+static void checkRoute(const Graph* graph, char* line, uint32_t start, uint32_t end)
+{
+    char* cursor = line;
+    CHECK(strncmp(cursor, "ok ", 3) == 0);
+    if(strncmp(cursor, "ok ", 3) != 0)return;
+    uint32_t cost = (uint32_t)strtoul(cursor + 3, &cursor, 10);
+    strtoull(cursor, &cursor, 10); // elapsed_ns
+#ifdef SEARCH_STATS
+    CHECK(strtoull(cursor, &cursor, 10) > 0); // expanded
+#endif
+    uint32_t length = (uint32_t)strtoul(cursor, &cursor, 10);
+    uint32_t* reference = test_distances(graph, start, false);
+    CHECK_EQ(cost, reference[end]);
+    free(reference);
+
+    uint64_t walked = 0;
+    uint32_t previous = UINT32_MAX;
+    for(uint32_t i = 0; i < length; i++)
+    {
+        uint32_t city = (uint32_t)strtoul(cursor, &cursor, 10);
+        if(i == 0)CHECK_EQ(city, start);
+        if(i == length - 1)CHECK_EQ(city, end);
+        if(previous != UINT32_MAX)
+        {
+            uint32_t weight = test_weight(graph, previous, city);
+            CHECK(weight != CONNECTION_CLOSED);
+            walked += weight;
+        }
+        previous = city;
+    }
+    CHECK(*cursor == '\0');
+    CHECK_EQ(walked, cost);
+}
+
+/// @brief the next line of a response, split off in place
+static char* nextLine(char** cursor)
+{
+    char* line = *cursor;
+    char* newline = strchr(line, '\n');
+    if(newline == NULL)
+        return NULL;
+    *newline = '\0';
+    *cursor = newline + 1;
+    return line;
+}
+
+static void checkPipelined(const Graph* graph)
+{
+    char* responses = exchange(
+        "astar 0 34\n"
+        "nosuch 0 1\n"
+        "bfs 0 99\n"
+        "astar 0\n"
+        "biastar 34 0\n"
+        "astar 1,1 2\n"
+        "dijkstra\n"
+        "astar 0 35\n"
+        "ch 5 30\n"
+        "dfs 3 3\n");
+    char* cursor = responses;
+    char* line;
+    uint32_t num_lines = 0;
+    while((line = nextLine(&cursor)) != NULL)
+    {
+        switch(num_lines++)
+        {
+            case 0: checkRoute(graph, line, 0, 34); break;
+            case 1: CHECK(strcmp(line, "error unknown search") == 0); break;
+            case 2: CHECK(strcmp(line, "error unknown city") == 0); break;
+            case 3: CHECK(strcmp(line, "error expected <search> <start> <end>") == 0); break;
+            case 4: checkRoute(graph, line, 34, 0); break;
+            // without a spatial index a point names no city
+            case 5: CHECK(strcmp(line, "error unknown city") == 0); break;
+            case 6: CHECK(strcmp(line, "error expected <search> <start> <end>") == 0); break;
+            case 7: CHECK(strncmp(line, "none ", 5) == 0); break;
+            case 8: checkRoute(graph, line, 5, 30); break;
+            case 9: checkRoute(graph, line, 3, 3); break;
+        }
+    }
+    CHECK_EQ(num_lines, 10);
+    CHECK(*cursor == '\0');
+    free(responses);
+}
+
+static void checkTooLong(void)
+{
+    char request[400];
+    memset(request, 'a', sizeof(request) - 1);
+    request[sizeof(request) - 1] = '\0';
+    char* responses = exchange(request);
+    CHECK(strcmp(responses, "error request too long\n") == 0);
+    free(responses);
+}
+
+int main(void)
+{
+    Graph* graph = generateGridGraph(6, 6, 3);
+    for(uint32_t i = graph->offsets[TEST_ISOLATED]; i < graph->offsets[TEST_ISOLATED + 1]; i++)
+    {
+        CHECK(graph_setWeight(graph, TEST_ISOLATED, graph->targets[i], CONNECTION_CLOSED));
+        CHECK(graph_setWeight(graph, graph->targets[i], TEST_ISOLATED, CONNECTION_CLOSED));
+    }
+
+    QueryServer* server = queryServer_create(graph, TEST_SOCKET, 2);
+    CHECK(server != NULL);
+    if(server == NULL)return 1;
+    pthread_t thread;
+    pthread_create(&thread, NULL, serverThread, server);
+
+    checkPipelined(graph);
+    checkTooLong();
+    // the server keeps answering after a connection broke the protocol
+    checkPipelined(graph);
+
+    queryServer_stop(server);
+    pthread_join(thread, NULL);
+    queryServer_free(server);
+    graph_free(graph);
+
+    if(test_failures)
+        fprintf(stderr, "%u checks failed\n", test_failures);
+    return test_failures != 0;
+}
+#else
+int main(void)
+{
+    return 0;
+}
+#endif
@@ -0,0 +1,119 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "test.h"
+#include "graph.h"
+#include "graph_generate.h"
+#include "search.h"
+#include "search_context.h"
+#include "route_cache.h"
+#include "batch_engine.h"
+#include "util.h"
+
+// Cached routes report the cost the search found, also where two connections
+// run side by side, and go stale when the weights change between batches
+#define TEST_QUERIES 200
+
+/// @brief a grid whose horizontal roads each get a second, cheaper twin
+///        listed after the first one
+static Graph* twinGraph(void)
+{
+    const uint32_t side = 10;
+    City* cities = (City*)calloc(side * side, sizeof(City));
+    EdgeList edges = {0};
+    uint32_t seed = 17;
+    for(uint32_t v = 0; v < side * side; v++)
+    {
+        if(v % side + 1 < side)
+        {
+            uint32_t dist = 20 + xorshift32(&seed) % 80;
+            edgeList_add(&edges, v, v + 1, dist);
+            edgeList_add(&edges, v, v + 1, dist / 2);
+            edgeList_add(&edges, v + 1, v, dist);
+            edgeList_add(&edges, v + 1, v, dist / 2);
+        }
+        if(v + side < side * side)
+        {
+            uint32_t dist = 20 + xorshift32(&seed) % 80;
+            edgeList_add(&edges, v, v + side, dist);
+            edgeList_add(&edges, v + side, v, dist);
+        }
+    }
+    Graph* graph = graph_build(cities, side * side, &edges);
+    edgeList_free(&edges);
+    free(cities);
+    return graph;
+}
+
+/// @brief runs the same batch twice through the cache and checks every cost
+static void checkBatch(BatchEngine* engine, const RouteJob* jobs, RouteResult* results)
+{
+    const Graph* graph = engine->graph;
+    for(int round = 0; round < 2; round++)
+    {
+        batchEngine_run(engine, jobs, results, TEST_QUERIES);
+        for(uint32_t q = 0; q < TEST_QUERIES; q++)
+        {
+            uint32_t* reference = test_distances(graph, jobs[q].start, false);
+            CHECK(results[q].path != NULL);
+            CHECK_EQ(results[q].cost, reference[jobs[q].end]);
+            free(results[q].path);
+            free(reference);
+        }
+    }
+}
+
+int main(void)
+{
+    Graph* graph = twinGraph();
+    BatchEngine* engine = batchEngine_create(graph, 2);
+    engine->cache = routeCache_create(graph, 64);
+
+    uint32_t seed = 5;
+    RouteJob* jobs = (RouteJob*)malloc(TEST_QUERIES * sizeof(RouteJob));
+    RouteResult* results = (RouteResult*)malloc(TEST_QUERIES * sizeof(RouteResult));
+    for(uint32_t q = 0; q < TEST_QUERIES; q++)
+    {
+        // few ends so longer routes answer shorter queries that share their end
+        jobs[q] = (RouteJob){xorshift32(&seed) % graph->num_nodes, xorshift32(&seed) % 4, AStar};
+        if(q % 3 == 2)jobs[q].algo = bidirectionalAStar;
+    }
+    checkBatch(engine, jobs, results);
+    RouteCacheStats stats = routeCache_stats(engine->cache);
+    CHECK(stats.hits + stats.suffix_hits > 0);
+
+    // no changes while the graph is searched from other threads
+    graph_acquire(graph);
+    CHECK(!graph_setWeight(graph, 0, 1, CONNECTION_CLOSED));
+    graph_release(graph);
+
+    // between batches the changes go through and the cached routes go stale
+    SearchContext* ctx = searchContext_create(graph);
+    uint32_t last = graph->num_nodes - 1, cost = 0;
+    free(routeCache_search(engine->cache, ctx, AStar, 0, last, &cost));
+    stats = routeCache_stats(engine->cache);
+    for(uint32_t v = 0; v + 1 < graph->num_nodes; v += 7)
+    {
+        if(test_weight(graph, v, v + 1) == CONNECTION_CLOSED)continue;
+        CHECK(graph_setWeight(graph, v, v + 1, 500));
+        CHECK(graph_setWeight(graph, v + 1, v, 500));
+    }
+    free(routeCache_search(engine->cache, ctx, AStar, 0, last, &cost));
+    CHECK_EQ(routeCache_stats(engine->cache).stale, stats.stale + 1);
+    uint32_t* reference = test_distances(graph, 0, false);
+    CHECK_EQ(cost, reference[last]);
+    free(reference);
+    searchContext_free(ctx);
+    checkBatch(engine, jobs, results);
+
+    routeCache_free(engine->cache);
+    batchEngine_free(engine);
+    free(jobs);
+    free(results);
+    graph_free(graph);
+
+    if(test_failures)
+        fprintf(stderr, "%u checks failed\n", test_failures);
+    return test_failures != 0;
+}
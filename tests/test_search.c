@@ -0,0 +1,345 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "test.h"
+#include "graph.h"
+#include "graph_generate.h"
+#include "search.h"
+#include "search_context.h"
+#include "bounded_search.h"
+#include "anytime_search.h"
+#include "contraction_hierarchy.h"
+#include "distance_table.h"
+#include "delta_stepping.h"
+#include "parallel_bfs.h"
+#include "landmarks.h"
+#include "util.h"
+
+// Every search against the quadratic Dijkstra of test.h on generated graphs,
+// with and without the preprocessing the searches can use
+#define TEST_QUERIES 40
+
+// what a search promises about the path it finds
+typedef enum search_promise{
+    PROMISE_PATH, // some path
+    PROMISE_HOPS, // a path with the fewest connections
+    PROMISE_CHEAPEST, // the cheapest path
+    PROMISE_WEIGHTED, // a path at most ctx->anytime.bound times the cheapest
+} SearchPromise;
+
+typedef struct checked_search{
+    const char* name;
+    Search* search;
+    SearchPromise promise;
+} CheckedSearch;
+
+static const CheckedSearch checked_searches[] = {
+    {"breadthFirst", breadthFirst_run, PROMISE_HOPS},
+    {"depthFirst", depthFirst_run, PROMISE_PATH},
+    {"bidirectionalBreadthFirst", bidirectionalBreadthFirst_run, PROMISE_HOPS},
+    {"AStar", AStar_run, PROMISE_CHEAPEST},
+    {"bidirectionalAStar", bidirectionalAStar_run, PROMISE_CHEAPEST},
+    {"contractionHierarchySearch", contractionHierarchySearch_run, PROMISE_CHEAPEST},
+    {"memoryBoundedAStar", memoryBoundedAStar_run, PROMISE_CHEAPEST},
+    {"weightedAStar", weightedAStar_run, PROMISE_WEIGHTED},
+    {"anytimeAStar", anytimeAStar_run, PROMISE_CHEAPEST},
+};
+
+/// @brief checks one search between two cities against the reference distances
+static void checkSearch(const Graph* graph, SearchContext* ctx, const CheckedSearch* checked,
+    uint32_t start, uint32_t end, const uint32_t* dist, const uint32_t* hops)
+{
+    Path path = path_init(NULL, NULL, 0);
+    bool found = path_find(&path, graph, ctx, checked->search, start, end);
+    if(dist[end] == TEST_UNREACHABLE)
+    {
+        CHECK(!found);
+        path_free(&path);
+        return;
+    }
+    CHECK(found);
+    if(!found)
+    {
+        fprintf(stderr, "  %s found no path from %u to %u\n", checked->name, start, end);
+        return;
+    }
+    uint64_t cost = test_checkPath(graph, &path, start, end);
+    switch(checked->promise)
+    {
+        case PROMISE_PATH:
+            break;
+        case PROMISE_HOPS:
+            CHECK_EQ(path.len - 1, hops[end]);
+            break;
+        case PROMISE_CHEAPEST:
+            CHECK_EQ(cost, dist[end]);
+            CHECK_EQ(path.cost, dist[end]);
+            break;
+        case PROMISE_WEIGHTED:
+            // the bound is the cost over a lower bound, which may round a hair below the ratio
+            CHECK(ctx->anytime.bound >= 1 && cost <= ctx->anytime.bound * dist[end] + 1e-6);
+            CHECK_EQ(path.cost, cost);
+            break;
+    }
+    if(cost != dist[end] && checked->promise == PROMISE_CHEAPEST)
+        fprintf(stderr, "  %s from %u to %u cost %llu instead of %u\n", checked->name, start, end,
+            (unsigned long long)cost, dist[end]);
+    path_free(&path);
+}
+
+/// @brief checks every search and the one to all distances on random queries
+/// @param graph the graph to search
+/// @param seed picks the queries
+static void checkGraph(const Graph* graph, uint32_t seed)
+{
+    SearchContext* ctx = searchContext_create(graph);
+    uint32_t n = graph->num_nodes;
+    uint32_t* dist = (uint32_t*)malloc(n * sizeof(uint32_t));
+    DeltaStepping* ds = deltaStepping_create(graph, 2, 0);
+    ParallelBfs* bfs = parallelBfs_create(graph, 2);
+
+    for(uint32_t q = 0; q < TEST_QUERIES; q++)
+    {
+        uint32_t start = xorshift32(&seed) % n, end = xorshift32(&seed) % n;
+        uint32_t* reference = test_distances(graph, start, false);
+        uint32_t* hops = test_distances(graph, start, true);
+        for(size_t i = 0; i < sizeof(checked_searches) / sizeof(checked_searches[0]); i++)
+            checkSearch(graph, ctx, &checked_searches[i], start, end, reference, hops);
+
+        distanceTable_oneToAll(graph, ctx, start, dist);
+        for(uint32_t v = 0; v < n; v++)
+            CHECK_EQ(dist[v], reference[v]);
+
+        deltaStepping_run(ds, start, dist, NULL);
+        for(uint32_t v = 0; v < n; v++)
+            CHECK_EQ(dist[v], reference[v]);
+
+        for(int optimizing = 0; optimizing < 2; optimizing++)
+        {
+            parallelBfs_run(bfs, start, optimizing);
+            for(uint32_t v = 0; v < n; v++)
+                CHECK_EQ(bfs->levels[v], hops[v]);
+        }
+        free(reference);
+        free(hops);
+    }
+
+    parallelBfs_free(bfs);
+    deltaStepping_free(ds);
+    free(dist);
+    searchContext_free(ctx);
+}
+
+/// @brief IDA* keeps no table of costs and re-expands a lot, so it only gets small graphs
+static void checkIdaStar(const Graph* graph, uint32_t seed)
+{
+    static const CheckedSearch ida = {"idaStar", idaStar_run, PROMISE_CHEAPEST};
+    SearchContext* ctx = searchContext_create(graph);
+    for(uint32_t q = 0; q < TEST_QUERIES; q++)
+    {
+        uint32_t start = xorshift32(&seed) % graph->num_nodes, end = xorshift32(&seed) % graph->num_nodes;
+        uint32_t* reference = test_distances(graph, start, false);
+        checkSearch(graph, ctx, &ida, start, end, reference, reference);
+        free(reference);
+    }
+    searchContext_free(ctx);
+}
+
+/// @brief closes some roads and lengthens others, builds landmarks over the
+///        changed graph and then reopens the closed roads, the landmarks must
+///        not have learned anything from the closures
+static void checkChangedGraph(Graph* graph, uint32_t seed)
+{
+    uint32_t closed[16][3];
+    for(uint32_t r = 0; r < 32;)
+    {
+        uint32_t from = xorshift32(&seed) % graph->num_nodes;
+        if(graph->offsets[from] == graph->offsets[from + 1])continue;
+        uint32_t i = graph->offsets[from] + xorshift32(&seed) % (graph->offsets[from + 1] - graph->offsets[from]);
+        uint32_t to = graph->targets[i], weight = graph->weights[i];
+        if(graph->base_weights && weight != graph->base_weights[i])continue;
+        if(r < 16)
+        {
+            closed[r][0] = from;
+            closed[r][1] = to;
+            closed[r][2] = weight;
+            weight = CONNECTION_CLOSED;
+        }
+        else
+        {
+            weight += 1 + xorshift32(&seed) % 50;
+        }
+        CHECK(graph_setWeight(graph, from, to, weight));
+        CHECK(graph_setWeight(graph, to, from, weight));
+        r++;
+    }
+    graph->landmarks = landmarks_build(graph, 8);
+    for(uint32_t r = 0; r < 16; r++)
+    {
+        CHECK(graph_setWeight(graph, closed[r][0], closed[r][1], closed[r][2]));
+        CHECK(graph_setWeight(graph, closed[r][1], closed[r][0], closed[r][2]));
+    }
+    checkGraph(graph, seed);
+}
+
+/// @brief closes roads, some in one direction only, under a breadth first
+///        search built before the closures, its reversed graph must follow them
+static void checkClosedRoads(Graph* graph, uint32_t seed)
+{
+    ParallelBfs* bfs = parallelBfs_create(graph, 2);
+    for(uint32_t r = 0; r < 60; r++)
+    {
+        uint32_t from = xorshift32(&seed) % graph->num_nodes;
+        if(graph->offsets[from] == graph->offsets[from + 1])continue;
+        uint32_t i = graph->offsets[from] + xorshift32(&seed) % (graph->offsets[from + 1] - graph->offsets[from]);
+        uint32_t to = graph->targets[i];
+        CHECK(graph_setWeight(graph, from, to, CONNECTION_CLOSED));
+        if(r % 2)
+            CHECK(graph_setWeight(graph, to, from, CONNECTION_CLOSED));
+    }
+    for(uint32_t q = 0; q < TEST_QUERIES; q++)
+    {
+        uint32_t start = xorshift32(&seed) % graph->num_nodes;
+        uint32_t* hops = test_distances(graph, start, true);
+        for(int optimizing = 0; optimizing < 2; optimizing++)
+        {
+            parallelBfs_run(bfs, start, optimizing);
+            for(uint32_t v = 0; v < graph->num_nodes; v++)
+                CHECK_EQ(bfs->levels[v], hops[v]);
+        }
+        free(hops);
+    }
+    parallelBfs_free(bfs);
+    checkGraph(graph, seed);
+}
+
+/// @brief lengthens roads in one direction only, the bidirectional searches
+///        can no longer walk connections backwards as they are stored
+static void checkOneWayChanges(Graph* graph, uint32_t seed)
+{
+    CHECK_EQ(graph->asymmetric, 0);
+    for(uint32_t r = 0; r < 40; r++)
+    {
+        uint32_t from = xorshift32(&seed) % graph->num_nodes;
+        if(graph->offsets[from] == graph->offsets[from + 1])continue;
+        uint32_t i = graph->offsets[from] + xorshift32(&seed) % (graph->offsets[from + 1] - graph->offsets[from]);
+        CHECK(graph_setWeight(graph, from, graph->targets[i], graph->weights[i] + 200));
+    }
+    CHECK(graph->asymmetric > 0);
+    CHECK_EQ(graph->asymmetric, graph_countAsymmetric(graph));
+    checkGraph(graph, seed);
+}
+
+/// @brief checks the searches that add up costs between every pair of cities
+///        of a graph with long roads, first without and then with landmarks
+static void checkLongGraph(Graph* graph)
+{
+    static const CheckedSearch long_searches[] = {
+        {"AStar", AStar_run, PROMISE_CHEAPEST},
+        {"bidirectionalAStar", bidirectionalAStar_run, PROMISE_CHEAPEST},
+    };
+    SearchContext* ctx = searchContext_create(graph);
+    for(int estimated = 0; estimated < 2; estimated++)
+    {
+        if(estimated)
+            graph->landmarks = landmarks_build(graph, 4);
+        for(uint32_t start = 0; start < graph->num_nodes; start++)
+        {
+            uint32_t* reference = test_distances(graph, start, false);
+            for(uint32_t end = 0; end < graph->num_nodes; end++)
+            {
+                for(size_t i = 0; i < sizeof(long_searches) / sizeof(long_searches[0]); i++)
+                    checkSearch(graph, ctx, &long_searches[i], start, end, reference, reference);
+            }
+            free(reference);
+        }
+    }
+    searchContext_free(ctx);
+}
+
+/// @brief costs above 2^31, where twice the cost, the cost of a detour or the
+///        cost of a city plus its landmark estimate no longer fits in 32 bits,
+///        though every cheapest path still does
+static void checkLongRoads(void)
+{
+    const uint32_t side = 3;
+    City cities[9] = {0};
+    EdgeList edges = {0};
+    uint32_t seed = 99;
+    for(uint32_t v = 0; v < side * side; v++)
+    {
+        uint32_t right = 600000000u + xorshift32(&seed) % 400000000u, down = 600000000u + xorshift32(&seed) % 400000000u;
+        if(v % side + 1 < side)
+        {
+            edgeList_add(&edges, v, v + 1, right);
+            edgeList_add(&edges, v + 1, v, right);
+        }
+        if(v + side < side * side)
+        {
+            edgeList_add(&edges, v, v + side, down);
+            edgeList_add(&edges, v + side, v, down);
+        }
+    }
+    Graph* graph = graph_build(cities, side * side, &edges);
+    edgeList_free(&edges);
+    checkLongGraph(graph);
+    graph_free(graph);
+
+    // from 0 the direct road reaches 2 first, at a cost that fits but whose
+    // sum with the exact estimate from 2 to 3 does not, while the cheapest
+    // path to 2 runs through 1
+    static const uint32_t detour[][3] = {{0, 2, 3300000000u}, {0, 1, 1000000000u}, {1, 2, 1000000000u}, {2, 3, 1000000000u}};
+    for(size_t i = 0; i < sizeof(detour) / sizeof(detour[0]); i++)
+    {
+        edgeList_add(&edges, detour[i][0], detour[i][1], detour[i][2]);
+        edgeList_add(&edges, detour[i][1], detour[i][0], detour[i][2]);
+    }
+    graph = graph_build(cities, 4, &edges);
+    edgeList_free(&edges);
+    checkLongGraph(graph);
+    graph_free(graph);
+}
+
+int main(void)
+{
+    Graph* grid = generateGridGraph(12, 12, 1);
+    checkGraph(grid, 11);
+    grid->landmarks = landmarks_build(grid, 4);
+    grid->ch = contractionHierarchy_build(grid);
+    checkGraph(grid, 12);
+    graph_free(grid);
+
+    Graph* geometric = generateGeometricGraph(300, 6, 2);
+    checkGraph(geometric, 21);
+    geometric->landmarks = landmarks_build(geometric, 8);
+    geometric->ch = contractionHierarchy_build(geometric);
+    checkGraph(geometric, 22);
+    landmarks_free(geometric->landmarks);
+    geometric->landmarks = NULL;
+    checkChangedGraph(geometric, 23);
+    graph_free(geometric);
+
+    Graph* closed = generateGeometricGraph(300, 6, 6);
+    checkClosedRoads(closed, 61);
+    graph_free(closed);
+
+    Graph* scale_free = generateScaleFreeGraph(300, 2, 3);
+    scale_free->ch = contractionHierarchy_build(scale_free);
+    checkGraph(scale_free, 31);
+    graph_free(scale_free);
+
+    Graph* one_way = generateGridGraph(12, 12, 5);
+    checkOneWayChanges(one_way, 51);
+    graph_free(one_way);
+
+    checkLongRoads();
+
+    Graph* small = generateGridGraph(4, 4, 4);
+    checkIdaStar(small, 41);
+    graph_free(small);
+
+    if(test_failures)
+        fprintf(stderr, "%u checks failed\n", test_failures);
+    return test_failures != 0;
+}